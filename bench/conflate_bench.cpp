@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../engine/conflator.hpp"
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+#include "../engine/spsc/spsc_channel.hpp"   // cpu_relax
+#include "../engine/common/cpu.hpp"
+#include "../engine/common/timebase.hpp"
+
+// Market-data conflation on a bursty flow.
+// The engine's event stream is recorded once. It is then fed to a consumer
+// that pays --sink-ns per event it receives (a stand-in for encoding or
+// sending), first raw and then through a Conflator for each
+// --batches x --windows-us pair. Per config the bench reports events
+// delivered, how many level updates were conflated, and the consumer's
+// cost per engine event.
+
+struct Args {
+  int n = 1000000;
+  int burst = 32;                 // adds hitting one level back to back
+  int sink_ns = 50;
+  std::vector<int> batches{1, 16, 256};
+  std::vector<int> windows_us{0, 10, 100};
+  int cpu = -1;
+};
+
+static std::vector<int> parse_list(const char* s) {
+  std::vector<int> v;
+  for (const char* p = s; *p; ) {
+    v.push_back(std::atoi(p));
+    while (*p && *p != ',') ++p;
+    if (*p == ',') ++p;
+  }
+  return v;
+}
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--n") && i+1 < argc) a.n = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--burst") && i+1 < argc) a.burst = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--sink-ns") && i+1 < argc) a.sink_ns = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--batches") && i+1 < argc) a.batches = parse_list(argv[++i]);
+    else if (!std::strcmp(argv[i], "--windows-us") && i+1 < argc) a.windows_us = parse_list(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin") && i+1 < argc) a.cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: conflate_bench [--n N] [--burst B] [--sink-ns NS] [--batches 1,16,...]\n"
+                   "                      [--windows-us 0,10,...] [--pin CPU]\n";
+      std::exit(0);
+    }
+  }
+  if (a.burst < 1) a.burst = 1;
+  return a;
+}
+
+// Bursts of small adds on one level, a sweep now and then, some cancels.
+static std::vector<Event> record_events(const Args& a) {
+  EventBus bus(1u << 16);
+  MatchEngine eng(bus);
+  std::vector<Event> out;
+  out.reserve(std::size_t(a.n) * 2);
+  std::mt19937_64 rng(7);
+  OrderId next = 1;
+  auto drain = [&]{ while (auto ev = bus.try_poll()) out.push_back(*ev); };
+  for (int i = 0; i < a.n; ) {
+    const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+    const Price px = 1000 + Price(rng() % 5) * (s == Side::Bid ? -1 : 1) + (s == Side::Bid ? -1 : 1);
+    const int r = int(rng() % 10);
+    if (r == 0) { eng.market(1 + next % 4, next, s, 1 + Qty(rng() % 40)); ++next; ++i; }
+    else if (r == 1 && next > 64) { eng.cancel(next - 1 - OrderId(rng() % 64)); ++i; }
+    else for (int k = 0; k < a.burst && i < a.n; ++k, ++i, ++next) eng.add(1 + next % 4, next, s, px, 1 + Qty(rng() % 5));
+    drain();
+  }
+  return out;
+}
+
+static void pay(int ns) {
+  const auto until = tb::now_ns() + std::uint64_t(ns);
+  while (tb::now_ns() < until) cpu_relax();
+}
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  if (args.cpu >= 0) cpu::pin_this_thread(args.cpu);
+  const auto events = record_events(args);
+  const double nev = double(events.size());
+  std::size_t changes = 0;
+  for (auto const& e : events) changes += e.is<BookChangeEvent>();
+  std::cout << "[flow] " << args.n << " commands -> " << events.size() << " events (" << changes
+            << " level updates), burst=" << args.burst << ", sink " << args.sink_ns << " ns/event\n";
+
+  std::uint64_t delivered = 0;
+  auto sink = [&](const Event&){ ++delivered; pay(args.sink_ns); };
+
+  // Raw: every event reaches the consumer.
+  {
+    const auto t0 = tb::now_ns();
+    for (auto const& e : events) sink(e);
+    std::cout << "[raw] delivered " << delivered << ", consumer " << double(tb::now_ns() - t0) / nev
+              << " ns/event\n";
+  }
+
+  for (int batch : args.batches) {
+    for (int win : args.windows_us) {
+      Conflator::Config cfg;
+      cfg.max_batch = std::size_t(batch > 0 ? batch : 1);
+      cfg.window_ns = std::uint64_t(win) * 1000;
+      EventBus bus(1u << 16);
+      Conflator conf(bus, cfg);
+      delivered = 0;
+      const auto t0 = tb::now_ns();
+      // Feed a batch's worth at a time: the producer is always ahead.
+      for (std::size_t i = 0; i < events.size(); ) {
+        for (std::size_t k = 0; k < cfg.max_batch && i < events.size(); ++k) bus.try_publish(events[i++]);
+        conf.pump(sink);
+      }
+      while (conf.pump(sink)) {}
+      conf.flush(sink);
+      const double ns = double(tb::now_ns() - t0) / nev;
+      const auto st = conf.stats();
+      std::cout << "[batch=" << batch << ",window=" << win << "us] delivered " << delivered << " ("
+                << 100.0 * double(delivered) / nev << "%), conflated " << st.conflated() << " of "
+                << st.book_in << " level updates in " << st.flushes << " flushes, consumer " << ns
+                << " ns/event\n";
+    }
+  }
+}
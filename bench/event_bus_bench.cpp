@@ -0,0 +1,160 @@
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <variant>
+
+#include "../engine/event_bus.hpp"
+#include "../engine/spsc/spsc_ring.hpp"
+#include "../engine/spsc/spsc_channel.hpp"   // cpu_relax
+#include "../engine/common/cpu.hpp"
+#include "../engine/common/timebase.hpp"
+
+// Events/s through EventBus: the 64-byte POD Event against the previous
+// std::variant<FillEvent, CancelEvent, BookChangeEvent> bus (reproduced
+// below with its original payload layouts).
+//  1) one thread: publish a burst, drain it (ring + event copy cost only);
+//     for the POD bus also drained in place with poll_bulk
+//  2) producer/consumer threads for --seconds (with --pin-prod/--pin-cons)
+
+namespace legacy {
+struct FillEvent { OrderId taker_id; OrderId maker_id; Side side; Price px; Qty qty; SymbolId symbol; };
+struct CancelEvent { OrderId id; Side side; Price px; Qty qty_canceled; SymbolId symbol; };
+struct BookChangeEvent { Side side; Price px; Qty level_qty; SymbolId symbol; };
+using Event = std::variant<FillEvent, CancelEvent, BookChangeEvent>;
+
+class EventBus {
+public:
+  explicit EventBus(std::size_t cap) : ring_(cap) {}
+  bool try_publish(const Event& e) { return ring_.try_push(e); }
+  std::optional<Event> try_poll() {
+    Event e;
+    if (ring_.try_pop(e)) return e;
+    return std::nullopt;
+  }
+private:
+  SpscRing<Event> ring_;
+};
+
+inline Event make(std::uint64_t i) {
+  if (i % 4 == 0) return FillEvent{i, i + 1, Side::Bid, Price(i & 127), 1, 0};
+  return BookChangeEvent{Side::Ask, Price(i & 127), Qty(i & 7), 0};
+}
+inline Qty qty_of(const Event& e) {
+  return std::visit([](auto const& x) -> Qty {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, FillEvent>) return x.qty;
+    else return 1;
+  }, e);
+}
+} // namespace legacy
+
+namespace pod {
+inline Event make(std::uint64_t i) {
+  if (i % 4 == 0) return FillEvent{i, i + 1, Price(i & 127), 1, 0, Side::Bid};
+  return BookChangeEvent{Price(i & 127), Qty(i & 7), 0, Side::Ask};
+}
+inline Qty qty_of(const Event& e) {
+  if (auto* f = e.get_if<FillEvent>()) return f->qty;
+  return 1;
+}
+} // namespace pod
+
+struct Args {
+  std::uint64_t n = 20000000;     // events for the single-thread pass
+  int seconds = 2;
+  std::size_t capacity = 1u << 16;
+  int prod_cpu = -1;
+  int cons_cpu = -1;
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--n") && i+1 < argc) a.n = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--seconds") && i+1 < argc) a.seconds = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--cap") && i+1 < argc) a.capacity = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin-prod") && i+1 < argc) a.prod_cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin-cons") && i+1 < argc) a.cons_cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: event_bus_bench [--n N] [--seconds S] [--cap POW2] [--pin-prod CPU] [--pin-cons CPU]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+template<typename Bus, typename Make, typename QtyOf>
+static void single_thread(const char* label, const Args& a, Make make, QtyOf qty_of) {
+  Bus bus(a.capacity);
+  const std::uint64_t burst = a.capacity / 2;
+  Qty sum = 0;
+  const auto t0 = tb::now_ns();
+  for (std::uint64_t i = 0; i < a.n; ) {
+    const std::uint64_t end = std::min(a.n, i + burst);
+    for (; i < end; ++i) bus.try_publish(make(i));
+    while (auto ev = bus.try_poll()) sum += qty_of(*ev);
+  }
+  const double s = double(tb::now_ns() - t0) / 1e9;
+  std::cout << "[" << label << "] 1-thread: " << double(a.n) / s / 1e6 << " M events/s ("
+            << s * 1e9 / double(a.n) << " ns/event, checksum " << sum << ")\n";
+}
+
+// Same loop, consuming in place with peek/release batches (poll_bulk).
+static void single_thread_in_place(const Args& a) {
+  EventBus bus(a.capacity);
+  const std::uint64_t burst = a.capacity / 2;
+  Qty sum = 0;
+  const auto t0 = tb::now_ns();
+  for (std::uint64_t i = 0; i < a.n; ) {
+    const std::uint64_t end = std::min(a.n, i + burst);
+    for (; i < end; ++i) bus.try_publish(pod::make(i));
+    bus.poll_bulk(burst, [&](Event&& ev){ sum += pod::qty_of(ev); });
+  }
+  const double s = double(tb::now_ns() - t0) / 1e9;
+  std::cout << "[pod,in-place] 1-thread: " << double(a.n) / s / 1e6 << " M events/s ("
+            << s * 1e9 / double(a.n) << " ns/event, checksum " << sum << ")\n";
+}
+
+template<typename Bus, typename Make, typename QtyOf>
+static void two_threads(const char* label, const Args& a, Make make, QtyOf qty_of) {
+  Bus bus(a.capacity);
+  std::atomic<bool> stop{false};
+  std::uint64_t produced = 0, consumed = 0;
+  std::thread cons([&]{
+    if (a.cons_cpu >= 0) cpu::pin_this_thread(a.cons_cpu);
+    Qty sum = 0;
+    for (unsigned idle = 0;;) {
+      if (auto ev = bus.try_poll()) { sum += qty_of(*ev); ++consumed; idle = 0; continue; }
+      if (stop.load(std::memory_order_acquire) && consumed == produced) break;
+      if (++idle & 63) cpu_relax(); else std::this_thread::yield();
+    }
+    if (sum < 0) std::cout << "";   // keep sum live
+  });
+  if (a.prod_cpu >= 0) cpu::pin_this_thread(a.prod_cpu);
+  const auto t0 = tb::now_ns();
+  const auto until = t0 + std::uint64_t(a.seconds) * 1000000000ull;
+  for (std::uint64_t i = 0; (i & 1023) || tb::now_ns() < until; ++i) {
+    for (unsigned spins = 0; !bus.try_publish(make(i)); )
+      if (++spins & 63) cpu_relax(); else std::this_thread::yield();
+    ++produced;
+  }
+  stop.store(true, std::memory_order_release);
+  cons.join();
+  const double s = double(tb::now_ns() - t0) / 1e9;
+  std::cout << "[" << label << "] 2-thread: " << double(consumed) / s / 1e6 << " M events/s\n";
+}
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  std::cout << "[sizes] variant Event: " << sizeof(legacy::Event) << " B, POD Event: " << sizeof(Event)
+            << " B (align " << alignof(Event) << ")\n";
+  single_thread<legacy::EventBus>("variant", args, legacy::make, legacy::qty_of);
+  single_thread<EventBus>("pod", args, pod::make, pod::qty_of);
+  single_thread_in_place(args);
+  two_threads<legacy::EventBus>("variant", args, legacy::make, legacy::qty_of);
+  two_threads<EventBus>("pod", args, pod::make, pod::qty_of);
+  if (std::thread::hardware_concurrency() < 2)
+    std::cout << "note: single core; 2-thread numbers measure context switches, not the ring\n";
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../engine/journal.hpp"
+#include "../engine/match_engine.hpp"
+#include "../engine/common/cpu.hpp"
+#include "../engine/common/metrics.hpp"
+#include "../engine/common/timebase.hpp"
+
+// Write-ahead journal cost on the matching thread.
+//  1) raw Journal::append: batch ns/op, then per-append latency percentiles
+//  2) MatchEngine over a mixed flow with and without the journal attached
+// Group commit (msync) runs on the journal's own thread throughout.
+
+struct Args {
+  int n = 1000000;
+  std::string dir = "/tmp/lob_journal_bench";
+  std::size_t segment_mb = 64;
+  int flush_us = 1000;
+  bool sync = true;
+  int cpu = -1;
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--n") && i+1 < argc) a.n = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--dir") && i+1 < argc) a.dir = argv[++i];
+    else if (!std::strcmp(argv[i], "--segment-mb") && i+1 < argc) a.segment_mb = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--flush-us") && i+1 < argc) a.flush_us = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--no-sync")) a.sync = false;
+    else if (!std::strcmp(argv[i], "--pin") && i+1 < argc) a.cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: journal_bench [--n N] [--dir DIR] [--segment-mb MB] [--flush-us US] [--no-sync]\n"
+                   "                     [--pin CPU]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+static std::vector<Command> make_flow(int n) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> op(0, 99), pd(-8, 8), qd(1, 10);
+  std::vector<Command> v; v.reserve(std::size_t(n));
+  OrderId next = 1;
+  for (int i = 0; i < n; ++i) {
+    const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+    const Price px = 1000 + pd(rng) + (s == Side::Bid ? -2 : 2);
+    const int o = op(rng);
+    if (o < 20 && next > 64) v.push_back(make_cancel(0, next - 1 - OrderId(rng() % 64)));
+    else if (o < 25)         v.push_back(make_market(0, next & 3, next, s, qd(rng))), ++next;
+    else                     v.push_back(make_add(0, next & 3, next, s, px, qd(rng))), ++next;
+  }
+  return v;
+}
+
+static Journal::Config journal_cfg(const Args& a) {
+  std::filesystem::remove_all(a.dir);
+  Journal::Config c;
+  c.dir = a.dir;
+  c.segment_bytes = a.segment_mb << 20;
+  c.flush_interval = std::chrono::microseconds(a.flush_us);
+  c.sync = a.sync;
+  return c;
+}
+
+static const char* mode(const Args& a) { return a.sync ? "msync" : "no-sync"; }
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  if (args.cpu >= 0) cpu::pin_this_thread(args.cpu);
+  const auto flow = make_flow(args.n);
+  const double nops = double(flow.size());
+
+  // 1) Raw append.
+  {
+    Journal j(journal_cfg(args));
+    auto t0 = tb::now_ns();
+    for (const Command& c : flow) j.append(c);
+    auto t1 = tb::now_ns();
+    LatencyHistogram ns;
+    for (const Command& c : flow) {
+      auto s0 = tb::now_ns();
+      j.append(c);
+      ns.record(tb::now_ns() - s0);
+    }
+    const auto st = j.stats();
+    const auto last = j.last_seq();
+    const auto w0 = tb::now_ns();
+    j.wait_durable(last);
+    const auto w1 = tb::now_ns();
+    std::cout << "[append," << mode(args) << "] batch: " << double(t1 - t0) / nops << " ns/op; per-op "
+              << ns.summary() << "\n"
+              << "[append," << mode(args) << "] " << st.appended << " records, " << st.rotations << " rotations ("
+              << st.spare_misses << " waited for a spare), " << st.syncs << " msyncs, durable "
+              << double(w1 - w0) / 1e3 << " us after the last append\n";
+  }
+
+  // 2) Engine with/without the journal.
+  auto run = [&](Journal* j) {
+    EventBus bus(1u << 16);
+    MatchEngine eng(bus);
+    eng.set_journal(j);
+    auto t0 = tb::now_ns();
+    for (const Command& c : flow) {
+      eng.apply(c);
+      while (bus.try_poll()) {}
+    }
+    return double(tb::now_ns() - t0) / nops;
+  };
+  const double plain = run(nullptr);
+  Journal j(journal_cfg(args));
+  const double journaled = run(&j);
+  std::cout << "[engine] plain: " << plain << " ns/cmd, journaled (" << mode(args) << "): " << journaled
+            << " ns/cmd, delta " << journaled - plain << " ns/cmd\n";
+  j.close();
+  std::filesystem::remove_all(args.dir);
+}
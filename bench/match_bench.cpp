@@ -1,32 +1,97 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "../engine/event_bus.hpp"
 #include "../engine/match_engine.hpp"
 #include "../engine/common/cpu.hpp"
+#include "../engine/common/metrics.hpp"
 #include "../engine/common/timebase.hpp"
 
-int main() {
+// Build twice: `match_bench` (pooled OrderNodes) and `match_bench_heap`
+// (-DLOB_HEAP_ORDER_NODES, plain new/delete) to compare allocator impact.
+#ifdef LOB_HEAP_ORDER_NODES
+static const char* kAlloc = "heap";
+#else
+static const char* kAlloc = "pool";
+#endif
+
+struct Args {
+  int n = 200000;          // timed ops per phase
+  int cpu = 0;             // -1 = don't pin
+  std::size_t reserve = 0; // BookConfig::reserve_orders
+  bool prefault = false;
+  lob::LadderKind ladder = lob::LadderKind::Map;
+  lob::LevelQueue queue = lob::LevelQueue::List;
+  bool cmd_latency = false; // also report the engine's own per-command histograms
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--n") && i+1 < argc) a.n = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin") && i+1 < argc) a.cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--reserve") && i+1 < argc) a.reserve = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--prefault")) a.prefault = true;
+    else if (!std::strcmp(argv[i], "--cmd-latency")) a.cmd_latency = true;
+    else if (!std::strcmp(argv[i], "--ladder") && i+1 < argc) {
+      std::string m = argv[++i];
+      a.ladder = (m == "flat") ? lob::LadderKind::Flat : lob::LadderKind::Map;
+    }
+    else if (!std::strcmp(argv[i], "--queue") && i+1 < argc) {
+      std::string m = argv[++i];
+      a.queue = (m == "ring") ? lob::LevelQueue::Ring : lob::LevelQueue::List;
+    }
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: match_bench [--n N] [--pin CPU|-1] [--reserve N] [--prefault]\n"
+                   "                   [--ladder map|flat] [--queue list|ring] [--cmd-latency]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+static lob::LadderKind g_ladder = lob::LadderKind::Map;
+static lob::LevelQueue g_queue = lob::LevelQueue::List;
+
+static void report(const char* phase, const LatencyHistogram& ns) {
+  std::cout << "[" << kAlloc << "," << lob::ladder_str(g_ladder) << ","
+            << lob::level_queue_str(g_queue) << "] " << phase
+            << ": " << ns.summary() << " (" << ns.count() << " ops)\n";
+}
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
   // Pin to a core for a cleaner toy measurement.
-  tb::pin_thread_to_cpu(0);
+  if (args.cpu >= 0) tb::pin_thread_to_cpu(args.cpu);
+  // Timestamps come from the TSC (tb::fast_now_ns) when it is invariant.
+  std::cout << "timebase: " << (tb::tsc_clock().uses_tsc() ? "tsc" : "steady_clock") << "\n";
 
   EventBus bus(1 << 20);
-  MatchEngine eng(bus);
+  lob::Book::BookConfig cfg;
+  cfg.reserve_orders = args.reserve;
+  cfg.prefault = args.prefault;
+  cfg.ladder = g_ladder = args.ladder;
+  cfg.queue = g_queue = args.queue;
+  MatchEngine eng(bus, cfg);
+  CommandLatency cmd_lat;
+  if (args.cmd_latency) eng.set_latency(&cmd_lat);
 
   // Preload asks so incoming bids cross immediately
   for (int i = 0; i < 10000; i++) {
     eng.add(10000 + i, lob::Side::Ask, 1000, 1);
   }
 
-  const int N = 200000; // toy run
-  std::vector<std::uint64_t> ns;
-  ns.reserve(N);
+  const int N = args.n;
+  LatencyHistogram ns;
 
+  // Phase 1: crossing adds (first 10k fill, the rest rest at 1000)
   for (int i = 0; i < N; i++) {
-    auto t0 = tb::now_ns();
+    auto t0 = tb::fast_now_ns();
     eng.add(1'000'000 + i, lob::Side::Bid, 1000, 1);
 
     // Drain at most one event quickly (keep the ring from backing up)
@@ -34,14 +99,58 @@ int main() {
       (void)ev;
     }
 
-    auto t1 = tb::now_ns();
-    ns.push_back(t1 - t0);
+    auto t1 = tb::fast_now_ns();
+    ns.record(t1 - t0);
+  }
+  report("cross+post", ns);
+  while (bus.try_poll()) {}
+
+  // Phase 2: cancel-heavy churn (post one, cancel an older one), the flow
+  // where per-order malloc/free dominates.
+  ns.reset();
+  const OrderId base = 10'000'000;
+  for (int i = 0; i < N; i++) {
+    auto t0 = tb::fast_now_ns();
+    eng.add(base + i, lob::Side::Ask, 1100 + (i & 63), 1);
+    if (i >= 64) eng.cancel(base + i - 64);
+    while (bus.try_poll()) {}
+    auto t1 = tb::fast_now_ns();
+    ns.record(t1 - t0);
   }
+  report("add+cancel", ns);
+  while (bus.try_poll()) {}
 
-  // p50 via nth_element
-  std::nth_element(ns.begin(), ns.begin() + N / 2, ns.end());
-  auto p50 = ns[N / 2];
+  // Phase 3: deep sweeps. Makers are posted round-robin over 8 levels so a
+  // level's orders are not adjacent in the node pool; one market order then
+  // takes a whole level (timed per sweep, reported per maker).
+  ns.reset();
+  constexpr int kDepth = 512, kLevels = 8;
+  const OrderId sweep_base = 100'000'000;
+  OrderId sid = sweep_base;
+  const int rounds = std::max(1, N / (kDepth * kLevels));
+  for (int r = 0; r < rounds; r++) {
+    for (int k = 0; k < kDepth; k++)
+      for (int l = 0; l < kLevels; l++) eng.add(sid++, lob::Side::Ask, 2000 + l, 1);
+    while (bus.try_poll()) {}
+    for (int l = 0; l < kLevels; l++) {
+      auto t0 = tb::fast_now_ns();
+      eng.market(sid++, lob::Side::Bid, kDepth);
+      auto t1 = tb::fast_now_ns();
+      ns.record((t1 - t0) / kDepth);
+      while (bus.try_poll()) {}
+    }
+  }
+  report("sweep/maker", ns);
+
+  if (args.cmd_latency) {
+    const char* names[] = {"add", "market", "cancel", "replace"};
+    for (CmdType t : {CmdType::Add, CmdType::Market, CmdType::Cancel, CmdType::Replace})
+      if (cmd_lat[t].count())
+        std::cout << "[engine] " << names[std::size_t(t)] << ": " << cmd_lat[t].summary()
+                  << " (" << cmd_lat[t].count() << " cmds)\n";
+  }
 
-  std::cout << "p50 match latency: " << p50 << " ns ("
-            << (p50 / 1000.0) << " us)\n";
+  const auto& ps = eng.book().pool_stats();
+  std::cout << "pool: in_use=" << ps.in_use << " high_water=" << ps.high_water
+            << " capacity=" << ps.capacity << " slabs=" << ps.slabs << "\n";
 }
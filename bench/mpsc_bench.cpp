@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/spsc/mpsc_channel.hpp"
+#include "../engine/common/timebase.hpp"
+#include "../engine/common/cpu.hpp"
+
+// N producer threads (order-entry sessions) -> one MpscChannel -> one
+// consumer (matching thread). Reports consumer throughput and how evenly
+// the producers got through, for each producer count in --producers.
+struct Args {
+  double seconds = 2.0;
+  std::size_t capacity = 1u << 16;
+  std::vector<int> producers{1, 2, 4};
+  BpMode mode = BpMode::Spin;
+  std::size_t batch = 64;          // consumer pop_bulk size
+  int cons_cpu = -1;
+};
+
+static std::vector<int> parse_list(const char* s) {
+  std::vector<int> v;
+  for (const char* p = s; *p; ) {
+    v.push_back(std::atoi(p));
+    while (*p && *p != ',') ++p;
+    if (*p == ',') ++p;
+  }
+  return v;
+}
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--seconds") && i+1 < argc) a.seconds = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--cap") && i+1 < argc) a.capacity = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--producers") && i+1 < argc) a.producers = parse_list(argv[++i]);
+    else if (!std::strcmp(argv[i], "--batch") && i+1 < argc) a.batch = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin-cons") && i+1 < argc) a.cons_cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--mode") && i+1 < argc) {
+      std::string m = argv[++i];
+      if (m == "drop") a.mode = BpMode::Drop;
+      else if (m == "spin") a.mode = BpMode::Spin;
+      else if (m == "sleep") a.mode = BpMode::Sleep;
+      else if (m == "hybrid") a.mode = BpMode::Hybrid;
+    }
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: mpsc_bench [--seconds S] [--cap POW2] [--producers 1,2,4,...]\n"
+                   "                  [--mode drop|spin|sleep|hybrid] [--batch N] [--pin-cons CPU]\n";
+      std::exit(0);
+    }
+  }
+  if (a.batch == 0) a.batch = 1;
+  return a;
+}
+
+static const char* mode_name(BpMode m) {
+  switch (m) {
+  case BpMode::Drop: return "drop";
+  case BpMode::Spin: return "spin";
+  case BpMode::Sleep: return "sleep";
+  case BpMode::Hybrid: return "hybrid";
+  }
+  return "?";
+}
+
+static void run(int nprod, const Args& args) {
+  SpscStats stats;
+  MpscChannel<std::uint64_t> ch(args.capacity, BackpressureCfg(args.capacity, args.capacity / 2, args.mode, 1000), &stats);
+  std::atomic<bool> start{false}, stop{false};
+  std::vector<std::uint64_t> sent(std::size_t(nprod), 0);
+  std::uint64_t consumed = 0;
+  bool ordered = true;
+
+  std::vector<std::thread> prods;
+  for (int p = 0; p < nprod; ++p) {
+    prods.emplace_back([&, p]{
+      cpu::set_name("producer");
+      std::uint64_t i = 0;
+      while (!start.load(std::memory_order_acquire)) cpu_relax();
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (ch.push(std::uint64_t(p) << 48 | i, &stop)) ++i;
+      }
+      sent[std::size_t(p)] = i;
+    });
+  }
+
+  std::thread cons([&]{
+    if (args.cons_cpu >= 0) cpu::pin_this_thread(args.cons_cpu);
+    cpu::set_name("consumer");
+    std::vector<std::uint64_t> next(std::size_t(nprod), 0);
+    unsigned spins = 0;
+    while (!start.load(std::memory_order_acquire)) cpu_relax();
+    auto take = [&](std::uint64_t&& v){
+      std::uint64_t& n = next[std::size_t(v >> 48)];
+      ordered &= (v & 0xffffffffffffull) == n;
+      ++n;
+    };
+    while (!stop.load(std::memory_order_relaxed)) {
+      const std::size_t n = ch.pop_bulk(args.batch, take);
+      consumed += n;
+      if (n) spins = 0;
+      else if (++spins & 255) cpu_relax();
+      else std::this_thread::yield();
+    }
+    while (std::size_t n = ch.pop_bulk(args.batch, take)) consumed += n;
+  });
+
+  start.store(true, std::memory_order_release);
+  tb::Stopwatch sw;
+  std::this_thread::sleep_for(std::chrono::duration<double>(args.seconds));
+  stop.store(true, std::memory_order_release);
+  for (auto& t : prods) t.join();
+  cons.join();
+  const double secs = sw.elapsed_sec();
+
+  std::uint64_t lo = UINT64_MAX, hi = 0, total = 0;
+  for (std::uint64_t s : sent) { lo = std::min(lo, s); hi = std::max(hi, s); total += s; }
+  std::cout << "[mpsc producers=" << nprod << " mode=" << mode_name(args.mode) << "] "
+            << double(consumed) / 1e6 / secs << " Mops/s total, "
+            << double(total) / 1e6 / secs / nprod << " Mops/s per producer"
+            << " (min/max " << double(lo) / 1e6 / secs << "/" << double(hi) / 1e6 / secs << ")"
+            << " drops=" << stats.drops_total.load()
+            << " max_depth=" << stats.max_depth.load()
+            << (ordered && consumed == total ? "" : "  ORDER/COUNT MISMATCH") << "\n";
+}
+
+int main(int argc, char** argv) {
+  const Args args = parse_args(argc, argv);
+  if (std::thread::hardware_concurrency() < 2)
+    std::cout << "note: fewer than 2 CPUs; producers and consumer share a core, scaling is not meaningful\n";
+  for (int p : args.producers)
+    if (p > 0) run(p, args);
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../engine/replay.hpp"
+#include "../engine/common/cpu.hpp"
+
+// Journal replay tool / throughput bench.
+//
+//   replay --journal DIR [--symbols S] [--expect EVENTS] [--record EVENTS] [--from SEQ] [--to SEQ]
+//   replay --generate N [--symbols S] --journal DIR       (writes DIR + DIR/events.log, then replays)
+//
+// Replays DIR through a fresh MatchEngine with symbols 1..S registered as
+// "#1".."#S" (default config, as --generate records them), verifies the event
+// stream against EVENTS (default DIR/events.log when it exists) and prints
+// commands/s. Exits 1 on any mismatch.
+
+struct Args {
+  std::string journal = "/tmp/lob_replay_journal";
+  std::string expect;
+  std::string record;
+  std::uint64_t from = 1, to = UINT64_MAX;
+  int generate = 0;
+  int symbols = 16;
+  int repeat = 1;
+  int cpu = -1;
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--journal") && i+1 < argc) a.journal = argv[++i];
+    else if (!std::strcmp(argv[i], "--expect") && i+1 < argc) a.expect = argv[++i];
+    else if (!std::strcmp(argv[i], "--record") && i+1 < argc) a.record = argv[++i];
+    else if (!std::strcmp(argv[i], "--from") && i+1 < argc) a.from = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--to") && i+1 < argc) a.to = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--generate") && i+1 < argc) a.generate = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--symbols") && i+1 < argc) a.symbols = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--repeat") && i+1 < argc) a.repeat = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin") && i+1 < argc) a.cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: replay [--journal DIR] [--symbols S] [--expect EVENTS] [--record EVENTS] [--from SEQ] [--to SEQ]\n"
+                   "              [--generate N] [--repeat K] [--pin CPU]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+static void register_symbols(MatchEngine& eng, int symbols) {
+  for (int s = 1; s <= symbols; ++s) eng.add_symbol("#" + std::to_string(s));
+}
+
+// Journal a synthetic multi-symbol session and record its event stream.
+static void generate(const Args& a, const std::string& events_path) {
+  std::filesystem::remove_all(a.journal);
+  Journal::Config jc;
+  jc.dir = a.journal;
+  Journal journal(jc);
+  EventBus bus(1u << 16);
+  MatchEngine eng(bus);
+  register_symbols(eng, a.symbols);
+  eng.set_journal(&journal);
+  EventLogWriter out(events_path);
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> op(0, 99), pd(-8, 8), qd(1, 10);
+  std::vector<OrderId> next(std::size_t(a.symbols) + 1, 1);
+  for (int i = 0; i < a.generate; ++i) {
+    const SymbolId sym = 1 + SymbolId(rng() % std::uint64_t(a.symbols));
+    OrderId& id = next[sym];
+    const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+    const Price px = 1000 + pd(rng) + (s == Side::Bid ? -2 : 2);
+    const int o = op(rng);
+    if (o < 15 && id > 64)      eng.cancel(sym, id - 1 - OrderId(rng() % 64));
+    else if (o < 20 && id > 64) eng.replace(sym, id & 3, id - 1 - OrderId(rng() % 64), px, qd(rng));
+    else if (o < 25)            { eng.market(sym, id & 3, id, s, qd(rng)); ++id; }
+    else                        { eng.add(sym, id & 3, id, s, px, qd(rng)); ++id; }
+    bus.poll_bulk(bus.capacity(), [&](Event&& ev){ out.append(ev); });
+  }
+  eng.set_journal(nullptr);
+  journal.close();
+  std::cout << "[generate] " << journal.last_seq() << " commands -> " << a.journal << ", "
+            << out.count() << " events -> " << events_path << "\n";
+}
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  if (args.cpu >= 0) cpu::pin_this_thread(args.cpu);
+  const std::string default_events = (std::filesystem::path(args.journal) / "events.log").string();
+  if (args.generate > 0) generate(args, args.expect.empty() ? default_events : args.expect);
+  if (args.expect.empty() && std::filesystem::exists(default_events)) args.expect = default_events;
+
+  std::unique_ptr<EventLog> expect;
+  if (!args.expect.empty()) expect = std::make_unique<EventLog>(args.expect);
+  std::unique_ptr<EventLogWriter> record;
+  if (!args.record.empty()) record = std::make_unique<EventLogWriter>(args.record);
+
+  bool ok = true;
+  for (int rep = 0; rep < args.repeat; ++rep) {
+    EventBus bus(1u << 16);
+    MatchEngine eng(bus);
+    register_symbols(eng, args.symbols);
+    ReplayOptions opt;
+    opt.expect = expect.get();
+    opt.record = rep == 0 ? record.get() : nullptr;
+    opt.from_seq = args.from;
+    opt.to_seq = args.to;
+    ReplayStats st;
+    try {
+      st = replay(args.journal, eng, bus, opt);
+    } catch (const std::exception& e) {
+      std::cerr << "[replay] " << e.what() << "\n";
+      return 1;
+    }
+
+    std::cout << "[replay] " << st.commands << " cmds, " << st.events << " events in "
+              << double(st.elapsed_ns) / 1e6 << " ms: " << st.msgs_per_sec() / 1e6 << " M msgs/s ("
+              << double(st.elapsed_ns) / double(st.commands ? st.commands : 1) << " ns/cmd), digest=" << std::hex
+              << st.digest << std::dec;
+    if (st.gaps) std::cout << ", " << st.gaps << " seq gaps";
+    if (expect) {
+      if (st.verified()) std::cout << ", verified against " << expect->size() << " events";
+      else std::cout << ", " << st.mismatches << " MISMATCHES, first at event " << st.first_mismatch
+                     << ": " << st.first_diff;
+    }
+    std::cout << "\n";
+    ok = ok && st.verified();
+  }
+  return ok ? 0 : 1;
+}
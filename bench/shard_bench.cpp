@@ -0,0 +1,149 @@
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../engine/sharded_engine.hpp"
+#include "../engine/common/cpu.hpp"
+#include "../engine/common/timebase.hpp"
+#include "../engine/common/trace.hpp"
+
+// Aggregate throughput of ShardedEngine vs shard count. One producer submits a
+// pre-generated multi-symbol flow (passive-leaning limits, IOC takers, market
+// orders, cancels) as fast as the rings accept it; the clock stops when every
+// shard has applied its last command. With a core per thread (producer,
+// router, shards, event drainer) throughput should grow close to linearly
+// until the router or the producer saturates. Put 1 first in --shards to get
+// speedups relative to it.
+//
+// --trace FILE (shard_bench_trace, built with LOB_TRACE) records per-command
+// trace points for the whole session; read them with trace_report FILE.
+
+struct Args {
+  int n = 2000000;                      // commands per run
+  int symbols = 64;
+  std::vector<int> shards{1, 2, 4};
+  int pin_base = -1;                    // >= 0: producer, router, shard i on pin_base+{0,1,2+i}
+  bool drain = true;                    // poll shard buses on a drainer thread
+  std::string trace;                    // trace file (LOB_TRACE builds)
+};
+
+static std::vector<int> parse_list(const char* s) {
+  std::vector<int> v;
+  for (const char* p = s; *p; ) {
+    v.push_back(std::atoi(p));
+    while (*p && *p != ',') ++p;
+    if (*p == ',') ++p;
+  }
+  return v;
+}
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--n") && i+1 < argc) a.n = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--symbols") && i+1 < argc) a.symbols = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--shards") && i+1 < argc) a.shards = parse_list(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin-base") && i+1 < argc) a.pin_base = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--no-drain")) a.drain = false;
+    else if (!std::strcmp(argv[i], "--trace") && i+1 < argc) a.trace = argv[++i];
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: shard_bench [--n N] [--symbols S] [--shards 1,2,4,...] [--pin-base CPU]\n"
+                   "                   [--no-drain] [--trace FILE]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+static std::vector<Command> make_flow(int n, int nsym) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> op(0, 99), pd(-8, 8), qd(1, 10);
+  std::vector<Command> v; v.reserve(std::size_t(n));
+  std::vector<OrderId> next(std::size_t(nsym), 1);
+  for (int i = 0; i < n; ++i) {
+    const SymbolId sym = SymbolId(rng() % std::uint64_t(nsym));
+    OrderId& id = next[sym];
+    const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+    const Price px = 1000 + pd(rng) + (s == Side::Bid ? -2 : 2);
+    const int o = op(rng);
+    if (o < 20 && id > 64) v.push_back(make_cancel(sym, id - 1 - OrderId(rng() % 64)));
+    else if (o < 25)       v.push_back(make_market(sym, id & 3, id, s, qd(rng))), ++id;
+    else if (o < 35)       v.push_back(make_add(sym, id & 3, id, s, px, qd(rng), lob::Book::TimeInForce::IOC)), ++id;
+    else                   v.push_back(make_add(sym, id & 3, id, s, px, qd(rng))), ++id;
+  }
+  return v;
+}
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  const auto flow = make_flow(args.n, args.symbols);
+  const unsigned cores = std::thread::hardware_concurrency();
+  double base = 0;
+
+  std::unique_ptr<trace::TraceWriter> tracer;
+  if (!args.trace.empty()) {
+    if (!trace::kEnabled) std::cout << "note: built without LOB_TRACE; use shard_bench_trace for --trace\n";
+    else tracer = std::make_unique<trace::TraceWriter>(args.trace);
+  }
+
+  for (int nshards : args.shards) {
+    ShardedEngine::Config cfg;
+    cfg.shards = std::size_t(nshards);
+    cfg.book.reserve_orders = std::size_t(args.n) / std::size_t(args.symbols) + 1024;
+    if (args.pin_base >= 0) {
+      cfg.router_cpu = args.pin_base + 1;
+      for (int i = 0; i < nshards; ++i) cfg.shard_cpus.push_back(args.pin_base + 2 + i);
+      cpu::pin_this_thread(args.pin_base);
+    }
+    ShardedEngine eng(cfg);
+    for (int s = 0; s < args.symbols; ++s) {
+      std::string name = "S";   // not "S" + to_string(s): GCC 12 -Wrestrict false positive
+      name += std::to_string(s);
+      eng.add_symbol(name);
+    }
+    eng.start();
+
+    std::atomic<bool> stop{false};
+    std::uint64_t events = 0;
+    std::thread drainer;
+    if (args.drain)
+      drainer = std::thread([&]{
+        while (!stop.load(std::memory_order_acquire))
+          for (std::size_t i = 0; i < eng.shards(); ++i)
+            events += eng.poll(i, [](const Event&){});
+      });
+
+    const auto t0 = tb::now_ns();
+    for (const Command& c : flow) eng.submit(c);
+    while (!eng.idle()) std::this_thread::yield();
+    const auto t1 = tb::now_ns();
+
+    eng.stop();
+    stop.store(true, std::memory_order_release);
+    if (drainer.joinable()) drainer.join();
+
+    const double secs = double(t1 - t0) / 1e9;
+    const double mps = double(flow.size()) / secs / 1e6;
+    if (nshards == 1) base = mps;
+    std::cout << "[shards=" << nshards << "] " << flow.size() << " cmds in " << secs * 1e3 << " ms: "
+              << mps << " Mcmd/s (";
+    if (base > 0) std::cout << mps / base << "x vs 1 shard, ";
+    for (int i = 0; i < nshards; ++i) std::cout << (i ? "/" : "per-shard cmds ") << eng.processed(std::size_t(i));
+    std::cout << ", events=" << events << ")\n";
+    if (unsigned(nshards) + 3 > cores)
+      std::cout << "  note: " << nshards + 3 << " busy threads on " << cores
+                << " cores; scaling is capped by oversubscription\n";
+  }
+
+  if (tracer) {
+    tracer->stop();
+    std::cout << "[trace] " << tracer->written() << " records to " << args.trace
+              << " (dropped " << trace::registry().dropped() << ")\n";
+  }
+}
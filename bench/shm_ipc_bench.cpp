@@ -0,0 +1,136 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../engine/spsc/shm_spsc_ring.hpp"
+#include "../engine/spsc/spsc_channel.hpp"   // cpu_relax
+#include "../engine/events.hpp"
+#include "../engine/common/timebase.hpp"
+#include "../engine/common/cpu.hpp"
+#include "../engine/common/metrics.hpp"
+
+// Event round trips through a pair of ShmSpscRing<Event>: ping (us -> echo)
+// and pong (echo -> us). The echo side runs first as a thread in this
+// process, then as a separate process attached to the same kind of rings,
+// so the two latencies can be compared directly.
+struct Args {
+  int iters = 200000;
+  int warmup = 10000;
+  bool memfd = false;              // share via inherited memfd instead of names
+  int cpu = -1, echo_cpu = -1;
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--iters") && i+1 < argc) a.iters = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--warmup") && i+1 < argc) a.warmup = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--memfd")) a.memfd = true;
+    else if (!std::strcmp(argv[i], "--pin") && i+1 < argc) a.cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin-echo") && i+1 < argc) a.echo_cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: shm_ipc_bench [--iters N] [--warmup N] [--memfd] [--pin CPU] [--pin-echo CPU]\n";
+      std::exit(0);
+    }
+  }
+  if (a.iters < 1) a.iters = 1;
+  return a;
+}
+
+using Ring = ShmSpscRing<Event>;
+
+// Spin a little, then let the other side run (matters on shared cores).
+static inline void wait_step(unsigned& spins) {
+  if (++spins & 255) cpu_relax(); else sched_yield();
+}
+
+// Echo every event back until one with seq == 0 arrives.
+static void echo(Ring& ping, Ring& pong) {
+  unsigned spins = 0;
+  for (;;) {
+    Event* ev = ping.peek();
+    if (!ev) { wait_step(spins); continue; }
+    spins = 0;
+    const Event copy = *ev;
+    ping.release();
+    while (!pong.try_push(copy)) cpu_relax();
+    if (copy.seq == 0) return;
+  }
+}
+
+static void pingpong(const char* label, Ring& ping, Ring& pong, const Args& args) {
+  LatencyHistogram rtt;
+  Event ev(FillEvent{1, 2, 100, 1, 0, Side::Bid});
+  for (int i = -args.warmup; i < args.iters; ++i) {
+    ev.seq = std::uint64_t(i + args.warmup + 1);
+    const std::uint64_t t0 = tb::now_ns();
+    ev.ts_ns = t0;
+    while (!ping.try_push(ev)) cpu_relax();
+    Event back;
+    unsigned spins = 0;
+    while (!pong.try_pop(back)) wait_step(spins);
+    if (i >= 0) rtt.record(tb::now_ns() - t0);
+    if (back.seq != ev.seq) { std::cerr << "[" << label << "] echo out of order\n"; std::exit(1); }
+  }
+  ev.seq = 0;                                   // tell the echo side to stop
+  while (!ping.try_push(ev)) cpu_relax();
+  Event last;
+  while (!pong.try_pop(last)) sched_yield();
+
+  const auto s = rtt.summary();
+  std::cout << "[" << label << "] rtt " << s << " (one-way ~" << s.p50 / 2 << " ns)\n";
+}
+
+int main(int argc, char** argv) {
+  const Args args = parse_args(argc, argv);
+  if (args.cpu >= 0) cpu::pin_this_thread(args.cpu);
+
+  {
+    Ring ping = Ring::create_memfd(1024), pong = Ring::create_memfd(1024);
+    std::thread t([&]{
+      if (args.echo_cpu >= 0) cpu::pin_this_thread(args.echo_cpu);
+      echo(ping, pong);
+    });
+    pingpong("thread", ping, pong, args);
+    t.join();
+  }
+
+  const std::string base = "/mhft_ipc_bench_" + std::to_string(::getpid());
+  Ring ping = args.memfd ? Ring::create_memfd(1024) : Ring::create(base + ".ping", 1024);
+  Ring pong = args.memfd ? Ring::create_memfd(1024) : Ring::create(base + ".pong", 1024);
+  const int ping_fd = ping.region().fd(), pong_fd = pong.region().fd();
+
+  const pid_t pid = ::fork();
+  if (pid < 0) { std::perror("fork"); return 1; }
+  if (pid == 0) {
+    // A fresh mapping, attached the way an unrelated process would.
+    try {
+      if (args.echo_cpu >= 0) cpu::pin_this_thread(args.echo_cpu);
+      Ring in = args.memfd ? Ring::attach_fd(ping_fd) : Ring::attach(base + ".ping");
+      Ring out = args.memfd ? Ring::attach_fd(pong_fd) : Ring::attach(base + ".pong");
+      echo(in, out);
+    } catch (const std::exception& e) {
+      std::cerr << "echo process: " << e.what() << "\n";
+      ::_exit(1);
+    }
+    ::_exit(0);
+  }
+  pingpong(args.memfd ? "process memfd" : "process shm", ping, pong, args);
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  if (!args.memfd) {
+    io::SharedMemory::unlink(base + ".ping");
+    io::SharedMemory::unlink(base + ".pong");
+  }
+  if (std::thread::hardware_concurrency() < 2)
+    std::cout << "note: single core; both sides time-slice, so these are scheduler round trips, not cache-line transfers\n";
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../engine/lob/snapshot.hpp"
+#include "../engine/common/timebase.hpp"
+
+// Snapshot/restore cost vs resting order count: builds a deep book, saves it
+// with lob::snapshot::save, restores it with load_book (which includes the
+// check_invariants validation pass) and reports ms, ns/order and MB/s.
+
+struct Args {
+  std::vector<int> orders{10000, 100000, 1000000};
+  lob::LadderKind ladder = lob::LadderKind::Map;
+  lob::LevelQueue queue = lob::LevelQueue::List;
+  std::string path = "/tmp/lob_snapshot_bench.snap";
+};
+
+static std::vector<int> parse_list(const char* s) {
+  std::vector<int> v;
+  for (const char* p = s; *p; ) {
+    v.push_back(std::atoi(p));
+    while (*p && *p != ',') ++p;
+    if (*p == ',') ++p;
+  }
+  return v;
+}
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--orders") && i+1 < argc) a.orders = parse_list(argv[++i]);
+    else if (!std::strcmp(argv[i], "--ladder") && i+1 < argc) {
+      std::string m = argv[++i];
+      a.ladder = (m == "flat") ? lob::LadderKind::Flat : lob::LadderKind::Map;
+    }
+    else if (!std::strcmp(argv[i], "--queue") && i+1 < argc) {
+      std::string m = argv[++i];
+      a.queue = (m == "ring") ? lob::LevelQueue::Ring : lob::LevelQueue::List;
+    }
+    else if (!std::strcmp(argv[i], "--path") && i+1 < argc) a.path = argv[++i];
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: snapshot_bench [--orders 10000,100000,...] [--ladder map|flat] [--queue list|ring]\n"
+                   "                      [--path FILE]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  for (int n : args.orders) {
+    lob::Book::BookConfig cfg;
+    cfg.ladder = args.ladder;
+    cfg.queue = args.queue;
+    cfg.reserve_orders = std::size_t(n);
+    lob::Book book(cfg);
+    // Non-crossing resting book: bids 1..500 ticks under 10000, asks above.
+    std::mt19937_64 rng(7);
+    for (lob::OrderId id = 1; id <= lob::OrderId(n); ++id) {
+      const bool bid = rng() & 1;
+      const lob::Price off = 1 + lob::Price(rng() % 500);
+      book.submit(1 + rng() % 16, bid ? lob::Side::Bid : lob::Side::Ask, bid ? 10000 - off : 10000 + off,
+                  1 + lob::Qty(rng() % 100), id, lob::Book::OrderType::Limit, lob::Book::TimeInForce::Day);
+    }
+
+    auto t0 = tb::now_ns();
+    lob::snapshot::save(book, args.path);
+    auto t1 = tb::now_ns();
+    lob::Book back = lob::snapshot::load_book(args.path);
+    auto t2 = tb::now_ns();
+
+    const double mb = double(sizeof(lob::snapshot::FileHeader) + sizeof(lob::snapshot::BookHeader) +
+                             std::size_t(n) * sizeof(lob::snapshot::OrderRecord)) / 1e6;
+    auto report = [&](const char* what, std::uint64_t ns){
+      std::cout << "[" << lob::ladder_str(args.ladder) << "," << lob::level_queue_str(args.queue)
+                << ",orders=" << n << "] " << what << ": " << double(ns) / 1e6 << " ms, "
+                << double(ns) / n << " ns/order, " << mb / (double(ns) / 1e9) << " MB/s\n";
+    };
+    report("snapshot", t1 - t0);
+    report("restore ", t2 - t1);
+    if (back.id_index_.size() != std::size_t(n)) { std::cerr << "restore lost orders\n"; return 1; }
+  }
+  std::remove(args.path.c_str());
+}
@@ -6,19 +6,34 @@
 #include <string>
 #include <cstring>
 #include <chrono>
+#include <vector>
+#include <time.h>
 
 #include "../engine/spsc/spsc_channel.hpp"
 #include "../engine/common/timebase.hpp"
 #include "../engine/common/cpu.hpp"
+#include "../engine/common/metrics.hpp"
 
+// Producer -> SpscChannel -> consumer (pop_wait) under each BpMode.
+// Besides throughput and drops it reports what each side's waiting costs:
+// CPU time per thread (% of wall) and push-to-pop latency. Use --rate to
+// pace the producer; flat out, every mode is busy and the CPU numbers are
+// all ~100%.
 struct Args {
   int seconds = 5;
   std::size_t capacity = 1u << 18; // 262,144
   std::size_t high_wm  = (1u << 18) * 3 / 4;
   std::size_t low_wm   = (1u << 18) / 2;
   int prod_cpu = -1, cons_cpu = -1;
-  BpMode mode = BpMode::Drop;
+  std::vector<BpMode> modes{BpMode::Drop};
   int consumer_slow_ns = 0; // simulate slowness per pop
+  uint64_t rate = 0;        // producer msgs/s (0 = flat out)
+  uint64_t sleep_ns = 5000; // Sleep mode period
+};
+
+struct Msg {
+  uint64_t ts_ns;
+  uint32_t seq;
 };
 
 static Args parse_args(int argc, char** argv) {
@@ -32,15 +47,20 @@ static Args parse_args(int argc, char** argv) {
     else if (!std::strcmp(argv[i], "--pin-cons") && i+1 < argc) a.cons_cpu = std::atoi(argv[++i]);
     else if (!std::strcmp(argv[i], "--mode") && i+1 < argc) {
       std::string m = argv[++i];
-      if (m == "drop") a.mode = BpMode::Drop;
-      else if (m == "spin") a.mode = BpMode::Spin;
-      else if (m == "sleep") a.mode = BpMode::Sleep;
+      if (m == "drop") a.modes = {BpMode::Drop};
+      else if (m == "spin") a.modes = {BpMode::Spin};
+      else if (m == "sleep") a.modes = {BpMode::Sleep};
+      else if (m == "hybrid") a.modes = {BpMode::Hybrid};
+      else if (m == "all") a.modes = {BpMode::Drop, BpMode::Spin, BpMode::Sleep, BpMode::Hybrid};
     }
     else if (!std::strcmp(argv[i], "--cons-slow-ns") && i+1 < argc) a.consumer_slow_ns = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--rate") && i+1 < argc) a.rate = std::stoull(argv[++i]);
+    else if (!std::strcmp(argv[i], "--sleep-ns") && i+1 < argc) a.sleep_ns = std::stoull(argv[++i]);
     else if (!std::strcmp(argv[i], "--help")) {
       std::cout <<
         "Usage: spsc_backpressure_bench [--seconds N] [--cap POW2]\n"
-        "       [--high N] [--low N] [--mode drop|spin|sleep]\n"
+        "       [--high N] [--low N] [--mode drop|spin|sleep|hybrid|all]\n"
+        "       [--rate MSGS_PER_SEC] [--sleep-ns N]\n"
         "       [--cons-slow-ns N] [--pin-prod CPU] [--pin-cons CPU]\n";
       std::exit(0);
     }
@@ -48,37 +68,62 @@ static Args parse_args(int argc, char** argv) {
   return a;
 }
 
-int main(int argc, char** argv) {
-  auto args = parse_args(argc, argv);
+static const char* mode_name(BpMode m) {
+  switch (m) {
+  case BpMode::Drop: return "drop";
+  case BpMode::Spin: return "spin";
+  case BpMode::Sleep: return "sleep";
+  case BpMode::Hybrid: return "hybrid";
+  }
+  return "?";
+}
+
+// CPU time this thread has used so far.
+static uint64_t thread_cpu_ns() {
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+static void run(BpMode mode, const Args& args) {
   SpscStats stats;
-  BackpressureCfg cfg{args.high_wm, args.low_wm, args.mode, 5000};
-  SpscChannel<uint32_t> ch(args.capacity, cfg, &stats);
+  BackpressureCfg cfg{args.high_wm, args.low_wm, mode, args.sleep_ns};
+  SpscChannel<Msg> ch(args.capacity, cfg, &stats);
 
   std::atomic<bool> start{false}, stop{false};
   uint64_t prod_cnt = 0, cons_cnt = 0;
+  uint64_t prod_cpu_ns = 0, cons_cpu_ns = 0;
+  LatencyHistogram lat;
 
   std::thread prod([&]{
     if (args.prod_cpu >= 0) cpu::pin_this_thread(args.prod_cpu);
     cpu::set_name("producer");
     uint32_t x = 0;
     while (!start.load(std::memory_order_acquire)) { cpu_relax(); }
+    const uint64_t cpu0 = thread_cpu_ns();
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto period = std::chrono::nanoseconds(args.rate ? 1000000000ull / args.rate : 0);
     while (!stop.load(std::memory_order_relaxed)) {
-      if (ch.push(x, &stop)) { ++prod_cnt; ++x; }
+      if (args.rate) std::this_thread::sleep_until(t0 + period * x);   // catches up after oversleeping
+      if (ch.push(Msg{tb::now_ns(), x}, &stop)) ++prod_cnt;
+      ++x;
     }
+    prod_cpu_ns = thread_cpu_ns() - cpu0;
   });
 
   std::thread cons([&]{
     if (args.cons_cpu >= 0) cpu::pin_this_thread(args.cons_cpu);
     cpu::set_name("consumer");
-    uint32_t out;
+    Msg out;
     auto slow = std::chrono::nanoseconds(args.consumer_slow_ns);
     while (!start.load(std::memory_order_acquire)) {cpu_relax();}
-    while (!stop.load(std::memory_order_relaxed)) {
-      if (ch.pop(out)) {
-        ++cons_cnt; // simulate consumer doing work (sleep for slow)
-        if (args.consumer_slow_ns > 0) std::this_thread::sleep_for(slow);
-      }
+    const uint64_t cpu0 = thread_cpu_ns();
+    while (ch.pop_wait(out, &stop)) {
+      lat.record(tb::now_ns() - out.ts_ns);
+      ++cons_cnt; // simulate consumer doing work (sleep for slow)
+      if (args.consumer_slow_ns > 0) std::this_thread::sleep_for(slow);
     }
+    cons_cpu_ns = thread_cpu_ns() - cpu0;
   });
 
   std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -88,20 +133,32 @@ int main(int argc, char** argv) {
   while (sw.elapsed_sec() < args.seconds) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
   }
-  stop.store(true, std::memory_order_release); // start stop flag 
+  stop.store(true, std::memory_order_release); // start stop flag
   prod.join(); cons.join();
 
   const double secs = sw.elapsed_sec();
   const double mops = double(cons_cnt) / 1e6 / secs;
 
-  std::cout << "mode=" << (args.mode==BpMode::Drop?"drop":args.mode==BpMode::Spin?"spin":"sleep")
+  std::cout << "mode=" << mode_name(mode)
             << " cap=" << args.capacity
             << " high=" << args.high_wm << " low=" << args.low_wm
-            << " cons_slow_ns=" << args.consumer_slow_ns << "\n";
+            << " cons_slow_ns=" << args.consumer_slow_ns
+            << " rate=" << (args.rate ? std::to_string(args.rate) : "max") << "\n";
   std::cout << "consumed=" << cons_cnt << " in " << secs << " s → " << mops << " Mops/s\n";
   std::cout << "produced=" << prod_cnt << " drops=" << stats.drops_total.load()
             << " max_depth=" << stats.max_depth.load()
-            << " depth_now=" << stats.depth_gauge.load() << "\n";
-  return 0;
+            << " depth_now=" << stats.depth_gauge.load()
+            << " parks=" << stats.parks.load() << "\n";
+  std::cout << "cpu: producer=" << 100.0 * double(prod_cpu_ns) / 1e9 / secs
+            << "% consumer=" << 100.0 * double(cons_cpu_ns) / 1e9 / secs << "%";
+  if (lat.count()) std::cout << "  latency " << lat.summary();
+  std::cout << "\n\n";
 }
 
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  for (BpMode m : args.modes) run(m, args);
+  if (std::thread::hardware_concurrency() < 2)
+    std::cout << "note: single core; spinning modes steal the other side's time slice\n";
+  return 0;
+}
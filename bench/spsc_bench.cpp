@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <iostream>
@@ -8,8 +9,10 @@
 #include <chrono>
 
 #include "../engine/spsc/spsc_ring.hpp"
+#include "../engine/spsc/cached_spsc_ring.hpp"
 #include "../engine/common/timebase.hpp"
 #include "../engine/common/cpu.hpp"
+#include "../engine/common/metrics.hpp"
 
 #if defined(__x86_64__) || defined(_M_X64)
   #include <immintrin.h>
@@ -24,6 +27,9 @@ struct Args {
     std::size_t capacity = 1u << 20; // 1,048,576 slots
     int prod_cpu = -1;
     int cons_cpu = -1;
+    std::string ring = "both";       // plain | cached | both
+    std::size_t batch = 1;           // >1: try_push_bulk / try_pop_bulk
+    int rtt_iters = 100000;          // ping-pong round trips (0 = skip latency)
 };
 
 static Args parse_args(int argc, char** argv) {
@@ -33,49 +39,73 @@ static Args parse_args(int argc, char** argv) {
         else if (!std::strcmp(argv[i], "--cap") && i+1 < argc) a.capacity = std::stoull(argv[++i]);
         else if (!std::strcmp(argv[i], "--pin-prod") && i+1 < argc) a.prod_cpu = std::atoi(argv[++i]);
         else if (!std::strcmp(argv[i], "--pin-cons") && i+1 < argc) a.cons_cpu = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--ring") && i+1 < argc) a.ring = argv[++i];
+        else if (!std::strcmp(argv[i], "--batch") && i+1 < argc) a.batch = std::stoull(argv[++i]);
+        else if (!std::strcmp(argv[i], "--rtt-iters") && i+1 < argc) a.rtt_iters = std::atoi(argv[++i]);
         else if (!std::strcmp(argv[i], "--help")) {
             std::cout <<
-              "Usage: spsc_bench [--seconds N] [--cap POW2] [--pin-prod CPU] [--pin-cons CPU]\n";
+              "Usage: spsc_bench [--seconds N] [--cap POW2] [--pin-prod CPU] [--pin-cons CPU]\n"
+              "                  [--ring plain|cached|both] [--batch N] [--rtt-iters N]\n";
             std::exit(0);
         }
     }
+    if (a.batch == 0) a.batch = 1;
     return a;
 }
 
-int main(int argc, char** argv) {
-    auto args = parse_args(argc, argv);
-    SpscRing<uint32_t> q(args.capacity);
+// Spin a little, then let the other thread run (matters on shared cores).
+static inline void wait_step(unsigned& spins) {
+    if (++spins & 255) cpu_relax(); else std::this_thread::yield();
+}
+
+// Throughput: producer and consumer threads flat out for --seconds.
+template<typename Ring>
+static void run_throughput(const char* label, const Args& args) {
+    Ring q(args.capacity);
 
     std::atomic<bool> start{false}; //in main thread (accessed by prod and cons thread)
     std::atomic<bool> stop{false}; // in main thread (accessed by prod and cons thread)
 
     uint64_t prod_cnt = 0, cons_cnt = 0;
+    bool ordered = true;
 
     std::thread prod([&]{ // thread operates outside of main block
         if (args.prod_cpu >= 0) cpu::pin_this_thread(args.prod_cpu);
         cpu::set_name("producer");
         uint32_t x = 0; // monotonic counter {0,1,2,3,4,5...} for verification
+        unsigned spins = 0;
         while (!start.load(std::memory_order_acquire)) cpu_relax(); //wait for green lit
         while (!stop.load(std::memory_order_relaxed)) { // stop when stop = True
-            if (q.try_push(x)) {
-                ++prod_cnt; ++x;
+            std::size_t n;
+            if (args.batch == 1) {
+                n = q.try_push(x);
             } else {
-                cpu_relax();
+                // Values derive from prod_cnt: SpscRing's bulk push may drop the
+                // value it generated when it finds the ring full.
+                uint32_t k = 0;
+                n = q.try_push_bulk(args.batch, [&]{ return x + k++; });
             }
+            prod_cnt += n; x += uint32_t(n);
+            if (!n) wait_step(spins);
         }
     });
 
     std::thread cons([&]{ // thread operates outside of main block
         if (args.cons_cpu >= 0) cpu::pin_this_thread(args.cons_cpu);
         cpu::set_name("consumer");
-        uint32_t out;
+        uint32_t out, expect = 0;
+        unsigned spins = 0;
         while (!start.load(std::memory_order_acquire)) cpu_relax(); //wait for green lit
         while (!stop.load(std::memory_order_relaxed)) {
-            if (q.try_pop(out)) {
-                ++cons_cnt;
+            std::size_t n;
+            if (args.batch == 1) {
+                n = q.try_pop(out);
+                if (n) ordered &= out == expect++;
             } else {
-                cpu_relax();
+                n = q.try_pop_bulk(args.batch, [&](uint32_t&& v){ ordered &= v == expect++; });
             }
+            cons_cnt += n;
+            if (!n) wait_step(spins);
         }
     });
 
@@ -89,16 +119,60 @@ int main(int argc, char** argv) {
     }
     stop.store(true, std::memory_order_release); // signal to stop
 
-    prod.join(); // wait for threads to finish 
+    prod.join(); // wait for threads to finish
     cons.join(); // wait for threads to finish
-		
-		// compute and print stats
+
+    // compute and print stats
     double secs = sw.elapsed_sec();
     double ops = double(cons_cnt); // count pops (completed msgs)
     double mops = ops / 1e6 / secs;
-    std::cout << "SPSC: " << ops << " msgs in " << secs << " s → "
-              << mops << " Mops/s\n"
-              << "produced=" << prod_cnt << " consumed=" << cons_cnt
-              << " backlog=" << (prod_cnt - cons_cnt) << "\n";
+    std::cout << "[" << label << "] throughput (batch=" << args.batch << "): " << ops << " msgs in "
+              << secs << " s → " << mops << " Mops/s\n"
+              << "[" << label << "] produced=" << prod_cnt << " consumed=" << cons_cnt
+              << " backlog=" << (prod_cnt - cons_cnt) << (ordered ? "" : " ORDER ERROR") << "\n";
+}
+
+// Cross-core latency: ping-pong one value through two rings; one-way is
+// about half the round trip.
+template<typename Ring>
+static void run_latency(const char* label, const Args& args) {
+    if (args.rtt_iters <= 0) return;
+    Ring ping(1024), pong(1024);
+    std::atomic<bool> done{false};
+    std::thread echo([&]{
+        if (args.cons_cpu >= 0) cpu::pin_this_thread(args.cons_cpu);
+        cpu::set_name("echo");
+        uint32_t v;
+        unsigned spins = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            if (ping.try_pop(v)) { while (!pong.try_push(v)) cpu_relax(); spins = 0; }
+            else wait_step(spins);
+        }
+    });
+    if (args.prod_cpu >= 0) cpu::pin_this_thread(args.prod_cpu);
+    LatencyHistogram rtt;
+    for (int i = 0; i < args.rtt_iters; ++i) {
+        const uint64_t t0 = tb::now_ns();
+        ping.try_push(uint32_t(i));
+        uint32_t v;
+        unsigned spins = 0;
+        while (!pong.try_pop(v)) wait_step(spins);
+        rtt.record(tb::now_ns() - t0);
+    }
+    done.store(true, std::memory_order_relaxed);
+    echo.join();
+    const auto s = rtt.summary();
+    std::cout << "[" << label << "] latency: rtt " << s << " (one-way ~" << s.p50 / 2 << " ns)\n";
+}
+
+int main(int argc, char** argv) {
+    auto args = parse_args(argc, argv);
+    const bool plain = args.ring != "cached", cached = args.ring != "plain";
+    if (plain)  run_throughput<SpscRing<uint32_t>>("plain", args);
+    if (cached) run_throughput<CachedSpscRing<uint32_t>>("cached", args);
+    if (plain)  run_latency<SpscRing<uint32_t>>("plain", args);
+    if (cached) run_latency<CachedSpscRing<uint32_t>>("cached", args);
+    if (std::thread::hardware_concurrency() < 2)
+        std::cout << "note: single core; threads time-slice, so neither number reflects cross-core cost\n";
     return 0;
 }
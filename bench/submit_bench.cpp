@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../engine/lob/book.hpp"
+#include "../engine/common/cpu.hpp"
+#include "../engine/common/metrics.hpp"
+#include "../engine/common/perf_counter.hpp"
+#include "../engine/common/timebase.hpp"
+
+using lob::OrderId;
+using lob::Price;
+using lob::Qty;
+
+// Matching-core micro-bench: a fixed, randomized mix of bid/ask, limit/market
+// and Day/IOC/FOK commands (plus cancels) straight into lob::Book through the
+// runtime-dispatched submit(). Reports ns/op and retired instructions/op for
+// the whole batch, then per-command latency percentiles from a second, timed pass.
+
+struct Args {
+  int n = 500000;          // commands per pass
+  int cpu = 0;             // -1 = don't pin
+  lob::LadderKind ladder = lob::LadderKind::Map;
+  lob::LevelQueue queue = lob::LevelQueue::List;
+  bool depth_tree = false;
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--n") && i+1 < argc) a.n = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin") && i+1 < argc) a.cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--ladder") && i+1 < argc) {
+      std::string m = argv[++i];
+      a.ladder = (m == "flat") ? lob::LadderKind::Flat : lob::LadderKind::Map;
+    }
+    else if (!std::strcmp(argv[i], "--queue") && i+1 < argc) {
+      std::string m = argv[++i];
+      a.queue = (m == "ring") ? lob::LevelQueue::Ring : lob::LevelQueue::List;
+    }
+    else if (!std::strcmp(argv[i], "--depth-tree")) a.depth_tree = true;
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: submit_bench [--n N] [--pin CPU|-1] [--ladder map|flat] [--queue list|ring]\n"
+                   "                    [--depth-tree]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+struct Cmd {
+  bool cancel;
+  lob::Side side;
+  lob::Book::OrderType type;
+  lob::Book::TimeInForce tif;
+  Price px; Qty qty; OrderId id;
+};
+
+static std::vector<Cmd> make_flow(int n) {
+  using OT = lob::Book::OrderType;
+  using TIF = lob::Book::TimeInForce;
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> op(0, 99), pd(-8, 8), qd(1, 10);
+  std::vector<Cmd> v; v.reserve(n);
+  OrderId next = 1;
+  for (int i = 0; i < n; ++i) {
+    int o = op(rng);
+    lob::Side s = (rng() & 1) ? lob::Side::Bid : lob::Side::Ask;
+    // Passive-leaning prices around 1000 keep a standing book on both sides.
+    Price px = 1000 + pd(rng) + (s == lob::Side::Bid ? -2 : 2);
+    if (o < 20 && next > 64) {
+      v.push_back({true, s, OT::Limit, TIF::Day, 0, 0, next - 1 - OrderId(rng() % 64)});
+      continue;
+    }
+    Cmd c{false, s, OT::Limit, TIF::Day, px, qd(rng), next++};
+    if (o >= 85)      c.tif = TIF::IOC;
+    else if (o >= 80) c.tif = TIF::FOK;
+    else if (o >= 75) { c.type = OT::Market; c.tif = TIF::IOC; c.px = 0; }
+    v.push_back(c);
+  }
+  return v;
+}
+
+struct CountSink {
+  std::uint64_t* n;
+  void operator()(const lob::Book::MatchFill& f) const { *n += std::uint64_t(f.qty); }
+};
+
+static std::uint64_t run(lob::Book& b, const Cmd& c, std::uint64_t& filled) {
+  if (c.cancel) return b.cancel(c.id).ok;
+  auto r = b.submit(c.id & 3, c.side, c.px, c.qty, c.id, c.type, c.tif, CountSink{&filled});
+  return r.fill_count;
+}
+
+int main(int argc, char** argv) {
+  auto args = parse_args(argc, argv);
+  if (args.cpu >= 0) cpu::pin_this_thread(args.cpu);
+
+  const auto flow = make_flow(args.n);
+  lob::Book::BookConfig cfg;
+  cfg.ladder = args.ladder;
+  cfg.queue = args.queue;
+  cfg.depth_tree = args.depth_tree;
+  cfg.reserve_orders = std::size_t(args.n);
+
+  // Pass 1: whole batch, instructions + wall time (no per-op timer noise).
+  std::uint64_t filled = 0, sink = 0;
+  perf::InstrCounter ic;
+  {
+    lob::Book warm(cfg);
+    for (auto const& c : flow) sink += run(warm, c, filled);
+  }
+  lob::Book b1(cfg);
+  auto t0 = tb::now_ns();
+  ic.start();
+  for (auto const& c : flow) sink += run(b1, c, filled);
+  ic.stop();
+  auto t1 = tb::now_ns();
+  const double nops = double(flow.size());
+  std::cout << "[" << lob::ladder_str(args.ladder) << "," << lob::level_queue_str(args.queue) << "] batch: "
+            << double(t1 - t0) / nops << " ns/op";
+  if (ic.ok()) std::cout << ", " << double(ic.read()) / nops << " instr/op";
+  else         std::cout << ", instr/op n/a (perf_event_open unavailable)";
+  std::cout << " (" << flow.size() << " ops)\n";
+
+  // Pass 2: per-command latency.
+  lob::Book b2(cfg);
+  LatencyHistogram ns;
+  for (auto const& c : flow) {
+    auto s0 = tb::fast_now_ns();
+    sink += run(b2, c, filled);
+    ns.record(tb::fast_now_ns() - s0);
+  }
+  std::cout << "[" << lob::ladder_str(args.ladder) << "," << lob::level_queue_str(args.queue) << "] per-op: "
+            << ns.summary() << "\n";
+  std::cout << "checksum: fills=" << sink << " qty=" << filled << "\n";
+}
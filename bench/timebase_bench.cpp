@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include <time.h>
+
+#include "../engine/common/cpu.hpp"
+#include "../engine/common/timebase.hpp"
+
+// Timestamp overhead: ns per call for every clock the engine could stamp
+// with (steady_clock, raw clock_gettime, the TSC reads and TscClock), then
+// how far TscClock drifts from steady_clock with and without periodic
+// recalibration.
+
+struct Args {
+  long n = 20'000'000;     // calls per clock
+  int seconds = 3;         // drift run length
+  int cpu = 0;             // -1 = don't pin
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--n") && i+1 < argc) a.n = std::atol(argv[++i]);
+    else if (!std::strcmp(argv[i], "--seconds") && i+1 < argc) a.seconds = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pin") && i+1 < argc) a.cpu = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: timebase_bench [--n CALLS] [--seconds S] [--pin CPU|-1]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+static volatile std::uint64_t sink;
+
+template<typename F>
+static void time_calls(const char* label, long n, F read) {
+  std::uint64_t acc = 0;
+  for (long i = 0; i < n / 16; ++i) acc += read();      // warm-up
+  const std::uint64_t t0 = tb::now_ns();
+  for (long i = 0; i < n; ++i) acc += read();
+  const std::uint64_t t1 = tb::now_ns();
+  sink = acc;
+  std::cout << "[" << label << "] " << std::fixed << std::setprecision(2)
+            << double(t1 - t0) / double(n) << " ns/call\n";
+}
+
+static std::uint64_t raw_monotonic() {
+  timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return std::uint64_t(ts.tv_sec) * 1'000'000'000ull + std::uint64_t(ts.tv_nsec);
+}
+
+// Worst |TscClock - steady_clock| seen over `seconds`, sampled every 10 ms.
+static std::int64_t drift(tb::TscClock& clk, int seconds, bool recal) {
+  std::int64_t worst = 0;
+  for (int i = 0; i < seconds * 100; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (recal && i % 100 == 99) clk.recalibrate();
+    worst = std::max<std::int64_t>(worst, std::llabs(clk.error_ns()));
+  }
+  return worst;
+}
+
+int main(int argc, char** argv) {
+  Args args = parse_args(argc, argv);
+  if (args.cpu >= 0) tb::pin_thread_to_cpu(args.cpu);
+
+  tb::TscClock& clk = tb::tsc_clock();
+  std::cout << "invariant TSC: " << (tb::tsc_invariant() ? "yes" : "no")
+            << ", TscClock " << (clk.uses_tsc() ? "on the TSC" : "falls back to steady_clock");
+  if (clk.uses_tsc()) std::cout << " @ " << std::setprecision(4) << clk.ghz() << " GHz";
+  std::cout << "\n";
+
+  time_calls("steady_clock", args.n, [] { return tb::now_ns(); });
+  time_calls("clock_gettime", args.n, raw_monotonic);
+  if (clk.uses_tsc()) {
+    time_calls("rdtsc", args.n, [] { return tb::rdtsc(); });
+    time_calls("rdtscp", args.n, [] { return tb::rdtscp(); });
+    time_calls("lfence+rdtsc", args.n, [] { return tb::rdtsc_fenced(); });
+  }
+  time_calls("TscClock::ticks", args.n, [&] { return clk.ticks(); });
+  time_calls("TscClock::now_ns", args.n, [&] { return clk.now_ns(); });
+  time_calls("fast_now_ns", args.n, [] { return tb::fast_now_ns(); });
+
+  if (clk.uses_tsc() && args.seconds > 0) {
+    tb::TscClock fixed, steered;
+    std::cout << "[drift] " << args.seconds << " s, worst |TscClock - steady_clock|: "
+              << "calibrated once " << drift(fixed, args.seconds, false) << " ns, "
+              << "recalibrated every 1 s " << drift(steered, args.seconds, true) << " ns\n";
+  }
+  return 0;
+}
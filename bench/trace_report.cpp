@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "../engine/trace_report.hpp"
+
+// Per-stage latency breakdown of a trace file written by trace::TraceWriter
+// (any binary built with -DLOB_TRACE, e.g. shard_bench_trace --trace FILE).
+//
+//   trace_report FILE [--raw N]
+//
+// Prints queue / submit / publish / bus / end-to-end percentiles and, with
+// --raw, the first N records.
+
+struct Args {
+  std::string path;
+  std::size_t raw = 0;
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--raw") && i+1 < argc) a.raw = std::size_t(std::atol(argv[++i]));
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: trace_report FILE [--raw N]\n";
+      std::exit(0);
+    }
+    else a.path = argv[i];
+  }
+  if (a.path.empty()) {
+    std::cerr << "trace_report: no trace file (see --help)\n";
+    std::exit(2);
+  }
+  return a;
+}
+
+int main(int argc, char** argv) {
+  const Args args = parse_args(argc, argv);
+  const trace::TraceFile tf(args.path);
+  std::cout << "[trace] " << args.path << ": " << tf.size() << " records, "
+            << std::setprecision(4) << tf.ns_per_tick() << " ns/tick\n";
+
+  for (std::size_t i = 0; i < std::min(args.raw, tf.size()); ++i) {
+    const trace::Record& r = tf[i];
+    std::cout << "  t" << r.thread << " " << std::setw(12) << std::left << trace::stage_name(r.stage)
+              << std::right << " id=" << r.id << " tsc=" << r.tsc;
+    if (r.stage == trace::Stage::Publish || r.stage == trace::Stage::Poll)
+      std::cout << " bus=" << std::hex << r.tag << std::dec << " seq=" << r.aux;
+    std::cout << "\n";
+  }
+
+  const StageBreakdown b(tf);
+  std::cout << "[stages] " << b;
+  return 0;
+}
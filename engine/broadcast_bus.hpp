@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "spsc/broadcast_ring.hpp"
+#include "events.hpp"
+
+// EventBus counterpart with many consumers (journal, market data, risk,
+// drop-copy, ...): the matching thread publishes each Event once and every
+// subscriber reads it in place. See BroadcastRing for gating and ordering.
+// The producer side matches EventBus, so BasicMatchEngine<BroadcastBus> works.
+class BroadcastBus {
+public:
+  using ConsumerId = BroadcastRing<Event>::ConsumerId;
+
+  explicit BroadcastBus(std::size_t cap = (1u << 16)) : ring_(cap) {}
+
+  // ----- Setup (before the first publish) -----
+  // A subscriber sees an event only after every subscriber in `after` has.
+  ConsumerId subscribe(std::initializer_list<ConsumerId> after = {}) { return ring_.add_consumer(after); }
+
+  // ----- Producer-side -----
+  // Stamps Event::seq. Returns false (and counts a drop) while the slowest
+  // subscriber is a full ring behind.
+  bool try_publish(const Event& e) {
+    Event* slot = ring_.try_claim();
+    if (!slot) [[unlikely]] { ++dropped_; return false; }
+    *slot = e;
+    slot->seq = ring_.published() + 1;
+    ring_.commit();
+    return true;
+  }
+
+  std::uint64_t published() const { return ring_.published(); }
+  std::uint64_t dropped() const { return dropped_; }
+
+  // ----- Consumer-side (one thread per subscriber) -----
+  // f(const Event&) for up to max_n pending events; returns the count.
+  template<typename F>
+  std::size_t poll(ConsumerId id, std::size_t max_n, F&& f) { return ring_.poll(id, max_n, f); }
+
+  std::uint64_t lag(ConsumerId id) const { return ring_.lag(id); }
+  std::size_t capacity() const { return ring_.capacity(); }
+
+private:
+  BroadcastRing<Event> ring_;
+  std::uint64_t dropped_{0};   // producer only
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include "events.hpp"
+#include "lob/book.hpp"
+
+// ---- Inbound order commands (what gateways/routers hand to an engine) ----
+enum class CmdType : std::uint8_t { Add, Market, Cancel, Replace };
+
+// One fixed-size POD per command so it can sit in SpscRings and journals.
+// Fields a command type doesn't use are ignored (e.g. px for Market).
+struct Command {
+  CmdType  type{CmdType::Add};
+  Side     side{Side::Bid};
+  lob::Book::TimeInForce tif{lob::Book::TimeInForce::Day};
+  SymbolId symbol{0};
+  std::uint64_t trader{0};
+  OrderId  id{0};
+  Price    px{0};
+  Qty      qty{0};
+};
+
+inline Command make_add(SymbolId sym, std::uint64_t trader, OrderId id, Side side, Price px, Qty qty,
+                        lob::Book::TimeInForce tif = lob::Book::TimeInForce::Day) {
+  return Command{CmdType::Add, side, tif, sym, trader, id, px, qty};
+}
+inline Command make_market(SymbolId sym, std::uint64_t trader, OrderId id, Side side, Qty qty,
+                           lob::Book::TimeInForce tif = lob::Book::TimeInForce::IOC) {
+  return Command{CmdType::Market, side, tif, sym, trader, id, 0, qty};
+}
+inline Command make_cancel(SymbolId sym, OrderId id) {
+  return Command{CmdType::Cancel, Side::Bid, lob::Book::TimeInForce::Day, sym, 0, id, 0, 0};
+}
+inline Command make_replace(SymbolId sym, std::uint64_t trader, OrderId id, Price px, Qty qty,
+                            lob::Book::TimeInForce tif = lob::Book::TimeInForce::Day) {
+  return Command{CmdType::Replace, Side::Bid, tif, sym, trader, id, px, qty};
+}
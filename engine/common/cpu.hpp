@@ -10,9 +10,25 @@
 
 namespace cpu {
 
+// True when the calling thread may run on cpu_index: in range, online and
+// in its affinity mask (Linux; elsewhere any index >= 0).
+inline bool usable(int cpu_index) {
+#if defined(__linux__)
+    if (cpu_index < 0 || cpu_index >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return false;
+    return CPU_ISSET(cpu_index, &set);
+#else
+    return cpu_index >= 0;
+#endif
+}
+
 // Pin current thread to a specific CPU core (Linux). Throws on failure.
 inline void pin_this_thread(int cpu_index) {
 #if defined(__linux__)
+    if (cpu_index < 0 || cpu_index >= CPU_SETSIZE)
+      throw std::invalid_argument("pin_this_thread: cpu " + std::to_string(cpu_index) + " out of range");
     cpu_set_t set;
     CPU_ZERO(&set);
     CPU_SET(cpu_index, &set);
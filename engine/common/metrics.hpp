@@ -2,7 +2,12 @@
 #pragma once
 #include <atomic>
 #include <cstdint>
+#include <cstddef>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <ostream>
 
 struct SpscStats {
   std::atomic<uint64_t> push_ok{0}; // number of pushes
@@ -10,6 +15,7 @@ struct SpscStats {
   std::atomic<uint64_t> drops_total{0}; // number of drops
   std::atomic<uint64_t> depth_gauge{0}; // current queue depth
   std::atomic<uint64_t> max_depth{0}; // max depth
+  std::atomic<uint64_t> parks{0}; // Hybrid waits that reached the futex park stage
 
   inline void observe_depth(uint64_t d) {
     depth_gauge.store(d, std::memory_order_relaxed);
@@ -18,3 +24,148 @@ struct SpscStats {
             std::memory_order_relaxed, std::memory_order_relaxed)) {}
   }
 };
+
+// Counter or gauge with one writer thread: add()/set() are a relaxed load
+// and store (no locked RMW), and any thread may get() at the same time.
+struct SingleWriterCounter {
+  std::atomic<uint64_t> v{0};
+  void add(uint64_t n = 1) { v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+  void set(uint64_t x) { v.store(x, std::memory_order_relaxed); }
+  uint64_t get() const { return v.load(std::memory_order_relaxed); }
+};
+
+// Log-linear ("HDR") latency histogram: fixed memory (~11 KB inline, no
+// allocation), O(1) record, relative error below 2^-kSubBits (~3%).
+// Values under 2^kSubBits get a bucket each; above that, every power of two
+// is split into 2^kSubBits equal buckets. Values >= 2^kMaxBits (~18 min in
+// ns) count in the top bucket; max() stays exact.
+//
+// One thread records (the counters are single-writer relaxed atomics, so
+// a record is plain loads/stores); any thread may read or merge() from it
+// at the same time, and sees each counter at some recent value. Per-thread
+// histograms are combined with merge() on the reporting side.
+class LatencyHistogram {
+public:
+  static constexpr unsigned kSubBits = 5;
+  static constexpr unsigned kMaxBits = 40;
+  static constexpr std::size_t kSub = std::size_t(1) << kSubBits;
+  static constexpr std::size_t kBuckets = (kMaxBits - kSubBits + 1) * kSub;
+
+  struct Summary {
+    uint64_t count{0}, min{0}, p50{0}, p90{0}, p99{0}, p999{0}, max{0};
+    double mean{0};
+  };
+
+  void record(uint64_t v) { record_n(v, 1); }
+
+  void record_n(uint64_t v, uint64_t n) {
+    if (n == 0) return;
+    add(counts_[index_of(v)], n);
+    add(count_, n);
+    add(sum_, v * n);
+    if (v > max_.load(std::memory_order_relaxed)) max_.store(v, std::memory_order_relaxed);
+    if (v < min_.load(std::memory_order_relaxed)) min_.store(v, std::memory_order_relaxed);
+  }
+
+  // Add o's samples to this one. Call from this histogram's writer thread
+  // (o may still be recording).
+  void merge(const LatencyHistogram& o) {
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      const uint64_t c = o.counts_[i].load(std::memory_order_relaxed);
+      if (c) add(counts_[i], c);
+    }
+    add(count_, o.count_.load(std::memory_order_relaxed));
+    add(sum_, o.sum_.load(std::memory_order_relaxed));
+    const uint64_t mx = o.max_.load(std::memory_order_relaxed);
+    const uint64_t mn = o.min_.load(std::memory_order_relaxed);
+    if (mx > max_.load(std::memory_order_relaxed)) max_.store(mx, std::memory_order_relaxed);
+    if (mn < min_.load(std::memory_order_relaxed)) min_.store(mn, std::memory_order_relaxed);
+  }
+
+  // Writer thread only (or while nobody records).
+  void reset() {
+    for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  uint64_t min() const { return count() ? min_.load(std::memory_order_relaxed) : 0; }
+  double mean() const {
+    const uint64_t n = count();
+    return n ? double(sum_.load(std::memory_order_relaxed)) / double(n) : 0.0;
+  }
+
+  // Smallest recorded value v such that p% of samples are <= v, reported as
+  // the top of v's bucket (never above max()). p in [0, 100].
+  uint64_t percentile(double p) const {
+    const double ps[1] = {p};
+    uint64_t out[1];
+    percentiles(ps, out, 1);
+    return out[0];
+  }
+
+  Summary summary() const {
+    static constexpr double ps[4] = {50.0, 90.0, 99.0, 99.9};
+    uint64_t v[4];
+    percentiles(ps, v, 4);
+    Summary s;
+    s.count = count();
+    s.min = min();
+    s.p50 = v[0]; s.p90 = v[1]; s.p99 = v[2]; s.p999 = v[3];
+    s.max = max();
+    s.mean = mean();
+    return s;
+  }
+
+  // Bucket of v, and the largest value that lands in bucket i.
+  static std::size_t index_of(uint64_t v) {
+    if (v >= (uint64_t(1) << kMaxBits)) v = (uint64_t(1) << kMaxBits) - 1;
+    if (v < kSub) return std::size_t(v);
+    const unsigned m = unsigned(std::bit_width(v)) - 1;           // >= kSubBits
+    return std::size_t(m - kSubBits + 1) * kSub + std::size_t((v >> (m - kSubBits)) - kSub);
+  }
+  static uint64_t bucket_top(std::size_t i) {
+    if (i < kSub) return i;
+    const unsigned shift = unsigned(i / kSub) - 1;                 // m - kSubBits
+    return ((uint64_t(kSub + i % kSub) + 1) << shift) - 1;
+  }
+
+private:
+  static void add(std::atomic<uint64_t>& c, uint64_t n) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  // ps ascending; one pass over the buckets.
+  void percentiles(const double* ps, uint64_t* out, std::size_t k) const {
+    uint64_t total = 0;
+    for (const auto& c : counts_) total += c.load(std::memory_order_relaxed);
+    const uint64_t mx = max();
+    std::size_t j = 0, i = 0;
+    uint64_t seen = 0;
+    for (; j < k; ++j) {
+      const double p = std::clamp(ps[j], 0.0, 100.0);
+      uint64_t rank = uint64_t(std::ceil(p / 100.0 * double(total)));
+      if (rank == 0) rank = 1;
+      while (i < kBuckets && seen + counts_[i].load(std::memory_order_relaxed) < rank)
+        seen += counts_[i++].load(std::memory_order_relaxed);
+      out[j] = (total == 0 || i >= kBuckets - 1) ? mx : std::min(bucket_top(i), mx);   // top bucket is open-ended
+    }
+  }
+
+  std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+  std::atomic<uint64_t> min_{UINT64_MAX};
+};
+
+// "p50=.. ns p90=.. ns p99=.. ns p99.9=.. ns max=.. ns", for bench output.
+inline std::ostream& operator<<(std::ostream& os, const LatencyHistogram::Summary& s) {
+  return os << "p50=" << s.p50 << " ns p90=" << s.p90 << " ns p99=" << s.p99
+            << " ns p99.9=" << s.p999 << " ns max=" << s.max << " ns";
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace io {
+
+// RAII memory-mapped file (POSIX). Throws std::runtime_error on failure.
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+
+  MappedFile(MappedFile&& o) noexcept
+    : fd_(std::exchange(o.fd_, -1)), data_(std::exchange(o.data_, nullptr)),
+      size_(std::exchange(o.size_, 0)) {}
+  MappedFile& operator=(MappedFile&& o) noexcept {
+    if (this != &o) {
+      close();
+      fd_ = std::exchange(o.fd_, -1);
+      data_ = std::exchange(o.data_, nullptr);
+      size_ = std::exchange(o.size_, 0);
+    }
+    return *this;
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Create (or truncate) `path` at exactly `size` bytes, mapped read/write.
+  // The blocks are allocated up front, so writes never hit ENOSPC/SIGBUS.
+  static MappedFile create(const std::string& path, std::size_t size) {
+    MappedFile f;
+    f.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (f.fd_ < 0) fail("open", path);
+    if (size) {
+      if (int rc = ::posix_fallocate(f.fd_, 0, off_t(size)); rc != 0) {
+        // Filesystems without fallocate support: plain size extension.
+        if (rc != EOPNOTSUPP && rc != EINVAL) { errno = rc; fail("posix_fallocate", path); }
+        if (::ftruncate(f.fd_, off_t(size)) != 0) fail("ftruncate", path);
+      }
+    }
+    f.map(size, PROT_READ | PROT_WRITE, path);
+    return f;
+  }
+
+  // Map an existing file read-only (whole file).
+  static MappedFile open_read(const std::string& path) {
+    MappedFile f;
+    f.fd_ = ::open(path.c_str(), O_RDONLY);
+    if (f.fd_ < 0) fail("open", path);
+    struct stat st{};
+    if (::fstat(f.fd_, &st) != 0) fail("fstat", path);
+    f.map(std::size_t(st.st_size), PROT_READ, path);
+    return f;
+  }
+
+  bool is_open() const { return fd_ >= 0; }
+  std::byte* data() { return static_cast<std::byte*>(data_); }
+  const std::byte* data() const { return static_cast<const std::byte*>(data_); }
+  std::size_t size() const { return size_; }
+
+  // Flush [off, off+len) (page-aligned outward) to stable storage.
+  void sync(std::size_t off = 0, std::size_t len = std::size_t(-1)) {
+    if (!data_) return;
+    const std::size_t page = std::size_t(::sysconf(_SC_PAGESIZE));
+    if (len > size_ - off) len = size_ - off;
+    const std::size_t lo = off & ~(page - 1);
+    if (::msync(data() + lo, off + len - lo, MS_SYNC) != 0) fail("msync", "");
+  }
+
+  // fsync the file: its size and block allocation, not just mapped data.
+  void sync_metadata() {
+    if (fd_ >= 0 && ::fsync(fd_) != 0) fail("fsync", "");
+  }
+
+  // Write-touch every page so later stores into the mapping never fault.
+  void prefault_write() {
+    const std::size_t page = std::size_t(::sysconf(_SC_PAGESIZE));
+    auto* p = reinterpret_cast<volatile unsigned char*>(data_);
+    for (std::size_t off = 0; off < size_; off += page) p[off] = p[off];
+  }
+
+  // Kernel read-ahead hint for a front-to-back pass.
+  void advise_sequential() const {
+    if (!data_) return;
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+    ::madvise(data_, size_, MADV_WILLNEED);
+  }
+
+  void close() {
+    if (data_) ::munmap(data_, size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr; size_ = 0; fd_ = -1;
+  }
+
+private:
+  [[noreturn]] static void fail(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string(what) + (path.empty() ? "" : "(" + path + ")") +
+                             " failed: " + std::strerror(errno));
+  }
+
+  void map(std::size_t size, int prot, const std::string& path) {
+    size_ = size;
+    if (!size) return;                          // empty file: nothing to map
+    void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) fail("mmap", path);
+    data_ = p;
+  }
+
+  int fd_{-1};
+  void* data_{nullptr};
+  std::size_t size_{0};
+};
+
+// fsync a directory, so entries created or renamed in it survive a crash.
+inline void sync_dir(const std::string& dir) {
+  const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) throw std::runtime_error("open(" + dir + ") failed: " + std::strerror(errno));
+  const int rc = ::fsync(fd);
+  const int err = errno;
+  ::close(fd);
+  if (rc != 0) throw std::runtime_error("fsync(" + dir + ") failed: " + std::strerror(err));
+}
+
+} // namespace io
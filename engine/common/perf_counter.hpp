@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace perf {
+
+// User-space retired-instruction counter for the calling thread
+// (perf_event_open). ok() is false when the kernel/VM doesn't expose a PMU
+// or perf_event_paranoid forbids it; read() then returns 0.
+class InstrCounter {
+public:
+  InstrCounter() {
+#if defined(__linux__)
+    perf_event_attr a{};
+    a.type = PERF_TYPE_HARDWARE;
+    a.size = sizeof(a);
+    a.config = PERF_COUNT_HW_INSTRUCTIONS;
+    a.disabled = 1;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    fd_ = int(syscall(SYS_perf_event_open, &a, 0, -1, -1, 0));
+#endif
+  }
+  ~InstrCounter() {
+#if defined(__linux__)
+    if (fd_ >= 0) close(fd_);
+#endif
+  }
+  InstrCounter(const InstrCounter&) = delete;
+  InstrCounter& operator=(const InstrCounter&) = delete;
+
+  bool ok() const { return fd_ >= 0; }
+
+  void start() {
+#if defined(__linux__)
+    if (fd_ < 0) return;
+    ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+  void stop() {
+#if defined(__linux__)
+    if (fd_ >= 0) ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+  }
+  std::uint64_t read() const {
+    std::uint64_t v = 0;
+#if defined(__linux__)
+    if (fd_ >= 0 && ::read(fd_, &v, sizeof(v)) != ssize_t(sizeof(v))) v = 0;
+#endif
+    return v;
+  }
+
+private:
+  int fd_{-1};
+};
+
+} // namespace perf
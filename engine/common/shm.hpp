@@ -0,0 +1,127 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace io {
+
+// RAII shared-memory region (POSIX shm_open or Linux memfd), mapped
+// read/write and MAP_SHARED so every process that maps it sees the same
+// bytes. Throws std::runtime_error on failure.
+//
+// Named regions live under /dev/shm until unlink(); memfd regions have no
+// name and are shared by passing fd() to a child (fork/exec) or over a
+// unix socket, then calling from_fd() there.
+class SharedMemory {
+public:
+  SharedMemory() = default;
+  ~SharedMemory() { close(); }
+
+  SharedMemory(SharedMemory&& o) noexcept
+    : fd_(std::exchange(o.fd_, -1)), data_(std::exchange(o.data_, nullptr)),
+      size_(std::exchange(o.size_, 0)) {}
+  SharedMemory& operator=(SharedMemory&& o) noexcept {
+    if (this != &o) {
+      close();
+      fd_ = std::exchange(o.fd_, -1);
+      data_ = std::exchange(o.data_, nullptr);
+      size_ = std::exchange(o.size_, 0);
+    }
+    return *this;
+  }
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  // New zero-filled region `name` ("/foo") of `size` bytes. A stale region
+  // of the same name is unlinked first; processes still attached to it keep
+  // the old memory.
+  static SharedMemory create(const std::string& name, std::size_t size) {
+    ::shm_unlink(name.c_str());
+    SharedMemory m;
+    m.fd_ = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (m.fd_ < 0) fail("shm_open", name);
+    if (::ftruncate(m.fd_, off_t(size)) != 0) fail("ftruncate", name);
+    m.map(size, name);
+    return m;
+  }
+
+  // Map an existing named region (whole size).
+  static SharedMemory open(const std::string& name) {
+    SharedMemory m;
+    m.fd_ = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (m.fd_ < 0) fail("shm_open", name);
+    m.map(fd_size(m.fd_, name), name);
+    return m;
+  }
+
+  // Anonymous zero-filled region; `name` only shows up in /proc/<pid>/fd.
+  // The fd is inherited across fork/exec (no MFD_CLOEXEC).
+  static SharedMemory create_memfd(const std::string& name, std::size_t size) {
+    SharedMemory m;
+    m.fd_ = ::memfd_create(name.c_str(), 0);
+    if (m.fd_ < 0) fail("memfd_create", name);
+    if (::ftruncate(m.fd_, off_t(size)) != 0) fail("ftruncate", name);
+    m.map(size, name);
+    return m;
+  }
+
+  // Map the region behind an fd received from another process. Takes a
+  // duplicate, so the caller keeps ownership of `fd`.
+  static SharedMemory from_fd(int fd) {
+    SharedMemory m;
+    m.fd_ = ::dup(fd);
+    if (m.fd_ < 0) fail("dup", "");
+    m.map(fd_size(m.fd_, ""), "");
+    return m;
+  }
+
+  // Remove a named region; existing mappings stay valid.
+  static void unlink(const std::string& name) { ::shm_unlink(name.c_str()); }
+
+  bool is_open() const { return data_ != nullptr; }
+  int fd() const { return fd_; }
+  std::byte* data() { return static_cast<std::byte*>(data_); }
+  const std::byte* data() const { return static_cast<const std::byte*>(data_); }
+  std::size_t size() const { return size_; }
+
+  void close() {
+    if (data_) ::munmap(data_, size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr; size_ = 0; fd_ = -1;
+  }
+
+private:
+  [[noreturn]] static void fail(const char* what, const std::string& name) {
+    throw std::runtime_error(std::string(what) + (name.empty() ? "" : "(" + name + ")") +
+                             " failed: " + std::strerror(errno));
+  }
+
+  static std::size_t fd_size(int fd, const std::string& name) {
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) fail("fstat", name);
+    return std::size_t(st.st_size);
+  }
+
+  // MAP_POPULATE: fault every page in now, not on the first hot-path store.
+  void map(std::size_t size, const std::string& name) {
+    if (size == 0) { errno = EINVAL; fail("mmap", name); }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+    if (p == MAP_FAILED) fail("mmap", name);
+    data_ = p;
+    size_ = size;
+  }
+
+  int fd_{-1};
+  void* data_{nullptr};
+  std::size_t size_{0};
+};
+
+} // namespace io
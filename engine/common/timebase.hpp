@@ -1,6 +1,20 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__)
+  #include <cpuid.h>
+  #include <x86intrin.h>
+  #define TB_HAVE_TSC 1
+#else
+  #define TB_HAVE_TSC 0
+#endif
 
 namespace tb {
 
@@ -22,4 +36,238 @@ struct Stopwatch {
     }
 };
 
+// ---- TSC reads (x86; 0 elsewhere) ----
+// rdtsc:         cheapest; may be reordered with neighbouring instructions.
+// rdtscp:        waits for earlier instructions to finish (end of a region).
+// rdtsc_fenced:  lfence first, same effect as rdtscp without the aux read
+//                (start of a region, so earlier work is not counted).
+inline uint64_t rdtsc() {
+#if TB_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+inline uint64_t rdtscp() {
+#if TB_HAVE_TSC
+    unsigned aux;
+    return __rdtscp(&aux);
+#else
+    return 0;
+#endif
+}
+inline uint64_t rdtsc_fenced() {
+#if TB_HAVE_TSC
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// True when the TSC ticks at a constant rate in every P/C-state (CPUID
+// 0x80000007 EDX bit 8) and, on Linux, the kernel still lists "tsc" as an
+// available clocksource (it drops it when it finds the TSC unsynchronised
+// across cores or unstable).
+inline bool tsc_invariant() {
+#if TB_HAVE_TSC
+    unsigned a, b, c, d;
+    if (!__get_cpuid(0x80000000u, &a, &b, &c, &d) || a < 0x80000007u) return false;
+    __get_cpuid(0x80000007u, &a, &b, &c, &d);
+    if (!(d & (1u << 8))) return false;
+  #if defined(__linux__)
+    std::ifstream f("/sys/devices/system/clocksource/clocksource0/available_clocksource");
+    std::string list;
+    if (f && std::getline(f, list)) return list.find("tsc") != std::string::npos;
+  #endif
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Nanosecond clock from the invariant TSC: ~rdtsc cost instead of a vDSO
+// clock_gettime. Readings are on the steady_clock (now_ns) scale.
+//
+// Conversion: ns = base_ns + ((tsc - base_tsc) * mult) >> 32. The
+// constructor calibrates mult against steady_clock over calib_ns.
+// recalibrate() re-anchors at the current reading (no jump), refits mult
+// over the whole time since construction (absorbing drift and NTP slew of
+// CLOCK_MONOTONIC) and steers out the remaining offset over the next
+// period, at most 1000 ppm so the clock never runs backwards. Readers take
+// a seqlock-consistent snapshot of the parameters, so recalibration never
+// blocks them.
+//
+// Without a usable invariant TSC (or with use_tsc = false) every call falls
+// back to steady_clock and uses_tsc() is false.
+class TscClock {
+public:
+    explicit TscClock(bool use_tsc = tsc_invariant(), uint64_t calib_ns = 10'000'000)
+      : use_tsc_(use_tsc && TB_HAVE_TSC) {
+        if (!use_tsc_) return;
+        first_ = sample();
+        const uint64_t until = first_.ns + calib_ns;
+        while (tb::now_ns() < until) std::this_thread::yield();
+        const Anchor a = sample();
+        if (a.tsc <= first_.tsc) { use_tsc_ = false; return; }
+        last_ = first_;
+        store(Params{first_.tsc, first_.ns, slope(first_, a)});
+    }
+
+    TscClock(const TscClock&) = delete;
+    TscClock& operator=(const TscClock&) = delete;
+
+    bool uses_tsc() const { return use_tsc_; }
+
+    uint64_t now_ns() const {
+        if (!use_tsc_) return tb::now_ns();
+        for (;;) {
+            const uint32_t s0 = seq_.load(std::memory_order_acquire);
+            const Params p = params();
+            const uint64_t tsc = rdtsc();
+            if ((s0 & 1) || seq_.load(std::memory_order_relaxed) != s0) continue;
+            return p.at(tsc);
+        }
+    }
+
+    // Raw ticks for interval timing: TSC ticks, or steady ns in fallback.
+    uint64_t ticks() const { return use_tsc_ ? rdtsc() : tb::now_ns(); }
+    // A ticks() difference in ns.
+    uint64_t ticks_to_ns(uint64_t dt) const {
+        if (!use_tsc_) return dt;
+        return mul_shift(dt, mult_.load(std::memory_order_relaxed));
+    }
+
+    // TSC frequency as currently calibrated (0 in fallback).
+    double ghz() const {
+        if (!use_tsc_) return 0.0;
+        return double(uint64_t(1) << kShift) / double(mult_.load(std::memory_order_relaxed));
+    }
+
+    // Re-anchor and refit; one caller at a time (e.g. TscRecalibrator).
+    void recalibrate() {
+        if (!use_tsc_) return;
+        const Anchor a = sample();
+        if (a.tsc <= last_.tsc) return;
+        const uint64_t m = slope(first_, a);
+        // The new line starts where the old one is at the moment of the
+        // switch, read inside the write section: a reader that got old
+        // parameters read its TSC before that point.
+        const Params old = params();
+        const uint32_t s = seq_.fetch_add(1, std::memory_order_acq_rel);
+        const uint64_t t = rdtsc();
+        const uint64_t cur = old.at(t);
+        // Remove the offset from steady_clock over another interval as long as this one.
+        const i128 err = i128(int64_t(cur - (a.ns + mul_shift(t - a.tsc, m))));
+        i128 corr = (err << kShift) / i128(a.tsc - last_.tsc);
+        const i128 lim = i128(m / 1000);
+        corr = corr > lim ? lim : corr < -lim ? -lim : corr;
+        last_ = a;
+        store(Params{t, cur, uint64_t(i128(m) - corr)});
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+    // Offset of this clock from steady_clock right now (diagnostics).
+    int64_t error_ns() const {
+        const Anchor a = sample();
+        if (!use_tsc_) return 0;
+        for (;;) {
+            const uint32_t s0 = seq_.load(std::memory_order_acquire);
+            const Params p = params();
+            if ((s0 & 1) || seq_.load(std::memory_order_relaxed) != s0) continue;
+            return int64_t(p.at(a.tsc) - a.ns);
+        }
+    }
+
+private:
+    static constexpr unsigned kShift = 32;
+    struct Anchor { uint64_t tsc, ns; };
+
+    __extension__ typedef unsigned __int128 u128;
+    __extension__ typedef __int128 i128;
+    static uint64_t mul_shift(uint64_t dt, uint64_t mult) {
+        return uint64_t((u128(dt) * mult) >> kShift);
+    }
+
+    // A (tsc, steady ns) pair: the narrowest of a few bracketed reads.
+    static Anchor sample() {
+        Anchor best{0, 0};
+        uint64_t best_w = UINT64_MAX;
+        for (int i = 0; i < 5; ++i) {
+            const uint64_t t0 = rdtsc_fenced();
+            const uint64_t ns = tb::now_ns();
+            const uint64_t t1 = rdtscp();
+            if (t1 - t0 < best_w) { best_w = t1 - t0; best = Anchor{t0 + (t1 - t0) / 2, ns}; }
+        }
+        return best;
+    }
+
+    static uint64_t slope(const Anchor& a, const Anchor& b) {
+        return uint64_t((u128(b.ns - a.ns) << kShift) / (b.tsc - a.tsc));
+    }
+
+    // ns = base_ns + (tsc - base_tsc) * mult >> kShift
+    struct Params {
+        uint64_t base_tsc, base_ns, mult;
+        uint64_t at(uint64_t tsc) const {
+            // A TSC read just before a re-anchor can precede base_tsc.
+            return tsc >= base_tsc ? base_ns + mul_shift(tsc - base_tsc, mult)
+                                   : base_ns - mul_shift(base_tsc - tsc, mult);
+        }
+    };
+
+    // Seqlock-protected; check seq_ around the call.
+    Params params() const {
+        return Params{base_tsc_.load(std::memory_order_acquire),
+                      base_ns_.load(std::memory_order_acquire),
+                      mult_.load(std::memory_order_acquire)};
+    }
+    void store(const Params& p) {
+        base_tsc_.store(p.base_tsc, std::memory_order_release);
+        base_ns_.store(p.base_ns, std::memory_order_release);
+        mult_.store(p.mult, std::memory_order_release);
+    }
+
+    bool use_tsc_;
+    Anchor first_{0, 0};                        // writer only: calibration start
+    Anchor last_{0, 0};                         // writer only: last (re)calibration
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> base_tsc_{0};
+    std::atomic<uint64_t> base_ns_{0};
+    std::atomic<uint64_t> mult_{uint64_t(1) << kShift};
+};
+
+// Process-wide TscClock, calibrated on first use (~10 ms).
+inline TscClock& tsc_clock() {
+    static TscClock clock;
+    return clock;
+}
+
+// now_ns() on the TSC where it is usable.
+inline uint64_t fast_now_ns() { return tsc_clock().now_ns(); }
+
+// Background thread calling clock.recalibrate() every `period`.
+class TscRecalibrator {
+public:
+    explicit TscRecalibrator(TscClock& clock = tsc_clock(),
+                             std::chrono::milliseconds period = std::chrono::seconds(1))
+      : thr_([this, &clock, period] {
+            std::unique_lock<std::mutex> lk(mu_);
+            while (!cv_.wait_for(lk, period, [this] { return stop_; })) clock.recalibrate();
+        }) {}
+    ~TscRecalibrator() {
+        { std::lock_guard<std::mutex> lk(mu_); stop_ = true; }
+        cv_.notify_one();
+        thr_.join();
+    }
+    TscRecalibrator(const TscRecalibrator&) = delete;
+    TscRecalibrator& operator=(const TscRecalibrator&) = delete;
+
+private:
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_{false};
+    std::thread thr_;   // last: starts after the members above exist
+};
+
 } // namespace tb
\ No newline at end of file
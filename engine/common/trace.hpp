@@ -0,0 +1,286 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "mmap_file.hpp"
+#include "timebase.hpp"
+#include "../spsc/spsc_ring.hpp"
+
+// ---- Hot-path trace points ----
+//
+// Each command gets a trace id at ingress. Stamps of (stage, id, TSC) are
+// taken as the command moves through the engine:
+//
+//   Ingress      command accepted (ShardedEngine::submit, or engine entry
+//                for direct calls)
+//   SubmitBegin  just before the Book call (submit/replace/cancel)
+//   SubmitEnd    just after it returns
+//   Publish      an event of the command is on the EventBus (aux = Event::seq)
+//   Poll         a consumer took that event off the bus (aux = Event::seq)
+//
+// Publish and Poll are joined on (bus tag, seq), because events do not carry
+// the command's id. Each bus takes a tag from a process-wide counter, so both
+// ends have to be in one process.
+//
+// Each thread writes its stamps to its own SpscRing. The first stamp on a
+// thread registers that ring. A full ring drops the stamp and counts it,
+// and the hot path never waits. A TraceWriter thread drains every ring into
+// a binary file. Run bench/trace_report on that file for per-stage latency.
+//
+// The points cost nothing unless LOB_TRACE is defined (cmake
+// -DENABLE_TRACE=ON, or per target). Call sites wrap them in LOB_TRACE_ONLY(...),
+// which drops its arguments unevaluated when tracing is off.
+#ifdef LOB_TRACE
+#define LOB_TRACE_ONLY(...) do { __VA_ARGS__; } while (0)
+#else
+#define LOB_TRACE_ONLY(...) do { } while (0)
+#endif
+
+namespace trace {
+
+#ifdef LOB_TRACE
+inline constexpr bool kEnabled = true;
+#else
+inline constexpr bool kEnabled = false;
+#endif
+
+enum class Stage : std::uint8_t { Ingress, SubmitBegin, SubmitEnd, Publish, Poll };
+inline constexpr std::size_t kStages = 5;
+
+inline const char* stage_name(Stage s) {
+  static constexpr const char* names[kStages] = {"ingress", "submit_begin", "submit_end", "publish", "poll"};
+  return names[std::size_t(s)];
+}
+
+struct Record {
+  std::uint64_t tsc;       // tb::tsc_clock().ticks()
+  std::uint64_t id;        // command trace id (0 for Poll)
+  std::uint64_t aux;       // Publish/Poll: Event::seq
+  std::uint32_t tag;       // Publish/Poll: bus tag
+  std::uint16_t thread;    // registration order of the writing thread
+  Stage         stage;
+  std::uint8_t  pad{0};
+};
+static_assert(sizeof(Record) == 32 && std::is_trivially_copyable_v<Record>);
+
+// A value and the trace id it travels with; just the value when tracing is
+// compiled out, so rings of Traced<T> stay as dense as rings of T.
+template<class T, bool = kEnabled>
+struct Traced {
+  T value;
+  std::uint64_t id{0};
+  Traced() = default;
+  Traced(const T& v, std::uint64_t trace_id) : value(v), id(trace_id) {}
+};
+template<class T>
+struct Traced<T, false> {
+  T value;
+  static constexpr std::uint64_t id = 0;
+  Traced() = default;
+  Traced(const T& v, std::uint64_t) : value(v) {}
+};
+
+// ----- Per-thread rings -----
+inline constexpr std::size_t kRingCapacity = 1u << 16;   // records per thread
+
+struct ThreadLog {
+  explicit ThreadLog(std::uint16_t idx) : index(idx), ring(kRingCapacity) {}
+  const std::uint16_t index;
+  SpscRing<Record> ring;                        // this thread -> TraceWriter
+  std::atomic<std::uint64_t> dropped{0};        // stamps lost to a full ring
+};
+
+// Every ThreadLog ever registered. They live as long as the process, so a
+// ring outlives its thread until the writer has drained it.
+class Registry {
+public:
+  ThreadLog& add() {
+    std::lock_guard<std::mutex> lk(mu_);
+    logs_.push_back(std::make_unique<ThreadLog>(std::uint16_t(logs_.size())));
+    return *logs_.back();
+  }
+  template<typename F>
+  void for_each(F&& f) {
+    std::lock_guard<std::mutex> lk(mu_);
+    for (auto& l : logs_) f(*l);
+  }
+  std::uint64_t dropped() {
+    std::uint64_t n = 0;
+    for_each([&](ThreadLog& l) { n += l.dropped.load(std::memory_order_relaxed); });
+    return n;
+  }
+
+private:
+  std::mutex mu_;
+  std::vector<std::unique_ptr<ThreadLog>> logs_;
+};
+
+inline Registry& registry() {
+  static Registry r;
+  return r;
+}
+
+inline ThreadLog& thread_log() {
+  thread_local ThreadLog& log = registry().add();
+  return log;
+}
+
+// ----- Stamping -----
+inline std::uint64_t next_id() {
+  static std::atomic<std::uint64_t> next{0};
+  return next.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Names one bus in Publish/Poll stamps. Holds no bytes when tracing is
+// compiled out (use as a [[no_unique_address]] member).
+template<bool = kEnabled>
+struct BusTag {
+  std::uint32_t value = [] {
+    static std::atomic<std::uint32_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed) + 1;
+  }();
+};
+template<>
+struct BusTag<false> {};
+
+inline void point(Stage stage, std::uint64_t id, std::uint64_t aux = 0, std::uint32_t tag = 0) {
+  ThreadLog& log = thread_log();
+  const Record r{tb::tsc_clock().ticks(), id, aux, tag, log.index, stage};
+  if (!log.ring.try_push(r)) [[unlikely]] log.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The command this thread is processing (0: none).
+inline std::uint64_t& current_id() {
+  thread_local std::uint64_t id = 0;
+  return id;
+}
+
+// Engine entry. A command that arrived without an id (direct engine call)
+// gets one here, and its ingress is now.
+inline void begin_command() {
+  std::uint64_t& id = current_id();
+  if (id) return;
+  id = next_id();
+  point(Stage::Ingress, id);
+}
+inline void end_command() { current_id() = 0; }
+
+inline void stamp(Stage stage) { point(stage, current_id()); }
+inline void published(BusTag<true> bus, std::uint64_t seq) { point(Stage::Publish, current_id(), seq, bus.value); }
+inline void polled(BusTag<true> bus, std::uint64_t seq) { point(Stage::Poll, 0, seq, bus.value); }
+
+// ----- Trace files -----
+// File: TraceFileHeader, then `count` Records, grouped by drain pass (not in
+// time order).
+inline constexpr char kTraceMagic[8] = {'L', 'O', 'B', 'T', 'R', 'C', '\0', '\0'};
+
+struct TraceFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_bytes;
+  double ns_per_tick;           // Record::tsc units -> ns
+  std::uint64_t count;
+};
+static_assert(sizeof(TraceFileHeader) == 32);
+
+// Background thread that drains every thread's ring into `path` each
+// `period`, and once more on stop().
+class TraceWriter {
+public:
+  explicit TraceWriter(const std::string& path,
+                       std::chrono::milliseconds period = std::chrono::milliseconds(1))
+    : f_(std::fopen(path.c_str(), "wb")) {
+    if (!f_) throw std::runtime_error("trace: cannot create " + path);
+    std::setvbuf(f_, nullptr, _IOFBF, 1 << 20);
+    write_header();
+    thr_ = std::thread([this, period] {
+      std::unique_lock<std::mutex> lk(mu_);
+      while (!cv_.wait_for(lk, period, [this] { return stop_; })) drain();
+    });
+  }
+  ~TraceWriter() { stop(); }
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  // Stop the thread, write what is left and patch the record count in.
+  void stop() {
+    if (!f_) return;
+    { std::lock_guard<std::mutex> lk(mu_); stop_ = true; }
+    cv_.notify_one();
+    thr_.join();
+    drain();
+    std::fseek(f_, 0, SEEK_SET);
+    write_header();
+    std::fclose(f_);
+    f_ = nullptr;
+  }
+
+  std::uint64_t written() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+  void drain() {
+    registry().for_each([&](ThreadLog& l) {
+      const std::size_t n = l.ring.try_pop_bulk(SIZE_MAX, [&](Record&& r) {
+        if (std::fwrite(&r, sizeof r, 1, f_) != 1) throw std::runtime_error("trace: write failed");
+      });
+      count_.fetch_add(n, std::memory_order_relaxed);
+    });
+  }
+
+  void write_header() {
+    TraceFileHeader h{};
+    std::memcpy(h.magic, kTraceMagic, sizeof h.magic);
+    h.version = 1;
+    h.record_bytes = sizeof(Record);
+    h.ns_per_tick = double(tb::tsc_clock().ticks_to_ns(std::uint64_t(1) << 32)) / double(std::uint64_t(1) << 32);
+    h.count = count_.load(std::memory_order_relaxed);
+    if (std::fwrite(&h, sizeof h, 1, f_) != 1) throw std::runtime_error("trace: write failed");
+  }
+
+  std::FILE* f_;
+  std::atomic<std::uint64_t> count_{0};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::thread thr_;
+};
+
+// Read-only view of a trace file, mapped in place.
+class TraceFile {
+public:
+  explicit TraceFile(const std::string& path) : file_(io::MappedFile::open_read(path)) {
+    TraceFileHeader h{};
+    if (file_.size() < sizeof h) throw std::runtime_error("trace: truncated " + path);
+    std::memcpy(&h, file_.data(), sizeof h);
+    if (std::memcmp(h.magic, kTraceMagic, sizeof h.magic) != 0 || h.record_bytes != sizeof(Record))
+      throw std::runtime_error("trace: bad header in " + path);
+    if (h.count > (file_.size() - sizeof h) / sizeof(Record))
+      throw std::runtime_error("trace: truncated " + path);
+    count_ = std::size_t(h.count);
+    ns_per_tick_ = h.ns_per_tick;
+    file_.advise_sequential();
+  }
+
+  std::size_t size() const { return count_; }
+  double ns_per_tick() const { return ns_per_tick_; }
+  const Record& operator[](std::size_t i) const {
+    return reinterpret_cast<const Record*>(file_.data() + sizeof(TraceFileHeader))[i];
+  }
+
+private:
+  io::MappedFile file_;
+  std::size_t count_{0};
+  double ns_per_tick_{1.0};
+};
+
+} // namespace trace
@@ -0,0 +1,141 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "event_bus.hpp"
+#include "events.hpp"
+#include "common/timebase.hpp"
+
+// Conflating market-data stage between the matching thread and slow consumers.
+//
+//   MatchEngine -> EventBus -> Conflator::pump(sink) -> sink(const Event&)
+//
+// Fills and cancels go to the sink immediately, in bus order, and are never
+// merged. BookChangeEvents are held per (symbol, side, px); a later change to
+// the same level overwrites the held one, keeping its first-seen position.
+// Held levels are emitted at each flush:
+//   - window_ns == 0: at the end of every pump() (per-batch conflation);
+//   - otherwise once window_ns has passed since the first held change;
+//   - always when max_levels distinct levels are held.
+// At a flush, every level the consumer has been told about matches the book
+// as of the last event pumped. In between, trades can run ahead of the levels.
+// Single-threaded: call pump()/flush() from the one consumer thread of `in`.
+class Conflator {
+public:
+  struct Config {
+    std::size_t max_batch{256};      // events taken from the bus per pump()
+    std::uint64_t window_ns{0};      // 0: flush after every batch
+    std::size_t max_levels{4096};    // distinct held levels that force a flush
+  };
+
+  struct Stats {
+    std::uint64_t events_in{0};
+    std::uint64_t passed{0};         // fills + cancels forwarded unchanged
+    std::uint64_t book_in{0};        // BookChangeEvents read
+    std::uint64_t book_out{0};       // BookChangeEvents emitted
+    std::uint64_t flushes{0};
+    std::uint64_t held{0};           // levels waiting for the next flush
+    // Level updates absorbed by a later update to the same level.
+    std::uint64_t conflated() const { return book_in - book_out - held; }
+  };
+
+  Conflator(EventBus& in, Config cfg) : in_(in), cfg_(cfg) {
+    if (cfg_.max_batch == 0) cfg_.max_batch = 1;
+    if (cfg_.max_levels == 0) cfg_.max_levels = 1;
+    slots_.resize(std::bit_ceil(cfg_.max_levels * 2));
+    mask_ = slots_.size() - 1;
+    held_.reserve(cfg_.max_levels);
+  }
+  explicit Conflator(EventBus& in) : Conflator(in, Config{}) {}
+
+  // Drain up to max_batch events into sink(const Event&), flushing held
+  // levels when the window says so. Returns the number of events read.
+  template<typename Sink>
+  std::size_t pump(Sink&& sink) {
+    const std::size_t n = in_.poll_bulk(cfg_.max_batch, [&](Event&& ev){
+      ++stats_.events_in;
+      if (ev.is<BookChangeEvent>()) hold(ev, sink);
+      else { ++stats_.passed; sink(std::as_const(ev)); }
+    });
+    if (!held_.empty() && (cfg_.window_ns == 0 || tb::now_ns() - first_held_ns_ >= cfg_.window_ns))
+      flush(sink);
+    return n;
+  }
+
+  // Emit every held level now (e.g. before the consumer goes idle).
+  template<typename Sink>
+  void flush(Sink&& sink) {
+    if (held_.empty()) return;
+    for (const Event& ev : held_) sink(ev);
+    stats_.book_out += held_.size();
+    ++stats_.flushes;
+    held_.clear();
+    if (++gen_ == 0) {               // stamp wrapped: really clear the table
+      for (Slot& s : slots_) s.gen = 0;
+      gen_ = 1;
+    }
+  }
+
+  Stats stats() const {
+    Stats s = stats_;
+    s.held = held_.size();
+    return s;
+  }
+  const Config& config() const { return cfg_; }
+
+private:
+  // Open-addressing index over held_, cleared in O(1) by bumping gen_.
+  struct Slot {
+    Price px{0};
+    SymbolId symbol{0};
+    Side side{Side::Bid};
+    std::uint32_t gen{0};            // live when == gen_
+    std::uint32_t idx{0};            // position in held_
+  };
+
+  static std::size_t hash(SymbolId sym, Side side, Price px) {
+    std::uint64_t h = std::uint64_t(px) * 0x9e3779b97f4a7c15ull;
+    h ^= (std::uint64_t(sym) << 1 | std::uint64_t(side == Side::Ask)) * 0xc2b2ae3d27d4eb4full;
+    return std::size_t(h ^ (h >> 32));
+  }
+
+  template<typename Sink>
+  void hold(const Event& ev, Sink& sink) {
+    const BookChangeEvent& c = ev.get<BookChangeEvent>();
+    ++stats_.book_in;
+    for (std::size_t i = hash(c.symbol, c.side, c.px) & mask_;; i = (i + 1) & mask_) {
+      Slot& s = slots_[i];
+      if (s.gen != gen_) {
+        if (held_.size() == cfg_.max_levels) {    // table full: make room
+          flush(sink);
+          hold_new(ev, slots_[hash(c.symbol, c.side, c.px) & mask_]);
+        } else {
+          hold_new(ev, s);
+        }
+        return;
+      }
+      if (s.px == c.px && s.symbol == c.symbol && s.side == c.side) {
+        held_[s.idx] = ev;                        // latest state (and its seq/ts) wins
+        return;
+      }
+    }
+  }
+
+  void hold_new(const Event& ev, Slot& s) {
+    const BookChangeEvent& c = ev.get<BookChangeEvent>();
+    if (held_.empty()) first_held_ns_ = cfg_.window_ns ? tb::now_ns() : 0;
+    s = Slot{c.px, c.symbol, c.side, gen_, std::uint32_t(held_.size())};
+    held_.push_back(ev);
+  }
+
+  EventBus& in_;
+  Config cfg_;
+  std::vector<Slot> slots_;
+  std::size_t mask_{0};
+  std::uint32_t gen_{1};
+  std::vector<Event> held_;                  // BookChangeEvents, first-seen order
+  std::uint64_t first_held_ns_{0};
+  Stats stats_{};
+};
@@ -1,44 +1,107 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
+#include <new>
 #include <optional>
-#include <variant>
 #include <utility>
-#include <atomic>
 
 #include "spsc/spsc_ring.hpp"
+#include "common/trace.hpp"
 #include "events.hpp"
 
-// Event payloads are defined in events.hpp
-using Event = std::variant<FillEvent, CancelEvent, BookChangeEvent>;
-
-// Single-producer / single-consumer bus built on SpscRing<Event>.
-class EventBus {
+// Single-producer / single-consumer bus of Events over an SPSC ring.
+// Event (events.hpp) is a 64-byte POD; the bus stamps Event::seq on publish.
+// Events are written straight into their ring slot, and peek()/poll_bulk()
+// read them there.
+// Ring: SpscRing<Event> (EventBus, in-process) or any ring with its
+// claim/commit and peek/release API, e.g. ShmSpscRing<Event> (shm_event_bus.hpp).
+// With LOB_TRACE, publishes and consumer takes are trace points (common/trace.hpp).
+template<class Ring>
+class BasicEventBus {
 public:
-  explicit EventBus(std::size_t cap = (1u << 20)) : ring_(cap) {}
+  explicit BasicEventBus(std::size_t cap = (1u << 20)) : ring_(cap) {}
+  // Wrap a ring built elsewhere (e.g. created in or attached to shared memory).
+  explicit BasicEventBus(Ring&& ring) : ring_(std::move(ring)) {}
 
   // ----- Producer-side -----
-  // Push by copy
-  bool try_publish(const Event& e) { return ring_.try_push(e); }
-
-  // Push by move
-  bool try_publish(Event&& e) { return ring_.try_push(std::move(e)); }
+  // Returns false (and consumes no seq) when the ring is full.
+  bool try_publish(const Event& e) {
+    Event* slot = ring_.try_claim();
+    if (!slot) { ++dropped_; return false; }
+    Event stamped = e;              // stamp first: the slot gets one full-line write
+    stamped.seq = ++published_;
+    new (slot) Event(stamped);
+    ring_.commit();
+    LOB_TRACE_ONLY(trace::published(tag_, published_));
+    return true;
+  }
 
-  // Construct the variant in place to avoid a temporary.
+  // Build payload T from its fields directly in the slot and publish it.
   template <class T, class... Args>
   bool publish_in_place(Args&&... args) {
-    Event ev{std::in_place_type<T>, std::forward<Args>(args)...};
-    return ring_.try_push(std::move(ev));
+    Event* slot = ring_.try_claim();
+    if (!slot) { ++dropped_; return false; }
+    new (slot) Event(T{std::forward<Args>(args)...});
+    slot->seq = ++published_;
+    ring_.commit();
+    LOB_TRACE_ONLY(trace::published(tag_, published_));
+    return true;
   }
 
+  // Events published so far (== seq of the last one).
+  std::uint64_t published() const { return published_; }
+  // Publishes refused because the ring was full.
+  std::uint64_t dropped() const { return dropped_; }
+
   // ----- Consumer-side -----
   std::optional<Event> try_poll() {
     Event e;
-    if (ring_.try_pop(e)) return e;
+    if (try_poll(e)) return e;
     return std::nullopt;
   }
 
+  // Copy-out form without the optional wrapper.
+  bool try_poll(Event& out) {
+    if (!ring_.try_pop(out)) return false;
+    LOB_TRACE_ONLY(trace::polled(tag_, out.seq));
+    return true;
+  }
+
+  // Zero-copy: the front event in its slot (nullptr if empty), valid until
+  // release() hands the slot back to the producer.
+  const Event* peek() {
+    const Event* e = ring_.peek();
+    LOB_TRACE_ONLY(if (e) trace::polled(tag_, e->seq));
+    return e;
+  }
+  void release() { ring_.release(); }
+
+  // Hand up to max_n events to f(Event&&) in place, releasing each
+  // contiguous run with one store. Returns the count.
+  template<typename F>
+  std::size_t poll_bulk(std::size_t max_n, F&& f) {
+    std::size_t done = 0;
+    while (done < max_n) {
+      Event* first = nullptr;
+      const std::size_t n = ring_.peek_n(max_n - done, &first);
+      if (n == 0) break;
+      for (std::size_t i = 0; i < n; ++i) {
+        LOB_TRACE_ONLY(trace::polled(tag_, first[i].seq));
+        f(std::move(first[i]));
+      }
+      ring_.release(n);
+      done += n;
+    }
+    return done;
+  }
+
   std::size_t capacity() const { return ring_.capacity(); }
 
 private:
-  SpscRing<Event> ring_;
+  [[no_unique_address]] trace::BusTag<> tag_;   // names this bus in trace stamps (read-only)
+  Ring ring_;
+  alignas(CACHELINE_SIZE) std::uint64_t published_{0};   // producer only
+  std::uint64_t dropped_{0};                             // producer only
 };
+
+using EventBus = BasicEventBus<SpscRing<Event>>;
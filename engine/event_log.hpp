@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "event_bus.hpp"
+#include "events.hpp"
+#include "common/mmap_file.hpp"
+
+// ---- Recorded event streams (reference output for journal replay) ----
+//
+// File: EventLogHeader, then `count` fixed 40-byte EventRecords in bus order.
+
+enum class EventKind : std::uint8_t { Fill, Cancel, BookChange };
+
+struct EventRecord {
+  EventKind kind;
+  Side      side;
+  std::uint16_t pad{0};
+  SymbolId  symbol;
+  OrderId   a;        // Fill: taker id, Cancel: id, BookChange: 0
+  OrderId   b;        // Fill: maker id, otherwise 0
+  Price     px;
+  Qty       qty;      // Fill: qty, Cancel: qty_canceled, BookChange: level_qty
+
+  friend bool operator==(const EventRecord&, const EventRecord&) = default;
+};
+static_assert(sizeof(EventRecord) == 40 && std::is_trivially_copyable_v<EventRecord>);
+
+inline EventRecord to_record(const Event& ev) {
+  struct V {
+    EventRecord operator()(const FillEvent& e) const {
+      return {EventKind::Fill, e.side, 0, e.symbol, e.taker_id, e.maker_id, e.px, e.qty};
+    }
+    EventRecord operator()(const CancelEvent& e) const {
+      return {EventKind::Cancel, e.side, 0, e.symbol, e.id, 0, e.px, e.qty_canceled};
+    }
+    EventRecord operator()(const BookChangeEvent& e) const {
+      return {EventKind::BookChange, e.side, 0, e.symbol, 0, 0, e.px, e.level_qty};
+    }
+  };
+  return ev.visit(V{});
+}
+
+inline std::string to_string(const EventRecord& r) {
+  static constexpr const char* kinds[] = {"Fill", "Cancel", "BookChange"};
+  return std::string(kinds[std::size_t(r.kind)]) + "{sym=" + std::to_string(r.symbol) + " " +
+         side_str(r.side) + " a=" + std::to_string(r.a) + " b=" + std::to_string(r.b) +
+         " px=" + std::to_string(r.px) + " qty=" + std::to_string(r.qty) + "}";
+}
+
+inline constexpr char kEventLogMagic[8] = {'L', 'O', 'B', 'E', 'V', 'T', '\0', '\0'};
+
+struct EventLogHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_bytes;
+  std::uint64_t count;
+};
+static_assert(sizeof(EventLogHeader) == 24);
+
+// Buffered append-only writer (capture side, not the matching thread).
+class EventLogWriter {
+public:
+  explicit EventLogWriter(const std::string& path) : f_(std::fopen(path.c_str(), "wb")) {
+    if (!f_) throw std::runtime_error("event log: cannot create " + path);
+    std::setvbuf(f_, nullptr, _IOFBF, 1 << 20);
+    write_header();
+  }
+  ~EventLogWriter() { close(); }
+  EventLogWriter(const EventLogWriter&) = delete;
+  EventLogWriter& operator=(const EventLogWriter&) = delete;
+
+  void append(const EventRecord& r) {
+    if (std::fwrite(&r, sizeof r, 1, f_) != 1) throw std::runtime_error("event log: write failed");
+    ++count_;
+  }
+  void append(const Event& e) { append(to_record(e)); }
+
+  std::uint64_t count() const { return count_; }
+
+  // Patch the record count into the header and close.
+  void close() {
+    if (!f_) return;
+    std::fseek(f_, 0, SEEK_SET);
+    write_header();
+    std::fclose(f_);
+    f_ = nullptr;
+  }
+
+private:
+  void write_header() {
+    EventLogHeader h{};
+    std::memcpy(h.magic, kEventLogMagic, sizeof h.magic);
+    h.version = 1;
+    h.record_bytes = sizeof(EventRecord);
+    h.count = count_;
+    if (std::fwrite(&h, sizeof h, 1, f_) != 1) throw std::runtime_error("event log: write failed");
+  }
+
+  std::FILE* f_;
+  std::uint64_t count_{0};
+};
+
+// Read-only view of a recorded stream, mapped in place.
+class EventLog {
+public:
+  explicit EventLog(const std::string& path) : file_(io::MappedFile::open_read(path)) {
+    EventLogHeader h{};
+    if (file_.size() < sizeof h) throw std::runtime_error("event log: truncated " + path);
+    std::memcpy(&h, file_.data(), sizeof h);
+    if (std::memcmp(h.magic, kEventLogMagic, sizeof h.magic) != 0 || h.record_bytes != sizeof(EventRecord))
+      throw std::runtime_error("event log: bad header in " + path);
+    if (h.count > (file_.size() - sizeof h) / sizeof(EventRecord))
+      throw std::runtime_error("event log: truncated " + path);
+    count_ = std::size_t(h.count);
+    file_.advise_sequential();
+  }
+
+  std::size_t size() const { return count_; }
+  const EventRecord& operator[](std::size_t i) const {
+    return reinterpret_cast<const EventRecord*>(file_.data() + sizeof(EventLogHeader))[i];
+  }
+
+private:
+  io::MappedFile file_;
+  std::size_t count_{0};
+};
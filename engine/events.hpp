@@ -1,5 +1,7 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include "lob/types.hpp"
 
 // Re-export scalar types + Side so tests can write Side::Bid/Side::Ask
@@ -7,25 +9,97 @@ using Side    = lob::Side;
 using OrderId = lob::OrderId;
 using Price   = lob::Price;
 using Qty     = lob::Qty;
+using SymbolId = lob::SymbolId;
 
-// ---- Events carried on the EventBus ----
+// ---- Event payloads (fields ordered widest first: no interior padding) ----
 struct FillEvent {
   OrderId taker_id;
   OrderId maker_id;
-  Side    side;          // taker side (Bid/Ask)
   Price   px;
   Qty     qty;
+  SymbolId symbol;       // instrument (BookSet id); 0 for single-book engines
+  Side    side;          // taker side (Bid/Ask)
 };
 
 struct CancelEvent {
   OrderId id;
-  Side    side;
   Price   px;
   Qty     qty_canceled;  // tests expect this exact field name
+  SymbolId symbol;
+  Side    side;
 };
 
 struct BookChangeEvent {
-  Side  side;
   Price px;
   Qty   level_qty;       // total resting at this price after the change
+  SymbolId symbol;
+  Side  side;
+};
+
+enum class EventType : std::uint8_t { Fill, Cancel, BookChange };
+
+// ---- Event carried on the EventBus ----
+// One cache line, trivially copyable: rings move it with a plain copy and it
+// can be written to files or shared memory as-is. `type` says which payload
+// member is live; consumers branch on is<T>()/get_if<T>() or visit(f).
+struct alignas(64) Event {
+  EventType type{EventType::Fill};
+  std::uint64_t seq{0};     // 1, 2, 3, ... per EventBus, stamped on publish
+  std::uint64_t ts_ns{0};   // tb::fast_now_ns() of the command that produced it
+  union {
+    FillEvent fill;
+    CancelEvent cancel;
+    BookChangeEvent book;
+  };
+
+  Event() : fill{} {}
+  Event(const FillEvent& e) : type(EventType::Fill), fill(e) {}
+  Event(const CancelEvent& e) : type(EventType::Cancel), cancel(e) {}
+  Event(const BookChangeEvent& e) : type(EventType::BookChange), book(e) {}
+
+  template<class T> static constexpr EventType type_of() {
+    if constexpr (std::is_same_v<T, FillEvent>) return EventType::Fill;
+    else if constexpr (std::is_same_v<T, CancelEvent>) return EventType::Cancel;
+    else {
+      static_assert(std::is_same_v<T, BookChangeEvent>, "not an Event payload");
+      return EventType::BookChange;
+    }
+  }
+
+  template<class T> bool is() const { return type == type_of<T>(); }
+  template<class T> T* get_if() { return is<T>() ? &payload<T>() : nullptr; }
+  template<class T> const T* get_if() const { return is<T>() ? &payload<T>() : nullptr; }
+  // Unchecked: the caller knows the type.
+  template<class T> T& get() { return payload<T>(); }
+  template<class T> const T& get() const { return payload<T>(); }
+
+  // f(payload&) with the live payload; every overload must return the same type.
+  template<class F> decltype(auto) visit(F&& f) {
+    switch (type) {
+      case EventType::Fill:   return f(fill);
+      case EventType::Cancel: return f(cancel);
+      default:                return f(book);
+    }
+  }
+  template<class F> decltype(auto) visit(F&& f) const {
+    switch (type) {
+      case EventType::Fill:   return f(fill);
+      case EventType::Cancel: return f(cancel);
+      default:                return f(book);
+    }
+  }
+
+  SymbolId symbol() const { return visit([](auto const& e){ return e.symbol; }); }
+
+private:
+  template<class T> T& payload() {
+    if constexpr (std::is_same_v<T, FillEvent>) return fill;
+    else if constexpr (std::is_same_v<T, CancelEvent>) return cancel;
+    else return book;
+  }
+  template<class T> const T& payload() const { return const_cast<Event*>(this)->payload<T>(); }
 };
+
+static_assert(sizeof(FillEvent) == 40 && sizeof(CancelEvent) == 32 && sizeof(BookChangeEvent) == 24);
+static_assert(sizeof(Event) == 64, "one event per cache line");
+static_assert(std::is_trivially_copyable_v<Event> && std::is_standard_layout_v<Event>);
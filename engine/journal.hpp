@@ -0,0 +1,356 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "command.hpp"
+#include "common/mmap_file.hpp"
+#include "common/timebase.hpp"
+
+// ---- Write-ahead journal of inbound Commands ----
+//
+// A directory of pre-allocated segment files wal-<index>.log, each a 64-byte
+// SegmentHeader followed by 64-byte JournalRecords. The matching thread
+// append()s a record with a memcpy into an already-faulted mapping; a
+// background thread msyncs what was appended since its last pass every
+// flush_interval (group commit), retires full segments and prepares the next
+// one, so rotation on the matching thread is a pointer swap.
+//
+// A record is valid when its checksum matches; readers stop a segment at the
+// first invalid record (never written, or torn by a crash).
+//
+// With cfg.sync, a segment's size and directory entry are fsync'd when it is
+// created, before any record in it can count as durable. If the flusher fails
+// (no space for the next segment, msync error), the journal stays failed:
+// durable_seq() stops advancing and append()/wait_durable() throw.
+
+inline constexpr char kJournalMagic[8] = {'L', 'O', 'B', 'W', 'A', 'L', '\0', '\0'};
+inline constexpr std::uint32_t kJournalVersion = 1;
+
+struct SegmentHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_bytes;
+  std::uint64_t index;          // position in the journal (file name)
+  std::uint64_t first_seq;      // seq of the first record in this segment
+  std::uint8_t  reserved[32];
+};
+
+struct JournalRecord {
+  std::uint64_t seq;            // 1, 2, 3, ... across segments
+  std::uint64_t ts_ns;          // tb::now_ns() at append
+  Command       cmd;
+  std::uint64_t checksum;       // over every byte before it
+};
+
+static_assert(sizeof(SegmentHeader) == 64);
+static_assert(sizeof(JournalRecord) == 64, "one record per cache line");
+static_assert(std::is_trivially_copyable_v<JournalRecord>);
+
+inline std::uint64_t journal_checksum(const JournalRecord& r) {
+  std::uint64_t w[7];
+  static_assert(offsetof(JournalRecord, checksum) == sizeof w);
+  std::memcpy(w, &r, sizeof w);
+  std::uint64_t h = 0x6a09e667f3bcc909ull;
+  for (auto x : w) { h = (h ^ x) * 0x9e3779b97f4a7c15ull; h ^= h >> 29; }
+  return h | 1;                 // never 0, so a zeroed slot can't validate
+}
+
+inline std::string journal_segment_name(std::uint64_t index) {
+  char buf[32];
+  std::snprintf(buf, sizeof buf, "wal-%012llu.log", static_cast<unsigned long long>(index));
+  return buf;
+}
+
+// Segment files of `dir` in journal order (by index).
+inline std::vector<std::filesystem::path> journal_segments(const std::string& dir) {
+  std::vector<std::filesystem::path> out;
+  if (!std::filesystem::is_directory(dir)) return out;
+  for (auto const& e : std::filesystem::directory_iterator(dir)) {
+    const std::string n = e.path().filename().string();
+    if (n.size() == 20 && n.rfind("wal-", 0) == 0 && n.compare(16, 4, ".log") == 0) out.push_back(e.path());
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+// ---- Reader: every valid record, in order ----
+class JournalReader {
+public:
+  explicit JournalReader(std::string dir) : dir_(std::move(dir)) {}
+
+  // f(const JournalRecord&) for each valid record; records are read in place
+  // from the mapping. Returns the number of records visited.
+  template<typename F>
+  std::uint64_t for_each(F&& f) const {
+    std::uint64_t n = 0;
+    for (auto const& path : journal_segments(dir_)) {
+      auto m = io::MappedFile::open_read(path.string());
+      if (m.size() < sizeof(SegmentHeader)) continue;
+      SegmentHeader h;
+      std::memcpy(&h, m.data(), sizeof h);
+      if (h.version == 0) continue;        // spare that was never started
+      if (std::memcmp(h.magic, kJournalMagic, sizeof h.magic) != 0 || h.version != kJournalVersion ||
+          h.record_bytes != sizeof(JournalRecord))
+        throw std::runtime_error("journal: bad segment header in " + path.string());
+      m.advise_sequential();
+      const auto* r = reinterpret_cast<const JournalRecord*>(m.data() + sizeof(SegmentHeader));
+      const std::size_t cap = (m.size() - sizeof(SegmentHeader)) / sizeof(JournalRecord);
+      for (std::size_t i = 0; i < cap && r[i].checksum == journal_checksum(r[i]); ++i, ++n) f(r[i]);
+    }
+    return n;
+  }
+
+  // Highest valid seq (0 for an empty journal).
+  std::uint64_t last_seq() const {
+    std::uint64_t last = 0;
+    for_each([&](const JournalRecord& r){ last = r.seq; });
+    return last;
+  }
+
+private:
+  std::string dir_;
+};
+
+// ---- Writer ----
+class Journal {
+public:
+  struct Config {
+    std::string dir;
+    std::size_t segment_bytes{64u << 20};                // per file, header included
+    std::chrono::microseconds flush_interval{1000};      // group-commit window
+    bool sync{true};                                     // msync (false: page cache only)
+  };
+
+  struct Stats {
+    std::uint64_t appended{0};
+    std::uint64_t rotations{0};
+    std::uint64_t spare_misses{0};   // rotations that had to wait for a spare segment
+    std::uint64_t syncs{0};          // msync calls
+  };
+
+  // Opens (creating if needed) cfg.dir and continues after its last valid
+  // record in a fresh segment.
+  explicit Journal(Config cfg) : cfg_(std::move(cfg)) {
+    if (cfg_.segment_bytes < sizeof(SegmentHeader) + sizeof(JournalRecord))
+      throw std::invalid_argument("journal: segment too small");
+    cfg_.segment_bytes -= (cfg_.segment_bytes - sizeof(SegmentHeader)) % sizeof(JournalRecord);
+    std::filesystem::create_directories(cfg_.dir);
+    std::uint64_t index = 0;
+    if (auto segs = journal_segments(cfg_.dir); !segs.empty()) {
+      index = std::stoull(segs.back().filename().string().substr(4, 12)) + 1;
+      next_seq_ = JournalReader(cfg_.dir).last_seq() + 1;
+    }
+    durable_seq_.store(next_seq_ - 1, std::memory_order_relaxed);
+    cur_ = make_segment(index);
+    cur_->start(next_seq_);
+    base_ = cur_->file.data();
+    off_ = sizeof(SegmentHeader);
+    flusher_ = std::thread([this]{ flush_loop(); });
+  }
+
+  ~Journal() { close(); }
+
+  Journal(const Journal&) = delete;
+  Journal& operator=(const Journal&) = delete;
+
+  // ---- Matching thread ----
+  // Append one command; returns its seq. No syscalls except on a rotation
+  // that finds no spare segment ready.
+  std::uint64_t append(const Command& c) {
+    if (failed_.load(std::memory_order_acquire)) [[unlikely]] throw_failed();
+    if (off_ == cfg_.segment_bytes) [[unlikely]] rotate();
+    JournalRecord r{next_seq_, tb::now_ns(), c, 0};
+    r.checksum = journal_checksum(r);
+    std::memcpy(base_ + off_, &r, sizeof r);
+    off_ += sizeof r;
+    cur_->end.store(off_, std::memory_order_release);
+    ++stats_.appended;
+    return next_seq_++;
+  }
+
+  std::uint64_t last_seq() const { return next_seq_ - 1; }
+  Stats stats() const {            // matching thread
+    Stats s = stats_;
+    s.syncs = syncs_.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  // ---- Any thread ----
+  // Highest seq known to be on stable storage (or handed to the page cache
+  // when cfg.sync is false).
+  std::uint64_t durable_seq() const { return durable_seq_.load(std::memory_order_acquire); }
+
+  // Block until seq is durable (waits for the next group commit). Throws if
+  // the journal fails first.
+  void wait_durable(std::uint64_t seq) const {
+    while (durable_seq() < seq) {
+      if (failed()) throw_failed();
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+
+  bool failed() const { return failed_.load(std::memory_order_acquire); }
+
+  // Stop the flusher after a final commit of everything appended. Idempotent;
+  // call from the matching thread (or after it stopped appending).
+  void close() {
+    if (!flusher_.joinable()) return;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    flusher_.join();
+    if (spare_) {                         // never started: don't leave it behind
+      const auto path = std::filesystem::path(cfg_.dir) / journal_segment_name(spare_->index);
+      spare_.reset();
+      std::filesystem::remove(path);
+    }
+  }
+
+private:
+  struct Segment {
+    io::MappedFile file;
+    std::uint64_t index{0};
+    std::uint64_t first_seq{0};
+    std::atomic<std::size_t> end{sizeof(SegmentHeader)};   // bytes appended (writer)
+    std::size_t synced{sizeof(SegmentHeader)};              // flusher only
+
+    void start(std::uint64_t seq) {
+      first_seq = seq;
+      SegmentHeader h{};
+      std::memcpy(h.magic, kJournalMagic, sizeof h.magic);
+      h.version = kJournalVersion;
+      h.record_bytes = sizeof(JournalRecord);
+      h.index = index;
+      h.first_seq = seq;
+      std::memcpy(file.data(), &h, sizeof h);
+    }
+  };
+  using SegmentPtr = std::shared_ptr<Segment>;
+
+  SegmentPtr make_segment(std::uint64_t index) const {
+    auto s = std::make_shared<Segment>();
+    s->index = index;
+    s->file = io::MappedFile::create(
+        (std::filesystem::path(cfg_.dir) / journal_segment_name(index)).string(), cfg_.segment_bytes);
+    s->file.prefault_write();
+    if (cfg_.sync) {
+      s->file.sync_metadata();
+      io::sync_dir(cfg_.dir);
+    }
+    return s;
+  }
+
+  // Only the flusher creates segments after construction (one spare at a
+  // time), so the matching thread waits on the rare miss instead of racing
+  // it for the same file.
+  void rotate() {
+    SegmentPtr next;
+    for (bool missed = false;; ) {
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        next = std::move(spare_);
+      }
+      if (next) break;
+      if (failed()) throw_failed();     // no spare is coming
+      if (!missed) { missed = true; ++stats_.spare_misses; }
+      cv_.notify_one();
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+    next->start(next_seq_);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      retired_.push_back(cur_);
+      cur_ = next;
+    }
+    cv_.notify_one();   // prepare the following spare now
+    base_ = cur_->file.data();
+    off_ = sizeof(SegmentHeader);
+    ++stats_.rotations;
+  }
+
+  // msync what was appended since the last pass; returns the highest seq covered.
+  std::uint64_t commit(Segment& s) {
+    const std::size_t end = s.end.load(std::memory_order_acquire);
+    if (end > s.synced) {
+      if (cfg_.sync) { s.file.sync(s.synced, end - s.synced); syncs_.fetch_add(1, std::memory_order_relaxed); }
+      s.synced = end;
+    }
+    return s.first_seq + (s.synced - sizeof(SegmentHeader)) / sizeof(JournalRecord) - 1;
+  }
+
+  // Runs on flusher_: an error ends it and fails the journal rather than
+  // escaping the thread.
+  void flush_loop() {
+    try {
+      flush_passes();
+    } catch (const std::exception& e) {
+      error_ = e.what();
+      failed_.store(true, std::memory_order_release);
+    }
+  }
+
+  void flush_passes() {
+    for (bool last = false; !last; ) {
+      std::vector<SegmentPtr> retired;
+      SegmentPtr cur;
+      bool need_spare;
+      {
+        std::unique_lock<std::mutex> lk(mu_);
+        cv_.wait_for(lk, cfg_.flush_interval, [&]{ return stop_ || !spare_; });
+        last = stop_;
+        retired.swap(retired_);
+        cur = cur_;
+        need_spare = !spare_ && !last;
+      }
+      std::uint64_t durable = durable_seq_.load(std::memory_order_relaxed);
+      for (auto& s : retired) durable = std::max(durable, commit(*s));   // unmapped when dropped
+      if (cur->end.load(std::memory_order_acquire) > sizeof(SegmentHeader))
+        durable = std::max(durable, commit(*cur));
+      durable_seq_.store(durable, std::memory_order_release);
+      if (need_spare) {
+        // cur_ can't move on without this spare, so cur->index + 1 is next.
+        auto s = make_segment(cur->index + 1);
+        std::lock_guard<std::mutex> lk(mu_);
+        spare_ = std::move(s);
+      }
+    }
+  }
+
+  [[noreturn]] void throw_failed() const { throw std::runtime_error("journal: " + error_); }
+
+  Config cfg_;
+
+  // Matching thread state.
+  SegmentPtr cur_;                 // also read by the flusher under mu_
+  std::byte* base_{nullptr};
+  std::size_t off_{0};
+  std::uint64_t next_seq_{1};
+  Stats stats_{};
+
+  // Shared with the flusher.
+  std::mutex mu_;
+  std::condition_variable cv_;
+  SegmentPtr spare_;
+  std::vector<SegmentPtr> retired_;
+  bool stop_{false};
+  std::atomic<std::uint64_t> durable_seq_{0};
+  std::atomic<std::uint64_t> syncs_{0};
+  std::string error_;                   // written once, before failed_
+  std::atomic<bool> failed_{false};
+  std::thread flusher_;
+};
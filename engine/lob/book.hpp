@@ -1,142 +1,216 @@
 #pragma once
-#include <map>
-#include <unordered_map>
 #include <vector>
 #include <string>
 #include <cassert>
 #include <cstdint> // for std::uint64_t
+#include <utility>
+#include <algorithm>
+#include <limits>
 #include "types.hpp"
 #include "order.hpp"
 #include "price_level.hpp"
+#include "order_pool.hpp"
+#include "ladder.hpp"
+#include "order_index.hpp"
+#include "depth_tree.hpp"
 
 namespace lob {
 
 struct Book {
-  // bids: highest first; asks: lowest first
-  std::map<Price, PriceLevel, std::greater<Price>> bids_; // sorted dict
-  std::map<Price, PriceLevel, std::less<Price>>    asks_;
-  std::unordered_map<OrderId, OrderNode*> id_index_; // unsorted dict
+  // bids: highest first; asks: lowest first (map or flat tick ladder)
+  Ladder<Side::Bid> bids_;
+  Ladder<Side::Ask> asks_;
+  // id -> (node, owner TraderId; 0 means unknown owner), one probe per lookup
+  OrderIndex id_index_;
   Qty bids_total_{0}, asks_total_{0};
 
   // ---- Day 6: TIF + STP config ----
   enum class TimeInForce : uint8_t { Day, IOC, FOK };
   enum class STPPolicy   : uint8_t { Allow, CancelTaker, CancelMaker, CancelBoth };
-  struct BookConfig { STPPolicy stp = STPPolicy::Allow; }; // DEFAULT: Allow (opt-in STP)
+  struct BookConfig {
+    STPPolicy stp = STPPolicy::Allow;   // DEFAULT: Allow (opt-in STP)
+    std::size_t reserve_orders = 0;     // pre-size node pool + id index (0 = grow lazily)
+    bool prefault = false;              // touch pool pages up front
+    LadderKind ladder = LadderKind::Map; // price-level storage backend
+    std::size_t flat_ticks = 1024;      // initial Flat window width (ticks)
+    std::size_t flat_max_ticks = Ladder<Side::Bid>::kDefaultMaxTicks; // widest Flat / depth-tree window; wider ranges use Map / ladder walks
+    LevelQueue queue = LevelQueue::List; // per-level FIFO storage
+    bool depth_tree = false;            // keep Fenwick depth per side (O(log n) FOK/sweep queries)
+    bool l2_deltas = false;             // record every level change into deltas()
+  };
 
-  // Order owners (TraderId); 0 means unknown owner
-  std::unordered_map<OrderId, std::uint64_t> owners_;
   BookConfig cfg_{};
 
+  // All OrderNode storage comes from here (no new/delete on the hot path).
+  OrderPool pool_;
+
+  // Cumulative depth per side; maintained only when cfg_.depth_tree.
+  DepthTree<Side::Bid> bid_depth_;
+  DepthTree<Side::Ask> ask_depth_;
+
+  // L2 deltas since the last clear_deltas(); recorded only when cfg_.l2_deltas.
+  std::vector<LevelDelta> deltas_;
+
+  Book() = default;
+  explicit Book(BookConfig cfg)
+    : bids_(cfg.ladder, cfg.flat_ticks, cfg.queue, cfg.flat_max_ticks),
+      asks_(cfg.ladder, cfg.flat_ticks, cfg.queue, cfg.flat_max_ticks),
+      cfg_(cfg),
+      bid_depth_(cfg.flat_ticks, cfg.flat_max_ticks), ask_depth_(cfg.flat_ticks, cfg.flat_max_ticks) {
+    if (cfg_.reserve_orders) {
+      pool_.reserve(cfg_.reserve_orders);
+      id_index_.reserve(cfg_.reserve_orders);
+    }
+    if (cfg_.prefault) pool_.prefault();
+  }
   ~Book(){ clear_all(); }
 
+  // Movable so books can live in a contiguous array (BookSet). Nodes stay
+  // where they are: pool slabs, ladders and index all move with the book.
+  Book(Book&& o) noexcept
+    : bids_(std::move(o.bids_)), asks_(std::move(o.asks_)),
+      id_index_(std::move(o.id_index_)),
+      bids_total_(std::exchange(o.bids_total_, 0)), asks_total_(std::exchange(o.asks_total_, 0)),
+      cfg_(o.cfg_), pool_(std::move(o.pool_)),
+      bid_depth_(std::move(o.bid_depth_)), ask_depth_(std::move(o.ask_depth_)),
+      deltas_(std::move(o.deltas_)) {
+    o.id_index_.clear();
+  }
+  Book& operator=(Book&& o) noexcept {
+    if (this != &o) {
+      clear_all();
+      bids_ = std::move(o.bids_); asks_ = std::move(o.asks_);
+      id_index_ = std::move(o.id_index_); o.id_index_.clear();
+      bids_total_ = std::exchange(o.bids_total_, 0);
+      asks_total_ = std::exchange(o.asks_total_, 0);
+      cfg_ = o.cfg_;
+      pool_ = std::move(o.pool_);
+      bid_depth_ = std::move(o.bid_depth_); ask_depth_ = std::move(o.ask_depth_);
+      deltas_ = std::move(o.deltas_);
+    }
+    return *this;
+  }
+  Book(const Book&) = delete;
+  Book& operator=(const Book&) = delete;
+
+  const PoolStats& pool_stats() const { return pool_.stats(); }
+
   void clear_all(){
-    auto free_side = [&](auto& m){
-      for (auto& [_, lvl] : m) {
-        for (auto* n = lvl.head; n; ) { auto* nx=n->next; delete n; n=nx; }
-        lvl.head=lvl.tail=nullptr; lvl.count=0; lvl.total_qty=0;
-      }
-      m.clear();
+    auto free_side = [&](auto& ladder){
+      ladder.walk([&](PriceLevel& lvl){
+        lvl.for_each([&](OrderNode* n){ pool_.destroy(n); });
+        lvl.reset();
+        return true;
+      });
+      ladder.clear();
     };
     free_side(bids_); free_side(asks_);
-    id_index_.clear(); owners_.clear();
+    bid_depth_.clear(); ask_depth_.clear();
+    id_index_.clear();
+    deltas_.clear();
     bids_total_ = asks_total_ = 0;
   }
 
-  bool has(OrderId id) const { return id_index_.count(id)>0; }
+  bool has(OrderId id) const { return id_index_.find(id) != nullptr; }
+
+  // ---------- L2 deltas ----------
+  // With cfg_.l2_deltas, every mutation (submit, cancel, replace, add,
+  // reduce) appends one (side, px, new level qty) per level it changed, in
+  // the order it changed them, so a mirror book can be kept without rescans.
+  // The buffer accumulates until the caller drains it.
+  const std::vector<LevelDelta>& deltas() const { return deltas_; }
+  void clear_deltas() { deltas_.clear(); }
 
   BestOfBook best() const {
     BestOfBook b;
-    if (!bids_.empty()) b.bid = bids_.begin()->first;
-    if (!asks_.empty()) b.ask = asks_.begin()->first;
+    if (auto* l = bids_.best()) b.bid = l->price;
+    if (auto* l = asks_.best()) b.ask = l->price;
     return b;
   }
 
   // ---------- mutations (non-matching add) ----------
   bool add(OrderId id, Side side, Price px, Qty qty, TimeNs ts_ns){
-    if (qty <= 0 || id_index_.count(id)) return false;
-
+    if (qty <= 0 || id_index_.find(id)) return false;
     // Non-matching mode: reject marketable (lock/cross) adds
-    if (side == Side::Bid) {
-      if (!asks_.empty() && px >= asks_.begin()->first) return false; // would lock/cross
-      auto [it, _created] = bids_.try_emplace(px, PriceLevel{.price=px});
-      OrderNode* n = new OrderNode{ id, side, px, qty, ts_ns };
-      it->second.push_back(n);
-      id_index_[id] = n;
-      owners_[id] = 0; // unknown owner in non-matching mode
-      bids_total_ += qty;
-    } else { // Side::Ask
-      if (!bids_.empty() && px <= bids_.begin()->first) return false; // would lock/cross
-      auto [it, _created] = asks_.try_emplace(px, PriceLevel{.price=px});
-      OrderNode* n = new OrderNode{ id, side, px, qty, ts_ns };
-      it->second.push_back(n);
-      id_index_[id] = n;
-      owners_[id] = 0; // unknown owner
-      asks_total_ += qty;
-    }
-    return true;
+    return side == Side::Bid ? add_on<Side::Bid>(id, px, qty, ts_ns)
+                             : add_on<Side::Ask>(id, px, qty, ts_ns);
   }
 
   bool reduce(OrderId id, Qty dq){
     if (dq <= 0) return dq==0; // treat 0 as no-op
-    auto it = id_index_.find(id); if (it==id_index_.end()) return false;
-    OrderNode* n = it->second;
-    if (dq > n->qty) return false;
-
-    if (n->side == Side::Bid) {
-      auto lvl_it = bids_.find(n->px); if (lvl_it==bids_.end()) return false;
-      auto& lvl = lvl_it->second;
-      bool remains = lvl.reduce(n, dq);
-      bids_total_ -= dq;
-      if (!remains) {
-        lvl.erase(n); delete n; id_index_.erase(it); owners_.erase(id);
-        if (lvl.empty()) bids_.erase(lvl_it);
-      }
-    } else {
-      auto lvl_it = asks_.find(n->px); if (lvl_it==asks_.end()) return false;
-      auto& lvl = lvl_it->second;
-      bool remains = lvl.reduce(n, dq);
-      asks_total_ -= dq;
-      if (!remains) {
-        lvl.erase(n); delete n; id_index_.erase(it); owners_.erase(id);
-        if (lvl.empty()) asks_.erase(lvl_it);
-      }
-    }
-    return true;
+    auto* e = id_index_.find(id); if (!e) return false;
+    if (dq > e->node->qty) return false;
+    return e->node->side == Side::Bid ? reduce_on<Side::Bid>(e, dq)
+                                      : reduce_on<Side::Ask>(e, dq);
+  }
+
+  // ---------- bulk restore (snapshots) ----------
+  // A resting order as persisted; its FIFO position is the restore order.
+  struct RestingOrder { OrderId id; TraderId owner; Qty qty; TimeNs ts_ns; };
+
+  // Append n orders at px to the back of that level: no matching, no cross
+  // check. Restore each side best-first, then call finish_restore().
+  void restore_level(Side side, Price px, const RestingOrder* o, std::size_t n) {
+    if (side == Side::Bid) restore_level_on<Side::Bid>(px, o, n);
+    else                   restore_level_on<Side::Ask>(px, o, n);
+  }
+  void finish_restore() {
+    if (!cfg_.depth_tree) return;
+    if (auto* l = bids_.best()) bid_depth_.rebuild(bids_, l->price);
+    if (auto* l = asks_.best()) ask_depth_.rebuild(asks_, l->price);
   }
 
   // ---------- invariants ----------
   std::vector<std::string> check_invariants() const {
     std::vector<std::string> err;
-    auto check_side = [&](auto const& side_map, Side side, Qty side_total){
+    std::size_t nodes = 0;
+    auto check_side = [&](auto const& ladder, Side side, Qty side_total){
       Qty sum_levels = 0;
-      for (auto const& [px, lvl] : side_map) {
+      Price last_px = 0; bool first = true;
+      ladder.walk([&](PriceLevel const& lvl){
+        const Price px = lvl.price;
+        if (!first && ((side == Side::Bid) ? px >= last_px : px <= last_px))
+          err.emplace_back("level order broken @"+std::to_string(px));
+        first = false; last_px = px;
         Qty walk_qty = 0; std::size_t cnt=0;
-        OrderNode* prev=nullptr;
-        for (auto* n=lvl.head; n; n=n->next){
-          ++cnt; walk_qty += n->qty;
-          auto it = id_index_.find(n->id);
-          if (it==id_index_.end() || it->second!=n)
+        lvl.for_each([&](OrderNode* n){
+          ++cnt; ++nodes; walk_qty += n->qty;
+          auto* e = id_index_.find(n->id);
+          if (!e || e->node!=n)
             err.emplace_back("id_index mismatch id="+std::to_string(n->id));
           if (n->px!=px || n->side!=side)
             err.emplace_back("node(level mismatch) id="+std::to_string(n->id));
-          if (n->prev!=prev) err.emplace_back("broken prev link @"+std::to_string(px));
-          prev = n;
-        }
+        });
         if (cnt!=lvl.count) err.emplace_back("level.count mismatch @"+std::to_string(px));
         if (walk_qty!=lvl.total_qty) err.emplace_back("level.total_qty mismatch @"+std::to_string(px));
-        if ((lvl.count==0) != (lvl.head==nullptr && lvl.tail==nullptr))
-          err.emplace_back("empty level head/tail mismatch @"+std::to_string(px));
+        lvl.check_queue(err);
         sum_levels += lvl.total_qty;
-      }
+        return true;
+      });
       if (sum_levels != side_total)
         err.emplace_back(std::string("side total mismatch ")+side_str(side));
+      ladder.check_invariants(err);
+    };
+    auto check_depth = [&](auto const& ladder, auto const& depth, Side side, Qty side_total){
+      if (!cfg_.depth_tree) return;
+      if (depth.total() != side_total)
+        err.emplace_back(std::string("depth total mismatch ")+side_str(side));
+      if (!depth.active()) return;     // side too wide for the tree: queries walk the ladder
+      ladder.walk([&](PriceLevel const& lvl){
+        if (depth.qty_at(lvl.price) != lvl.total_qty)
+          err.emplace_back("depth level mismatch @"+std::to_string(lvl.price));
+        return true;
+      });
     };
 
     check_side(bids_, Side::Bid, bids_total_);
     check_side(asks_, Side::Ask, asks_total_);
+    check_depth(bids_, bid_depth_, Side::Bid, bids_total_);
+    check_depth(asks_, ask_depth_, Side::Ask, asks_total_);
+    if (nodes != id_index_.size()) err.emplace_back("id_index size mismatch");
 
     if (!bids_.empty() && !asks_.empty()) {
-      if (!(bids_.begin()->first < asks_.begin()->first))
+      if (!(bids_.best()->price < asks_.best()->price))
         err.emplace_back("locked/crossed book: best_bid>=best_ask");
     }
     return err;
@@ -149,206 +223,193 @@ struct Book {
     Qty  posted_qty   = 0;   // qty left resting (0 for IOC/market/FOK)
   };
 
+  // Result of the sink-based submit: fills went to the sink, only totals here.
+  struct SubmitResult {
+    std::size_t fill_count = 0;
+    Qty  filled_qty   = 0;
+    bool book_changed = false;
+    Qty  posted_qty   = 0;   // qty left resting (0 for IOC/market/FOK)
+  };
+
+  // Fill sink that drops everything (totals are still in SubmitResult).
+  struct NoFillSink { void operator()(const MatchFill&) const noexcept {} };
+
   enum class OrderType : uint8_t { Limit, Market };
 
+  // ---------- depth queries ----------
+  // `side` is the RESTING side being taken from (a buy checks Ask).
+  // O(log n) with cfg_.depth_tree, otherwise (or while the side spans more
+  // than flat_max_ticks) a walk from the top.
+
+  // Resting qty on `side` priced at limit_px or better.
+  Qty available_qty_through(Side side, Price limit_px) const {
+    return side == Side::Bid ? available_through<Side::Bid>(limit_px)
+                             : available_through<Side::Ask>(limit_px);
+  }
+
+  // What sweeping qty off `side` best-first would fill, its notional
+  // (sum px*qty) and the deepest price reached. Sweep::qty < qty means the
+  // side is too thin.
+  using SweepCost = DepthTree<Side::Bid>::Sweep;
+  SweepCost sweep_cost(Side side, Qty qty) const {
+    return side == Side::Bid ? sweep_cost_on<Side::Bid>(qty) : sweep_cost_on<Side::Ask>(qty);
+  }
+
+  template<Side S>
+  Qty available_through(Price limit_px, Qty enough = kNoLimit) const {
+    if (cfg_.depth_tree && depth<S>().active()) return depth<S>().qty_through(limit_px);
+    constexpr Side T = opposite<S>;           // taker side that would cross S
+    Qty q = 0;
+    ladder<S>().walk([&](PriceLevel const& lvl){
+      if (!crosses<T>(limit_px, lvl.price)) return false;
+      q += lvl.total_qty;
+      return q < enough;
+    });
+    return q;
+  }
+
+  template<Side S>
+  SweepCost sweep_cost_on(Qty qty) const {
+    if (cfg_.depth_tree && depth<S>().active()) {
+      auto s = depth<S>().sweep(qty);
+      return {s.qty, s.notional, s.worst_px};
+    }
+    SweepCost out;
+    if (qty <= 0) return out;
+    ladder<S>().walk([&](PriceLevel const& lvl){
+      Qty take = std::min(qty - out.qty, lvl.total_qty);
+      out.qty += take;
+      out.notional += std::int64_t(lvl.price) * take;
+      out.worst_px = lvl.price;
+      return out.qty < qty;
+    });
+    return out;
+  }
+
   // ---------- Day 6: matching submit (owner + TIF) ----------
+  // Collects fills into MatchResult::fills (allocates when it trades).
   MatchResult submit(std::uint64_t trader, Side side, Price px, Qty qty, OrderId id,
                      OrderType type, TimeInForce tif) {
     MatchResult out{};
+    auto r = submit(trader, side, px, qty, id, type, tif,
+                    [&](const MatchFill& f){ out.fills.push_back(f); });
+    out.book_changed = r.book_changed;
+    out.posted_qty   = r.posted_qty;
+    return out;
+  }
+
+  // Streams every fill to on_fill(const MatchFill&) as it happens; no heap
+  // traffic beyond what posting a new level/order needs.
+  // Dispatches once on (side, type, tif) into a specialized submit_as<>.
+  template<typename FillSink>
+  SubmitResult submit(std::uint64_t trader, Side side, Price px, Qty qty, OrderId id,
+                      OrderType type, TimeInForce tif, FillSink&& on_fill) {
+    return side == Side::Bid
+      ? submit_side<Side::Bid>(trader, px, qty, id, type, tif, on_fill)
+      : submit_side<Side::Ask>(trader, px, qty, id, type, tif, on_fill);
+  }
+
+  template<Side S, typename FillSink>
+  SubmitResult submit_side(std::uint64_t trader, Price px, Qty qty, OrderId id,
+                           OrderType type, TimeInForce tif, FillSink&& on_fill) {
+    using TIF = TimeInForce;
+    if (type == OrderType::Market) {
+      // Market never rests: Day behaves as IOC.
+      return tif == TIF::FOK
+        ? submit_as<S, OrderType::Market, TIF::FOK>(trader, px, qty, id, on_fill)
+        : submit_as<S, OrderType::Market, TIF::IOC>(trader, px, qty, id, on_fill);
+    }
+    switch (tif) {
+      case TIF::IOC: return submit_as<S, OrderType::Limit, TIF::IOC>(trader, px, qty, id, on_fill);
+      case TIF::FOK: return submit_as<S, OrderType::Limit, TIF::FOK>(trader, px, qty, id, on_fill);
+      default:       return submit_as<S, OrderType::Limit, TIF::Day>(trader, px, qty, id, on_fill);
+    }
+  }
+
+  // The matching core, fully specialized: taker side S against the opposite
+  // ladder, order type T and time-in-force F known at compile time.
+  template<Side S, OrderType T, TimeInForce F, typename FillSink>
+  SubmitResult submit_as(std::uint64_t trader, Price px, Qty qty, OrderId id,
+                         FillSink&& on_fill) {
+    constexpr Side O = opposite<S>;
+    SubmitResult out{};
     if (qty <= 0) return out;
-    if (type == OrderType::Limit && px <= 0) return out;
+    if constexpr (T == OrderType::Limit) { if (px <= 0) return out; }
 
-    auto can_trade = [&](Price limit_px, Price best) -> bool {
-      return (side == Side::Bid) ? (limit_px >= best) : (limit_px <= best);
-    };
+    auto& makers      = ladder<O>();
+    Qty&  maker_total = side_total<O>();
 
     // ---- FOK pre-check (no side effects if insufficient)
-    if (tif == TimeInForce::FOK) {
-      Qty execable = 0;
-      if (side == Side::Bid) {
-        for (auto it = asks_.begin(); it != asks_.end(); ++it) {
-          Price ak = it->first;
-          if (type == OrderType::Limit && !can_trade(px, ak)) break;
-          execable += it->second.total_qty;
-          if (execable >= qty) break;
-        }
-      } else {
-        for (auto it = bids_.begin(); it != bids_.end(); ++it) {
-          Price bk = it->first;
-          if (type == OrderType::Limit && !can_trade(px, bk)) break;
-          execable += it->second.total_qty;
-          if (execable >= qty) break;
-        }
-      }
+    if constexpr (F == TimeInForce::FOK) {
+      Qty execable;
+      if constexpr (T == OrderType::Market) execable = maker_total;  // whole side, O(1)
+      else                                  execable = available_through<O>(px, qty);
       if (execable < qty) {
         // reject: no ghost ids, no changes
         return out;
       }
     }
 
-    auto self_trade_block = [&](OrderNode* maker, Qty& taker_qty,
-                                PriceLevel& lvl, Qty& side_total) {
-      // maker owner from owners_; if missing, treat 0
-      auto itown = owners_.find(maker->id);
-      std::uint64_t maker_owner = (itown == owners_.end()) ? 0 : itown->second;
-      if (cfg_.stp == STPPolicy::Allow || maker_owner != trader) return false;
-
-      Qty overlap = (taker_qty < maker->qty) ? taker_qty : maker->qty;
-      switch (cfg_.stp) {
-        case STPPolicy::CancelTaker:
-          taker_qty -= overlap;               // drop incoming overlap
-          out.book_changed = true;
-          break;
-        case STPPolicy::CancelMaker:
-          maker->qty -= overlap;              // reduce resting
-          lvl.total_qty -= overlap; side_total -= overlap;
-          if (maker->qty == 0) {
-            auto* dead = maker;
-            lvl.head = maker->next;
-            if (lvl.head) lvl.head->prev = nullptr; else lvl.tail = nullptr;
-            lvl.count--; id_index_.erase(dead->id); owners_.erase(dead->id);
-            delete dead; out.book_changed = true;
-          }
-          // Drop the taker so it doesn't keep canceling more
-          taker_qty = 0;
-          break;
-        case STPPolicy::CancelBoth:
-          taker_qty   -= overlap;
-          maker->qty  -= overlap;
-          lvl.total_qty -= overlap; side_total -= overlap;
-          if (maker->qty == 0) {
-            auto* dead = maker;
-            lvl.head = maker->next;
-            if (lvl.head) lvl.head->prev = nullptr; else lvl.tail = nullptr;
-            lvl.count--; id_index_.erase(dead->id); owners_.erase(dead->id);
-            delete dead; out.book_changed = true;
-          }
-          break;
-        default: break;
-      }
-      return true; // handled STP; do not trade this iteration
-    };
-
     Qty taker_qty = qty;
 
-    if (side == Side::Bid) {
-      // Cross against asks (lowest first)
-      while (taker_qty > 0 && !asks_.empty()) {
-        Price best_ask = asks_.begin()->first;
-        bool marketable = (type == OrderType::Market) || can_trade(px, best_ask);
-        if (!marketable) break;
-
-        auto &lvl = asks_.begin()->second; // FIFO at best ask
-        while (taker_qty > 0 && lvl.head) {
-          auto* maker = lvl.head;
-
-          // ---- STP
-          if (self_trade_block(maker, taker_qty, lvl, asks_total_)) {
+    // Cross against the opposite side, best level first
+    while (taker_qty > 0) {
+      PriceLevel* best = makers.best();
+      if (!best) break;
+      auto& lvl = *best; // FIFO at best opposite price
+      const Price level_px = lvl.price;
+      if constexpr (T == OrderType::Limit) { if (!crosses<S>(px, level_px)) break; }
+      const Qty level_before = lvl.total_qty;
+
+      while (taker_qty > 0 && !lvl.empty()) {
+        // ---- STP
+        if (cfg_.stp != STPPolicy::Allow) [[unlikely]] {
+          if (self_trade_block(trader, lvl.front(), taker_qty, lvl, maker_total, out)) {
             if (taker_qty == 0) break;      // taker dropped/consumed by STP
-            if (!lvl.head) break;           // level emptied by STP
+            if (lvl.empty()) break;         // level emptied by STP
             continue;                       // skip trade, re-evaluate
           }
-
-          // ---- Trade
-          Qty traded = (taker_qty < maker->qty) ? taker_qty : maker->qty;
-          maker->qty -= traded;
-          taker_qty  -= traded;
-          lvl.total_qty -= traded;
-          asks_total_   -= traded;
-
-          out.fills.push_back(MatchFill{ id, maker->id, best_ask, traded });
-
-          if (maker->qty == 0) {
-            auto* dead = maker;
-            lvl.head = maker->next;
-            if (lvl.head) lvl.head->prev = nullptr; else lvl.tail = nullptr;
-            lvl.count--;
-            id_index_.erase(dead->id);
-            owners_.erase(dead->id);
-            delete dead;
-            out.book_changed = true;
-          }
         }
-        if (!lvl.head) { asks_.erase(asks_.begin()); out.book_changed = true; }
-      }
-
-      // IOC or Market: drop remainder (no post)
-      if (tif == TimeInForce::IOC || type == OrderType::Market) return out;
 
-      // Post remainder if limit + Day
-      if (taker_qty > 0 && type == OrderType::Limit) {
-        auto &lvl = bids_[px];
-        auto* n = new OrderNode{ .id=id, .side=side, .px=px, .qty=taker_qty,
-                                 .prev=lvl.tail, .next=nullptr };
-        if (lvl.tail) lvl.tail->next = n; else lvl.head = n;
-        lvl.tail = n; lvl.count++; lvl.total_qty += taker_qty;
-        id_index_[id] = n;
-        owners_[id]   = trader;
-        bids_total_  += taker_qty;
-        out.posted_qty = taker_qty;
-        out.book_changed = true;
-      }
+        // ---- Trade (Ring levels: reads stay in the contiguous queue)
+        const OrderId maker_id = lvl.front_id();
+        const Qty maker_qty = lvl.front_qty();
+        Qty traded = (taker_qty < maker_qty) ? taker_qty : maker_qty;
+        taker_qty   -= traded;
+        maker_total -= traded;
 
-    } else { // Side::Ask
-      // Cross against bids (highest first)
-      while (taker_qty > 0 && !bids_.empty()) {
-        Price best_bid = bids_.begin()->first;
-        bool marketable = (type == OrderType::Market) || can_trade(px, best_bid);
-        if (!marketable) break;
-
-        auto &lvl = bids_.begin()->second; // FIFO at best bid
-        while (taker_qty > 0 && lvl.head) {
-          auto* maker = lvl.head;
-
-          // ---- STP
-          if (self_trade_block(maker, taker_qty, lvl, bids_total_)) {
-            if (taker_qty == 0) break;
-            if (!lvl.head) break;
-            continue;                       // skip trade, re-evaluate
-          }
+        on_fill(MatchFill{ id, maker_id, level_px, traded });
+        ++out.fill_count; out.filled_qty += traded;
 
-          // ---- Trade
-          Qty traded = (taker_qty < maker->qty) ? taker_qty : maker->qty;
-          maker->qty -= traded;
-          taker_qty  -= traded;
-          lvl.total_qty -= traded;
-          bids_total_   -= traded;
-
-          out.fills.push_back(MatchFill{ id, maker->id, best_bid, traded });
-
-          if (maker->qty == 0) {
-            auto* dead = maker;
-            lvl.head = maker->next;
-            if (lvl.head) lvl.head->prev = nullptr; else lvl.tail = nullptr;
-            lvl.count--;
-            id_index_.erase(dead->id);
-            owners_.erase(dead->id);
-            delete dead;
-            out.book_changed = true;
-          }
+        if (lvl.fill_front(traded) == 0) {
+          pop_front_dead(lvl);
+          out.book_changed = true;
         }
-        if (!lvl.head) { bids_.erase(bids_.begin()); out.book_changed = true; }
       }
+      depth_add<O>(level_px, lvl.total_qty - level_before);  // one update per level
+      if (lvl.total_qty != level_before) note_level<O>(level_px, lvl.total_qty);
+      if (lvl.empty()) { makers.erase(level_px); out.book_changed = true; }
+      else break; // taker exhausted/dropped with liquidity left at this level
+    }
 
-      // IOC or Market: drop remainder (no post)
-      if (tif == TimeInForce::IOC || type == OrderType::Market) return out;
-
+    // IOC or Market: drop remainder (no post)
+    if constexpr (T == OrderType::Market || F == TimeInForce::IOC) {
+      return out;
+    } else {
       // Post remainder if limit + Day
-      if (taker_qty > 0 && type == OrderType::Limit) {
-        auto &lvl = asks_[px];
-        auto* n = new OrderNode{ .id=id, .side=side, .px=px, .qty=taker_qty,
-                                 .prev=lvl.tail, .next=nullptr };
-        if (lvl.tail) lvl.tail->next = n; else lvl.head = n;
-        lvl.tail = n; lvl.count++; lvl.total_qty += taker_qty;
-        id_index_[id] = n;
-        owners_[id]   = trader;
-        asks_total_  += taker_qty;
+      if (taker_qty > 0) {
+        auto* n = pool_.make({ .id=id, .side=S, .px=px, .qty=taker_qty });
+        auto& lvl = ladder<S>().get_or_add(px);
+        lvl.push_back(n);
+        id_index_.insert(id, n, trader);
+        side_total<S>() += taker_qty;
+        depth_add<S>(px, taker_qty);
+        note_level<S>(px, lvl.total_qty);
         out.posted_qty = taker_qty;
         out.book_changed = true;
       }
+      return out;
     }
-
-    return out;
   }
 
   // ---------- legacy submit wrapper (kept for compatibility) ----------
@@ -359,46 +420,15 @@ struct Book {
 
   struct CancelResult { bool ok; Qty qty_canceled; Price px; Side side; };
 
-  // NOTE: explicit branching (no ternary) to avoid mixing map types.
   CancelResult cancel(OrderId id) {
-    auto it = id_index_.find(id);
-    if (it == id_index_.end()) return {false, 0, 0, Side::Bid};
-
-    auto* n = it->second;
-    if (n->side == Side::Bid) {
-      auto lvl_it = bids_.find(n->px);
-      if (lvl_it == bids_.end()) return {false, 0, 0, Side::Bid};
-      auto& lvl = lvl_it->second;
-
-      if (n->prev) n->prev->next = n->next; else lvl.head = n->next;
-      if (n->next) n->next->prev = n->prev; else lvl.tail = n->prev;
-
-      lvl.count--;
-      lvl.total_qty -= n->qty;
-      bids_total_   -= n->qty;
-
-      Qty canceled = n->qty; Price px = n->px; Side s = n->side;
-      id_index_.erase(it); owners_.erase(id); delete n;
-      if (lvl.count == 0) bids_.erase(lvl_it);
-      return {true, canceled, px, s};
-
-    } else { // Side::Ask
-      auto lvl_it = asks_.find(n->px);
-      if (lvl_it == asks_.end()) return {false, 0, 0, Side::Bid};
-      auto& lvl = lvl_it->second;
-
-      if (n->prev) n->prev->next = n->next; else lvl.head = n->next;
-      if (n->next) n->next->prev = n->prev; else lvl.tail = n->prev;
-
-      lvl.count--;
-      lvl.total_qty -= n->qty;
-      asks_total_   -= n->qty;
-
-      Qty canceled = n->qty; Price px = n->px; Side s = n->side;
-      id_index_.erase(it); owners_.erase(id); delete n;
-      if (lvl.count == 0) asks_.erase(lvl_it);
-      return {true, canceled, px, s};
-    }
+    auto* e = id_index_.find(id);
+    if (!e) return {false, 0, 0, Side::Bid};
+    return cancel_entry(e);
+  }
+
+  // Unlink + free the order behind an index slot (slot is consumed).
+  CancelResult cancel_entry(OrderIndex::Slot* e) {
+    return e->node->side == Side::Bid ? cancel_on<Side::Bid>(e) : cancel_on<Side::Ask>(e);
   }
 
   // ---------- Day 6: Replace/Amend ----------
@@ -406,13 +436,19 @@ struct Book {
 
   ReplaceResult replace(std::uint64_t trader, OrderId id, Price new_px, Qty new_qty,
                         TimeInForce tif = TimeInForce::Day) {
-    auto it = id_index_.find(id);
-    if (it == id_index_.end()) return {false, id};
-    OrderNode* n = it->second;
+    return replace(trader, id, new_px, new_qty, tif, NoFillSink{});
+  }
+
+  // A price change / size increase re-enters matching; its fills go to on_fill.
+  template<typename FillSink>
+  ReplaceResult replace(std::uint64_t trader, OrderId id, Price new_px, Qty new_qty,
+                        TimeInForce tif, FillSink&& on_fill) {
+    auto* e = id_index_.find(id);
+    if (!e) return {false, id};
+    OrderNode* n = e->node;
 
     // simple ownership: if known owner and doesn't match trader, reject
-    auto io = owners_.find(id);
-    std::uint64_t owner = (io == owners_.end()) ? 0 : io->second;
+    std::uint64_t owner = e->owner;
     if (owner != 0 && owner != trader) return {false, id};
 
     if (new_qty <= 0) return {false, id};
@@ -421,32 +457,191 @@ struct Book {
     if (new_px == n->px && new_qty <= n->qty) {
       Qty delta = n->qty - new_qty;
       if (delta > 0) {
-        if (n->side == Side::Bid) {
-          auto lvl_it = bids_.find(n->px); if (lvl_it==bids_.end()) return {false, id};
-          auto& lvl = lvl_it->second;
-          bool remains = lvl.reduce(n, delta); (void)remains; // should remain
-          bids_total_ -= delta;
-        } else {
-          auto lvl_it = asks_.find(n->px); if (lvl_it==asks_.end()) return {false, id};
-          auto& lvl = lvl_it->second;
-          bool remains = lvl.reduce(n, delta); (void)remains;
-          asks_total_ -= delta;
-        }
+        bool ok = n->side == Side::Bid ? shrink_on<Side::Bid>(n, delta)
+                                       : shrink_on<Side::Ask>(n, delta);
+        if (!ok) return {false, id};
       }
       return {true, id};
     }
 
     // Otherwise: cancel then submit fresh (new priority; obey IOC/FOK)
-    auto c = cancel(id);
+    auto c = cancel_entry(e);
     if (!c.ok) return {false, id};
-    auto r = submit(trader, c.side, new_px, new_qty, id, OrderType::Limit, tif);
+    auto r = submit(trader, c.side, new_px, new_qty, id, OrderType::Limit, tif,
+                    std::forward<FillSink>(on_fill));
 
     // If FOK and nothing happened, treat as failure
     bool ok = (tif == TimeInForce::FOK)
-              ? (!r.fills.empty() || r.posted_qty > 0)
+              ? (r.fill_count > 0 || r.posted_qty > 0)
               : true;
     return {ok, id};
   }
+
+  // ---------- side-specialized helpers ----------
+  template<Side S>
+  static constexpr Side opposite = (S == Side::Bid) ? Side::Ask : Side::Bid;
+
+  // Can a taker on side S with limit `limit` trade at a maker level `level_px`?
+  template<Side S>
+  static constexpr bool crosses(Price limit, Price level_px) {
+    if constexpr (S == Side::Bid) return limit >= level_px;
+    else                          return limit <= level_px;
+  }
+
+  template<Side S>
+  Ladder<S>& ladder() {
+    if constexpr (S == Side::Bid) return bids_; else return asks_;
+  }
+  template<Side S>
+  const Ladder<S>& ladder() const {
+    if constexpr (S == Side::Bid) return bids_; else return asks_;
+  }
+
+  template<Side S>
+  Qty& side_total() {
+    if constexpr (S == Side::Bid) return bids_total_; else return asks_total_;
+  }
+
+  template<Side S>
+  const DepthTree<S>& depth() const {
+    if constexpr (S == Side::Bid) return bid_depth_; else return ask_depth_;
+  }
+
+  static constexpr Qty kNoLimit = std::numeric_limits<Qty>::max();
+
+private:
+  template<Side S>
+  DepthTree<S>& depth() {
+    if constexpr (S == Side::Bid) return bid_depth_; else return ask_depth_;
+  }
+
+  template<Side S>
+  void note_level(Price px, Qty level_qty) {
+    if (cfg_.l2_deltas) deltas_.push_back(LevelDelta{S, px, level_qty});
+  }
+
+  // Mirror a level qty change into the depth tree. Call after the ladder
+  // reflects it: an uncovered price rebuilds the tree from the ladder.
+  // Never throws, so it cannot leave the book half-updated.
+  template<Side S>
+  void depth_add(Price px, Qty dq) {
+    if (!cfg_.depth_tree || dq == 0) return;
+    auto& d = depth<S>();
+    if (d.covers(px)) [[likely]] d.add(px, dq);
+    else if (d.active()) d.rebuild(ladder<S>(), px);
+    else d.add_untracked(dq);
+  }
+
+  template<Side S>
+  bool add_on(OrderId id, Price px, Qty qty, TimeNs ts_ns) {
+    if (auto* o = ladder<opposite<S>>().best(); o && crosses<S>(px, o->price))
+      return false; // would lock/cross
+    OrderNode* n = pool_.make({ .id=id, .side=S, .px=px, .qty=qty, .ts_ns=ts_ns });
+    auto& lvl = ladder<S>().get_or_add(px);
+    lvl.push_back(n);
+    id_index_.insert(id, n, 0); // unknown owner in non-matching mode
+    side_total<S>() += qty;
+    depth_add<S>(px, qty);
+    note_level<S>(px, lvl.total_qty);
+    return true;
+  }
+
+  template<Side S>
+  void restore_level_on(Price px, const RestingOrder* o, std::size_t n) {
+    PriceLevel& lvl = ladder<S>().get_or_add(px);
+    Qty sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      OrderNode* nd = pool_.make({ .id=o[i].id, .side=S, .px=px, .qty=o[i].qty, .ts_ns=o[i].ts_ns });
+      lvl.push_back(nd);
+      id_index_.insert(o[i].id, nd, o[i].owner);
+      sum += o[i].qty;
+    }
+    side_total<S>() += sum;
+  }
+
+  template<Side S>
+  bool reduce_on(OrderIndex::Slot* e, Qty dq) {
+    OrderNode* n = e->node;
+    auto* lvl_p = ladder<S>().find(n->px); if (!lvl_p) return false;
+    auto& lvl = *lvl_p;
+    bool remains = lvl.reduce(n, dq);
+    side_total<S>() -= dq;
+    depth_add<S>(n->px, -dq);
+    note_level<S>(lvl.price, lvl.total_qty);
+    if (!remains) {
+      lvl.erase(n); pool_.destroy(n); id_index_.erase(e);
+      if (lvl.empty()) ladder<S>().erase(lvl.price);
+    }
+    return true;
+  }
+
+  // In-place size decrease that keeps the order (and its priority) alive.
+  template<Side S>
+  bool shrink_on(OrderNode* n, Qty dq) {
+    auto* lvl_p = ladder<S>().find(n->px); if (!lvl_p) return false;
+    bool remains = lvl_p->reduce(n, dq); (void)remains; // should remain
+    side_total<S>() -= dq;
+    depth_add<S>(n->px, -dq);
+    note_level<S>(n->px, lvl_p->total_qty);
+    return true;
+  }
+
+  template<Side S>
+  CancelResult cancel_on(OrderIndex::Slot* e) {
+    auto* n = e->node;
+    auto* lvl_p = ladder<S>().find(n->px);
+    if (!lvl_p) return {false, 0, 0, Side::Bid};
+    auto& lvl = *lvl_p;
+
+    Qty canceled = n->qty; Price px = n->px;
+    lvl.erase(n);                 // O(1): list unlink or ring tombstone
+    side_total<S>() -= canceled;
+    depth_add<S>(px, -canceled);
+    note_level<S>(px, lvl.total_qty);
+
+    id_index_.erase(e); pool_.destroy(n);
+    if (lvl.empty()) ladder<S>().erase(px);
+    return {true, canceled, px, S};
+  }
+
+  // Drop a fully consumed head order from its level.
+  void pop_front_dead(PriceLevel& lvl) {
+    id_index_.erase(lvl.front_id());
+    pool_.destroy(lvl.pop_front());
+  }
+
+  // Self-trade prevention for the maker at the head of lvl.
+  // Returns true if STP handled this maker (no trade this iteration).
+  bool self_trade_block(std::uint64_t trader, OrderNode* maker, Qty& taker_qty,
+                        PriceLevel& lvl, Qty& side_total, SubmitResult& out) {
+    // maker owner from the id index; if missing, treat 0
+    auto* me = id_index_.find(maker->id);
+    std::uint64_t maker_owner = me ? me->owner : 0;
+    if (maker_owner != trader) return false;
+
+    Qty overlap = (taker_qty < maker->qty) ? taker_qty : maker->qty;
+    switch (cfg_.stp) {
+      case STPPolicy::CancelTaker:
+        taker_qty -= overlap;               // drop incoming overlap
+        out.book_changed = true;
+        break;
+      case STPPolicy::CancelMaker:
+        lvl.reduce(maker, overlap);         // reduce resting
+        side_total -= overlap;
+        if (maker->qty == 0) { pop_front_dead(lvl); out.book_changed = true; }
+        // Drop the taker so it doesn't keep canceling more
+        taker_qty = 0;
+        break;
+      case STPPolicy::CancelBoth:
+        taker_qty   -= overlap;
+        lvl.reduce(maker, overlap);
+        side_total -= overlap;
+        if (maker->qty == 0) { pop_front_dead(lvl); out.book_changed = true; }
+        break;
+      default: break;
+    }
+    return true; // handled STP; do not trade this iteration
+  }
 };
 
 } // namespace lob
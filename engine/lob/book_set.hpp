@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "types.hpp"
+#include "book.hpp"
+
+namespace lob {
+
+// Books for many instruments in one contiguous array, addressed by dense
+// SymbolId (0..size()-1): routing a command is an index, not a lookup.
+// Name <-> id resolution is for the control plane (symbol setup, gateways).
+// add() may grow the array and move books: don't hold a Book& across it
+// (orders, levels and fills are unaffected).
+class BookSet {
+public:
+  explicit BookSet(Book::BookConfig cfg = {}) : cfg_(cfg) {}
+
+  void reserve(std::size_t n) { books_.reserve(n); names_.reserve(n); ids_.reserve(n); }
+
+  // Register a symbol (idempotent) with the default or its own config.
+  SymbolId add(std::string_view symbol) { return add(symbol, cfg_); }
+  SymbolId add(std::string_view symbol, const Book::BookConfig& cfg) {
+    std::string key(symbol);
+    if (auto it = ids_.find(key); it != ids_.end()) return it->second;
+    const SymbolId id = SymbolId(books_.size());
+    books_.emplace_back(cfg);
+    names_.push_back(key);
+    ids_.emplace(std::move(key), id);
+    return id;
+  }
+
+  std::optional<SymbolId> find(std::string_view symbol) const {
+    auto it = ids_.find(std::string(symbol));
+    if (it == ids_.end()) return std::nullopt;
+    return it->second;
+  }
+
+  // Config for symbols added without one.
+  const Book::BookConfig& config() const { return cfg_; }
+  void set_config(const Book::BookConfig& cfg) { cfg_ = cfg; }
+
+  bool contains(SymbolId id) const { return id < books_.size(); }
+  const std::string& name(SymbolId id) const { return names_[id]; }
+
+  Book& operator[](SymbolId id) { return books_[id]; }
+  const Book& operator[](SymbolId id) const { return books_[id]; }
+
+  std::size_t size() const { return books_.size(); }
+  bool empty() const { return books_.empty(); }
+
+  auto begin() { return books_.begin(); }
+  auto end() { return books_.end(); }
+  auto begin() const { return books_.begin(); }
+  auto end() const { return books_.end(); }
+
+private:
+  Book::BookConfig cfg_;
+  std::vector<Book> books_;                         // indexed by SymbolId
+  std::vector<std::string> names_;                  // SymbolId -> name
+  std::unordered_map<std::string, SymbolId> ids_;   // name -> SymbolId
+};
+
+} // namespace lob
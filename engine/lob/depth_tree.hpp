@@ -0,0 +1,175 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "types.hpp"
+#include "price_level.hpp"
+#include "ladder.hpp"
+
+namespace lob {
+
+// Cumulative depth for one side: a Fenwick tree over a window of ticks,
+// keyed best-first (asks ascending, bids descending), holding qty and
+// notional (px*qty) per tick. Prefix sums give "liquidity at or better than
+// px" and a Fenwick descent finds how deep a sweep of q goes, both O(log n).
+// The window re-centres (and doubles if needed) from the ladder when a price
+// falls outside it, like the Flat ladder, up to max_ticks wide. A side that
+// spans more than that drops the tree (only total() is kept, and callers
+// answer queries from the ladder) until it empties again.
+template<Side S>
+class DepthTree {
+  using Window = Ladder<S>;
+
+public:
+  struct Sweep {
+    Qty qty{0};                 // fillable qty (< requested: side too thin)
+    std::int64_t notional{0};   // sum of px*qty over the fillable part
+    Price worst_px{0};          // deepest price touched (0 if nothing)
+  };
+
+  // Storage is allocated by the first rebuild(), so idle books stay small.
+  explicit DepthTree(std::size_t ticks = 1024, std::size_t max_ticks = Window::kDefaultMaxTicks)
+    : max_n_(std::bit_ceil(std::clamp(max_ticks, kMinTicks, Window::kMaxTicks))) {
+    n_ = std::min(std::bit_ceil(std::max(ticks, kMinTicks)), max_n_);
+  }
+
+  // False while the side is too wide for the tree; see add_untracked().
+  bool active() const { return !wide_; }
+
+  bool covers(Price px) const { return !tree_.empty() && !better(px, edge_) && offset(px) < n_; }
+
+  // Apply a qty change at a covered price.
+  void add(Price px, Qty dq) {
+    const std::int64_t dn = std::int64_t(px) * dq;
+    for (std::size_t i = offset(px) + 1; i <= n_; i += i & (~i + 1)) {
+      tree_[i].qty += dq;
+      tree_[i].notional += dn;
+    }
+    total_ += dq;
+  }
+
+  // Apply a qty change while inactive. The tree comes back (on the next
+  // rebuild) once the side is empty.
+  void add_untracked(Qty dq) {
+    total_ += dq;
+    if (total_ == 0) wide_ = false;
+  }
+
+  // Rebuild around the ladder's levels (which must already include any
+  // pending change) so that px is covered. O(window). Never throws: a range
+  // wider than max_ticks, or a window that cannot be allocated, leaves the
+  // tree inactive instead, so the book stays consistent mid-mutation.
+  template<typename LadderT>
+  void rebuild(const LadderT& ladder, Price px) {
+    Price lo = px, hi = px;
+    Qty total = 0;
+    ladder.walk([&](PriceLevel const& l){
+      lo = std::min(lo, l.price); hi = std::max(hi, l.price);
+      total += l.total_qty;
+      return true;
+    });
+    if (Window::distance(lo, hi) >= max_n_) return go_wide(total);
+    const std::size_t span = std::size_t(Window::distance(lo, hi)) + 1;
+    std::size_t w = n_;
+    while (w < 2 * span && w < max_n_) w <<= 1;
+
+    std::vector<Node> tree;
+    try { tree.assign(w + 1, Node{0, 0}); }
+    catch (const std::bad_alloc&) { return go_wide(total); }
+    const Price anchor = Window::anchor_for(lo, span, w);
+    const Price edge = S == Side::Ask ? anchor : Price(std::uint64_t(anchor) + (w - 1));
+    ladder.walk([&](PriceLevel const& l){
+      auto& node = tree[offset(l.price, edge) + 1];
+      node.qty += l.total_qty;
+      node.notional += std::int64_t(l.price) * l.total_qty;
+      return true;
+    });
+    for (std::size_t i = 1; i <= w; ++i) {            // O(n) Fenwick build
+      std::size_t p = i + (i & (~i + 1));
+      if (p <= w) { tree[p].qty += tree[i].qty; tree[p].notional += tree[i].notional; }
+    }
+    tree_.swap(tree);
+    n_ = w; edge_ = edge; total_ = total; wide_ = false;
+  }
+
+  Qty total() const { return total_; }
+
+  // Resting qty priced at px or better.
+  Qty qty_through(Price px) const {
+    if (tree_.empty() || better(px, edge_)) return 0;
+    const std::uint64_t i = offset(px);
+    if (i >= n_) return total_;
+    return prefix(std::size_t(i) + 1).qty;
+  }
+
+  // Qty resting exactly at px (for invariant checks).
+  Qty qty_at(Price px) const {
+    if (!covers(px)) return 0;
+    const std::size_t i = offset(px) + 1;
+    return prefix(i).qty - prefix(i - 1).qty;
+  }
+
+  // Walk q best-first: how much fills, at what notional, down to which price.
+  Sweep sweep(Qty q) const {
+    Sweep out;
+    if (q <= 0 || total_ == 0) return out;
+    if (q > total_) q = total_;
+    // Fenwick descent: largest prefix strictly below q; the remainder then
+    // fills at the next tick, which is the deepest one touched.
+    std::size_t pos = 0;
+    Qty acc = 0; std::int64_t notional = 0;
+    for (std::size_t step = n_; step; step >>= 1) {
+      std::size_t nx = pos + step;
+      if (nx <= n_ && acc + tree_[nx].qty < q) {
+        pos = nx; acc += tree_[nx].qty; notional += tree_[nx].notional;
+      }
+    }
+    out.worst_px = px_of(pos);
+    out.qty = q;
+    out.notional = notional + std::int64_t(out.worst_px) * (q - acc);
+    return out;
+  }
+
+  void clear() {
+    std::fill(tree_.begin(), tree_.end(), Node{0, 0});
+    total_ = 0; wide_ = false;
+  }
+
+private:
+  struct Node { Qty qty; std::int64_t notional; };
+  static constexpr std::size_t kMinTicks = 64;
+
+  // Index 0 is edge_, the window's best price; offsets grow away from the
+  // top of book and are taken in unsigned arithmetic (no negated prices).
+  static bool better(Price a, Price b) { return S == Side::Ask ? a < b : a > b; }
+  static std::uint64_t offset(Price px, Price edge) {
+    return S == Side::Ask ? Window::distance(edge, px) : Window::distance(px, edge);
+  }
+  std::uint64_t offset(Price px) const { return offset(px, edge_); }
+  Price px_of(std::size_t i) const {
+    return S == Side::Ask ? Price(std::uint64_t(edge_) + i) : Price(std::uint64_t(edge_) - i);
+  }
+
+  Node prefix(std::size_t i) const {
+    Node s{0, 0};
+    for (; i; i &= i - 1) { s.qty += tree_[i].qty; s.notional += tree_[i].notional; }
+    return s;
+  }
+
+  void go_wide(Qty total) {
+    std::vector<Node>().swap(tree_);
+    wide_ = true; total_ = total;
+  }
+
+  std::vector<Node> tree_;   // 1-based Fenwick nodes; empty before the first rebuild or while wide
+  std::size_t n_{0};         // window width (power of two)
+  std::size_t max_n_{0};     // widest window before going inactive
+  Price edge_{0};            // best price of the window (index 0)
+  Qty total_{0};
+  bool wide_{false};         // side spans more than max_n_ ticks: no tree
+};
+
+} // namespace lob
@@ -0,0 +1,347 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "types.hpp"
+#include "price_level.hpp"
+
+namespace lob {
+
+// Storage backend for one side's price levels.
+//  - Map : std::map keyed by price (node per level, O(log n) everything).
+//  - Flat: contiguous PriceLevel array indexed by tick offset from an anchor,
+//          plus a two-level occupancy bitmap for best/next-level discovery.
+//          The window re-centres (and doubles if needed) when a price falls
+//          outside it, so it suits instruments whose resting range spans a
+//          few thousand ticks. It never grows past flat_max_ticks: a wider
+//          resting range moves the side onto the Map backend until it empties,
+//          and an emptied side drops back to its initial window.
+enum class LadderKind : std::uint8_t { Map, Flat };
+
+inline constexpr const char* ladder_str(LadderKind k) {
+  return k == LadderKind::Flat ? "flat" : "map";
+}
+
+// Price levels for one side, iterated in priority order
+// (bids: highest first; asks: lowest first).
+template<Side S>
+class Ladder {
+  using Better = std::conditional_t<S == Side::Bid, std::greater<Price>, std::less<Price>>;
+  static constexpr std::size_t kMinTicks = 64;
+
+public:
+  static constexpr std::size_t kMaxTicks = std::size_t(1) << 40;   // hard cap on flat_max_ticks
+  static constexpr std::size_t kDefaultMaxTicks = std::size_t(1) << 16;
+
+  explicit Ladder(LadderKind kind = LadderKind::Map, std::size_t flat_ticks = 1024,
+                  LevelQueue queue = LevelQueue::List, std::size_t flat_max_ticks = kDefaultMaxTicks)
+    : kind_(kind), queue_(queue), flat_(kind == LadderKind::Flat) {
+    if (flat_) {
+      max_ticks_ = pow2_at_least(std::min(std::max(flat_max_ticks, kMinTicks), kMaxTicks));
+      base_ticks_ = std::min(pow2_at_least(std::max(flat_ticks, kMinTicks)), max_ticks_);
+      reset_window(base_ticks_, 0);
+    }
+  }
+
+  // Moves keep PriceLevel addresses (map nodes / slot buffer travel with
+  // the ladder); the source is left empty.
+  Ladder(Ladder&& o) noexcept
+    : kind_(o.kind_), queue_(o.queue_), flat_(o.flat_), map_(std::move(o.map_)), slots_(std::move(o.slots_)),
+      l0_(std::move(o.l0_)), l1_(std::move(o.l1_)), anchor_(o.anchor_),
+      levels_(std::exchange(o.levels_, 0)), base_ticks_(o.base_ticks_), max_ticks_(o.max_ticks_) { o.map_.clear(); }
+  Ladder& operator=(Ladder&& o) noexcept {
+    if (this != &o) {
+      kind_ = o.kind_; queue_ = o.queue_; flat_ = o.flat_;
+      map_ = std::move(o.map_); o.map_.clear();
+      slots_ = std::move(o.slots_); l0_ = std::move(o.l0_); l1_ = std::move(o.l1_);
+      anchor_ = o.anchor_; levels_ = std::exchange(o.levels_, 0);
+      base_ticks_ = o.base_ticks_; max_ticks_ = o.max_ticks_;
+    }
+    return *this;
+  }
+  Ladder(const Ladder&) = delete;
+  Ladder& operator=(const Ladder&) = delete;
+
+  // Backend in use now: a Flat ladder reports Map while it is on the fallback.
+  LadderKind kind() const { return kind_; }
+  std::size_t flat_window() const { return slots_.size(); }
+  LevelQueue queue() const { return queue_; }
+  bool empty() const { return size() == 0; }
+  std::size_t size() const { return kind_ == LadderKind::Flat ? levels_ : map_.size(); }
+
+  // Best level or nullptr.
+  PriceLevel* best() {
+    if (kind_ == LadderKind::Map) return map_.empty() ? nullptr : &map_.begin()->second;
+    if (!levels_) return nullptr;
+    return &slots_[S == Side::Bid ? last_set() : first_set()];
+  }
+  const PriceLevel* best() const { return const_cast<Ladder*>(this)->best(); }
+
+  PriceLevel* find(Price px) {
+    if (kind_ == LadderKind::Map) {
+      auto it = map_.find(px);
+      return it == map_.end() ? nullptr : &it->second;
+    }
+    if (!in_window(px)) return nullptr;
+    std::size_t i = index_of(px);
+    return test(i) ? &slots_[i] : nullptr;
+  }
+  const PriceLevel* find(Price px) const { return const_cast<Ladder*>(this)->find(px); }
+
+  // Level strictly worse than px in priority order, or nullptr.
+  PriceLevel* next(Price px) {
+    if (kind_ == LadderKind::Map) {
+      auto it = map_.upper_bound(px);
+      return it == map_.end() ? nullptr : &it->second;
+    }
+    if (!levels_) return nullptr;
+    if (S == Side::Bid) {
+      if (px <= anchor_) return nullptr;
+      std::size_t from = in_window(px) ? index_of(px) : slots_.size();
+      std::size_t i = prev_set(from);
+      return i == npos ? nullptr : &slots_[i];
+    } else {
+      if (px >= anchor_ + Price(slots_.size() - 1)) return nullptr;
+      std::size_t from = in_window(px) ? index_of(px) : npos; // npos+1 wraps to 0
+      std::size_t i = next_set(from);
+      return i == npos ? nullptr : &slots_[i];
+    }
+  }
+
+  // Existing level at px, or a new empty one. May re-centre the flat window
+  // or move the side onto the Map fallback, both of which move PriceLevels:
+  // pointers from earlier best()/find() are invalid.
+  PriceLevel& get_or_add(Price px) {
+    if (kind_ == LadderKind::Flat && !in_window(px)) [[unlikely]] recentre(px);
+    if (kind_ == LadderKind::Map) {
+      auto [it, fresh] = map_.try_emplace(px);
+      if (fresh) { it->second.price = px; it->second.queue = queue_; }
+      return it->second;
+    }
+    std::size_t i = index_of(px);
+    if (!test(i)) {
+      // Slots are reset, not destroyed, on erase: ring storage is reused.
+      slots_[i].price = px;
+      slots_[i].queue = queue_;
+      set(i); ++levels_;
+    }
+    return slots_[i];
+  }
+
+  // Remove the level at px (caller has already unlinked its orders). The
+  // last level out returns a grown or fallen-back Flat side to its initial
+  // window around px.
+  void erase(Price px) {
+    if (kind_ == LadderKind::Map) {
+      map_.erase(px);
+      if (flat_ && map_.empty()) [[unlikely]] { kind_ = LadderKind::Flat; shrink_window(px); }
+      return;
+    }
+    if (!in_window(px)) return;
+    std::size_t i = index_of(px);
+    if (!test(i)) return;
+    slots_[i].reset();
+    reset(i); --levels_;
+    if (!levels_ && slots_.size() > base_ticks_) [[unlikely]] shrink_window(px);
+  }
+
+  // f(PriceLevel&) for every level in priority order; stop early when f
+  // returns false.
+  template<typename F>
+  void walk(F&& f) {
+    if (kind_ == LadderKind::Map) {
+      for (auto& [_, lvl] : map_) if (!f(lvl)) return;
+      return;
+    }
+    for (PriceLevel* l = best(); l; l = next(l->price)) if (!f(*l)) return;
+  }
+  template<typename F>
+  void walk(F&& f) const {
+    const_cast<Ladder*>(this)->walk([&](PriceLevel& l){ return f(static_cast<const PriceLevel&>(l)); });
+  }
+
+  // Keeps the backend and window size in use.
+  void clear() {
+    map_.clear();
+    if (kind_ == LadderKind::Flat) reset_window(slots_.size(), anchor_);
+  }
+
+  // Backend self-consistency (bitmap vs levels, price vs slot).
+  void check_invariants(std::vector<std::string>& err) const {
+    if (kind_ == LadderKind::Map) return;
+    std::size_t seen = 0;
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+      bool occupied = test(i);
+      seen += occupied;
+      if (occupied && slots_[i].price != anchor_ + Price(i))
+        err.emplace_back("flat slot price mismatch @" + std::to_string(anchor_ + Price(i)));
+      if (!occupied && slots_[i].count != 0)
+        err.emplace_back("flat orders in unoccupied slot @" + std::to_string(anchor_ + Price(i)));
+      if (occupied && slots_[i].count == 0)
+        err.emplace_back("flat empty level not pruned @" + std::to_string(anchor_ + Price(i)));
+    }
+    for (std::size_t w = 0; w < l0_.size(); ++w)
+      if (bool(l0_[w]) != bool(l1_[w >> 6] & (1ULL << (w & 63))))
+        err.emplace_back("flat summary bitmap mismatch word=" + std::to_string(w));
+    if (seen != levels_) err.emplace_back("flat level count mismatch");
+  }
+
+  // ---- tick-window arithmetic (also used by DepthTree) ----
+  // Ticks from lo up to hi (lo <= hi), in unsigned arithmetic: the gap can
+  // exceed the range of Price.
+  static std::uint64_t distance(Price lo, Price hi) { return std::uint64_t(hi) - std::uint64_t(lo); }
+
+  // Anchor of a w-tick window holding [lo, lo + span), centred where the
+  // price range allows.
+  static Price anchor_for(Price lo, std::size_t span, std::size_t w) {
+    constexpr Price kLo = std::numeric_limits<Price>::min(), kHi = std::numeric_limits<Price>::max();
+    const std::size_t pad = (w - span) / 2;
+    if (distance(kLo, lo) < pad) return kLo;
+    const Price a = Price(std::uint64_t(lo) - pad);
+    return distance(a, kHi) < w - 1 ? Price(std::uint64_t(kHi) - (w - 1)) : a;
+  }
+
+private:
+  static constexpr std::size_t npos = ~std::size_t{0};
+
+  // ---- flat window ----
+  // Offsets are taken in unsigned arithmetic: px - anchor_ can exceed the
+  // range of Price when the two are far apart.
+  bool in_window(Price px) const { return px >= anchor_ && distance(anchor_, px) < slots_.size(); }
+  std::size_t index_of(Price px) const { return std::size_t(distance(anchor_, px)); }
+
+  static std::size_t pow2_at_least(std::size_t n) { return std::bit_ceil(n); }
+
+  void reset_window(std::size_t ticks, Price anchor) {
+    anchor_ = anchor;
+    slots_.assign(ticks, PriceLevel{});
+    l0_.assign(ticks / 64, 0);
+    l1_.assign((l0_.size() + 63) / 64, 0);
+    levels_ = 0;
+  }
+
+  // Move the window so px fits, centring the occupied range and doubling the
+  // width until it has at least 2x headroom (up to max_ticks_). A range
+  // wider than max_ticks_ moves the side onto the Map. O(window); rare.
+  void recentre(Price px) {
+    Price lo = px, hi = px;
+    if (levels_) {
+      lo = std::min(lo, anchor_ + Price(first_set()));
+      hi = std::max(hi, anchor_ + Price(last_set()));
+    }
+    if (distance(lo, hi) >= max_ticks_) { to_map(); return; }
+    const std::size_t span = std::size_t(distance(lo, hi)) + 1;
+    std::size_t w = slots_.size();
+    while (w < 2 * span && w < max_ticks_) w <<= 1;
+
+    std::vector<PriceLevel> old = std::move(slots_);
+    Price old_anchor = anchor_;
+    reset_window(w, anchor_for(lo, span, w));
+    for (std::size_t i = 0; i < old.size(); ++i) {
+      if (old[i].count == 0) continue;
+      std::size_t j = index_of(old_anchor + Price(i));
+      slots_[j] = std::move(old[i]);
+      slots_[j].for_each([&](OrderNode* n){ n->level = &slots_[j]; });
+      set(j); ++levels_;
+    }
+  }
+
+  // Every level into map_; the flat buffers are released.
+  void to_map() {
+    for (std::size_t i = first_set(); i != npos; i = next_set(i)) {
+      PriceLevel& lvl = map_[slots_[i].price];
+      lvl = std::move(slots_[i]);
+      lvl.for_each([&](OrderNode* n){ n->level = &lvl; });
+    }
+    kind_ = LadderKind::Map;
+    slots_ = {}; l0_ = {}; l1_ = {};
+    levels_ = 0;
+  }
+
+  // Back to the initial window around px, freeing a grown buffer. Empty
+  // sides only.
+  void shrink_window(Price px) {
+    slots_ = {}; l0_ = {}; l1_ = {};
+    reset_window(base_ticks_, anchor_for(px, 1, base_ticks_));
+  }
+
+  // ---- two-level bitmap ----
+  bool test(std::size_t i) const { return (l0_[i >> 6] >> (i & 63)) & 1ULL; }
+  void set(std::size_t i) {
+    l0_[i >> 6] |= 1ULL << (i & 63);
+    l1_[i >> 12] |= 1ULL << ((i >> 6) & 63);
+  }
+  void reset(std::size_t i) {
+    std::size_t w = i >> 6;
+    l0_[w] &= ~(1ULL << (i & 63));
+    if (!l0_[w]) l1_[w >> 6] &= ~(1ULL << (w & 63));
+  }
+
+  std::size_t first_set() const { return next_set(npos); }
+  std::size_t last_set() const { return prev_set(slots_.size()); }
+
+  // Lowest occupied index > i (i == npos means "from 0").
+  std::size_t next_set(std::size_t i) const {
+    std::size_t start = i + 1;
+    if (start >= slots_.size()) return npos;
+    std::size_t w = start >> 6;
+    std::uint64_t bits = l0_[w] & (~0ULL << (start & 63));
+    if (bits) return (w << 6) + std::countr_zero(bits);
+    // next non-empty l0 word via the summary
+    std::size_t sw = w + 1;
+    if (sw >= l0_.size()) return npos;
+    std::size_t s = sw >> 6;
+    std::uint64_t sbits = l1_[s] & (~0ULL << (sw & 63));
+    while (!sbits) {
+      if (++s >= l1_.size()) return npos;
+      sbits = l1_[s];
+    }
+    w = (s << 6) + std::countr_zero(sbits);
+    return (w << 6) + std::countr_zero(l0_[w]);
+  }
+
+  // Highest occupied index < i.
+  std::size_t prev_set(std::size_t i) const {
+    if (i == 0) return npos;
+    std::size_t end = i - 1;
+    std::size_t w = end >> 6;
+    std::uint64_t bits = l0_[w] & (~0ULL >> (63 - (end & 63)));
+    if (bits) return (w << 6) + 63 - std::countl_zero(bits);
+    if (w == 0) return npos;
+    std::size_t sw = w - 1;
+    std::size_t s = sw >> 6;
+    std::uint64_t sbits = l1_[s] & (~0ULL >> (63 - (sw & 63)));
+    while (!sbits) {
+      if (s == 0) return npos;
+      sbits = l1_[--s];
+    }
+    w = (s << 6) + 63 - std::countl_zero(sbits);
+    return (w << 6) + 63 - std::countl_zero(l0_[w]);
+  }
+
+  LadderKind kind_;
+  LevelQueue queue_;
+  bool flat_{false};                // configured Flat (kind_ is Map on the fallback)
+
+  // Map backend
+  std::map<Price, PriceLevel, Better> map_;
+
+  // Flat backend
+  std::vector<PriceLevel> slots_;
+  std::vector<std::uint64_t> l0_;   // bit per tick
+  std::vector<std::uint64_t> l1_;   // bit per non-empty l0 word
+  Price anchor_{0};                 // price of slots_[0]
+  std::size_t levels_{0};
+  std::size_t base_ticks_{0};       // initial window, restored when the side empties
+  std::size_t max_ticks_{0};        // widest window before the Map fallback
+};
+
+} // namespace lob
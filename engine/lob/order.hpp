@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include "types.hpp"
 
 namespace lob {
@@ -8,6 +9,7 @@ struct PriceLevel; // fwd
 struct OrderNode {
   OrderId id{};
   Side    side{};
+  std::uint32_t qpos{0}; // index in the level ring (LevelQueue::Ring)
   Price   px{};
   Qty     qty{};     // leaves
   TimeNs  ts_ns{};   // arrival (audits/tests)
@@ -0,0 +1,165 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "types.hpp"
+#include "order.hpp"
+
+namespace lob {
+
+// OrderId -> (OrderNode*, owner) in one flat open-addressing table.
+// - Robin-hood probing: every slot stores its probe length, lookups stop as
+//   soon as they pass a "richer" slot, so misses are short too.
+// - Backward-shift deletion: no tombstones, the table never degrades under
+//   cancel-heavy flow.
+// - Block-wise Fibonacci hashing: locality for sequential ids, spread for
+//   everything else (see home()).
+// Slot pointers are invalidated by insert() and erase(); don't hold them
+// across mutations.
+class OrderIndex {
+public:
+  struct Slot {
+    OrderId        id{};
+    OrderNode*     node{nullptr};
+    TraderId       owner{0};     // 0 = unknown owner
+    std::uint32_t  psl{0};       // probe length + 1; 0 = empty
+  };
+
+  explicit OrderIndex(std::size_t expected = 0) { rehash(capacity_for(expected)); }
+
+  // A moved-from index is empty and stays usable: find() misses and the
+  // first insert() reallocates kMinCapacity slots.
+  OrderIndex(const OrderIndex&) = default;
+  OrderIndex& operator=(const OrderIndex&) = default;
+  OrderIndex(OrderIndex&& o) noexcept
+    : slots_(std::move(o.slots_)), mask_(o.mask_), shift_(o.shift_), size_(o.size_) {
+    o.release();
+  }
+  OrderIndex& operator=(OrderIndex&& o) noexcept {
+    if (this != &o) {
+      slots_ = std::move(o.slots_);
+      mask_ = o.mask_; shift_ = o.shift_; size_ = o.size_;
+      o.release();
+    }
+    return *this;
+  }
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return slots_.size(); }
+  bool empty() const { return size_ == 0; }
+
+  // Pre-size so `n` live orders never trigger a rehash.
+  void reserve(std::size_t n) {
+    std::size_t cap = capacity_for(n);
+    if (cap > slots_.size()) rehash(cap);
+  }
+
+  Slot* find(OrderId id) {
+    if (slots_.empty()) [[unlikely]] return nullptr;   // moved-from
+    std::size_t i = home(id);
+    for (std::uint32_t psl = 1;; ++psl, i = (i + 1) & mask_) {
+      Slot& s = slots_[i];
+      if (s.psl < psl) return nullptr;          // empty, or would have been placed earlier
+      if (s.id == id) return &s;
+    }
+  }
+  const Slot* find(OrderId id) const { return const_cast<OrderIndex*>(this)->find(id); }
+
+  // Insert or overwrite; returns the slot now holding `id`.
+  Slot* insert(OrderId id, OrderNode* node, TraderId owner) {
+    if ((size_ + 1) * 8 > slots_.size() * 7) [[unlikely]] rehash(grown_capacity());
+    Slot cur{id, node, owner, 1};
+    Slot* placed = nullptr;
+    std::size_t i = home(id);
+    for (;; i = (i + 1) & mask_) {
+      Slot& s = slots_[i];
+      if (s.psl == 0) {
+        s = cur; ++size_;
+        return placed ? placed : &s;
+      }
+      if (!placed && s.id == id) {              // existing key (only before first swap)
+        s.node = node; s.owner = owner;
+        return &s;
+      }
+      if (s.psl < cur.psl) {                     // steal from the rich
+        std::swap(s, cur);
+        if (!placed) placed = &s;
+      }
+      ++cur.psl;
+    }
+  }
+
+  // Remove the slot returned by find() (no second probe).
+  void erase(Slot* s) {
+    std::size_t i = std::size_t(s - slots_.data());
+    std::size_t j = (i + 1) & mask_;
+    while (slots_[j].psl > 1) {                  // shift the cluster back by one
+      slots_[i] = slots_[j];
+      --slots_[i].psl;
+      i = j; j = (j + 1) & mask_;
+    }
+    slots_[i] = Slot{};
+    --size_;
+  }
+
+  bool erase(OrderId id) {
+    Slot* s = find(id);
+    if (!s) return false;
+    erase(s);
+    return true;
+  }
+
+  void clear() {
+    for (auto& s : slots_) s = Slot{};
+    size_ = 0;
+  }
+
+  // f(const Slot&) for every live entry (unordered).
+  template<typename F>
+  void for_each(F&& f) const {
+    for (auto const& s : slots_) if (s.psl) f(s);
+  }
+
+private:
+  static constexpr std::size_t kMinCapacity = 16;
+
+  std::size_t grown_capacity() const {
+    return slots_.empty() ? kMinCapacity : slots_.size() * 2;
+  }
+
+  static std::size_t capacity_for(std::size_t n) {
+    std::size_t need = n + n / 7 + 1;           // keep load <= 7/8
+    return std::bit_ceil(need < kMinCapacity ? kMinCapacity : need);
+  }
+
+  // Fibonacci-hash blocks of 16 ids and keep ids in order inside a block:
+  // sequentially issued ids share cache lines (exchange ids mostly are),
+  // while unrelated id ranges still spread over the whole table.
+  std::size_t home(OrderId id) const {
+    std::size_t block = std::size_t(((id >> 4) * 0x9E3779B97F4A7C15ULL) >> shift_);
+    return ((block << 4) | std::size_t(id & 15)) & mask_;
+  }
+
+  void rehash(std::size_t cap) {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(cap, Slot{});
+    mask_ = cap - 1;
+    shift_ = 64 - std::countr_zero(cap);
+    size_ = 0;
+    for (auto const& s : old) if (s.psl) insert(s.id, s.node, s.owner);
+  }
+
+  void release() noexcept {
+    std::vector<Slot>().swap(slots_);
+    mask_ = 0; shift_ = 64; size_ = 0;
+  }
+
+  std::vector<Slot> slots_;
+  std::size_t mask_{0};
+  int shift_{64};
+  std::size_t size_{0};
+};
+
+} // namespace lob
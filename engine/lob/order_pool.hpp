@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+#include "order.hpp"
+
+namespace lob {
+
+struct PoolStats {
+  std::size_t capacity{0};     // nodes carved out of slabs so far
+  std::size_t in_use{0};       // nodes currently handed out
+  std::size_t high_water{0};   // max in_use ever observed
+  std::size_t slabs{0};
+};
+
+// Per-book slab allocator for OrderNode.
+// - Slabs are cache-line aligned blocks of `slab_nodes` nodes, never returned
+//   to the system until the pool dies (no malloc/trim on the matching thread).
+// - Free nodes are threaded through OrderNode::next (intrusive freelist).
+// - Define LOB_HEAP_ORDER_NODES to fall back to plain new/delete (benchmarks).
+class OrderPool {
+public:
+  static constexpr std::size_t kDefaultSlabNodes = 1024; // 64 KiB per slab
+  static constexpr std::align_val_t kSlabAlign{64};
+
+  explicit OrderPool(std::size_t slab_nodes = kDefaultSlabNodes)
+    : slab_nodes_(slab_nodes ? slab_nodes : 1) {}
+
+  ~OrderPool() { release(); }
+
+  OrderPool(const OrderPool&) = delete;
+  OrderPool& operator=(const OrderPool&) = delete;
+
+  OrderPool(OrderPool&& o) noexcept
+    : slab_nodes_(o.slab_nodes_), slabs_(std::move(o.slabs_)),
+      free_(std::exchange(o.free_, nullptr)), stats_(std::exchange(o.stats_, {})) {
+    o.slabs_.clear();
+  }
+
+  OrderPool& operator=(OrderPool&& o) noexcept {
+    if (this != &o) {
+      release();
+      slab_nodes_ = o.slab_nodes_;
+      slabs_ = std::move(o.slabs_); o.slabs_.clear();
+      free_  = std::exchange(o.free_, nullptr);
+      stats_ = std::exchange(o.stats_, {});
+    }
+    return *this;
+  }
+
+  // Grow until at least n nodes exist in total (pre-sizing at startup).
+  void reserve(std::size_t n) {
+    while (stats_.capacity < n) add_slab();
+  }
+
+  // Touch every page of every slab so first use never page-faults.
+  void prefault() {
+    for (auto* s : slabs_) {
+      auto* bytes = reinterpret_cast<volatile unsigned char*>(s);
+      for (std::size_t off = 0; off < slab_bytes(); off += 4096) bytes[off] = bytes[off];
+    }
+  }
+
+  OrderNode* make(const OrderNode& init) {
+    ++stats_.in_use;
+    if (stats_.in_use > stats_.high_water) stats_.high_water = stats_.in_use;
+#ifdef LOB_HEAP_ORDER_NODES
+    return new OrderNode(init);
+#else
+    if (!free_) [[unlikely]] add_slab();
+    OrderNode* n = free_;
+    free_ = n->next;
+    return new (n) OrderNode(init);
+#endif
+  }
+
+  void destroy(OrderNode* n) {
+    --stats_.in_use;
+#ifdef LOB_HEAP_ORDER_NODES
+    delete n;
+#else
+    n->next = free_;
+    free_ = n;
+#endif
+  }
+
+  const PoolStats& stats() const { return stats_; }
+
+private:
+  std::size_t slab_bytes() const { return slab_nodes_ * sizeof(OrderNode); }
+
+  void add_slab() {
+    auto* s = static_cast<OrderNode*>(::operator new(slab_bytes(), kSlabAlign));
+    slabs_.push_back(s);
+    // Link in address order so consecutive allocations stay sequential.
+    for (std::size_t i = 0; i + 1 < slab_nodes_; ++i) s[i].next = &s[i + 1];
+    s[slab_nodes_ - 1].next = free_;
+    free_ = s;
+    stats_.capacity += slab_nodes_;
+    ++stats_.slabs;
+  }
+
+  void release() {
+    for (auto* s : slabs_) ::operator delete(s, kSlabAlign);
+    slabs_.clear();
+    free_ = nullptr;
+  }
+
+  std::size_t slab_nodes_;
+  std::vector<OrderNode*> slabs_;
+  OrderNode* free_{nullptr};
+  PoolStats stats_{};
+};
+
+} // namespace lob
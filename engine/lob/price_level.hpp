@@ -1,40 +1,215 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
 #include "types.hpp"
 #include "order.hpp"
 
 namespace lob {
 
+// FIFO storage for the orders of one level.
+//  - List: intrusive prev/next links through the OrderNodes.
+//  - Ring: contiguous ring of {node, id, qty} entries. A sweep reads only the
+//          ring (no pointer chasing); a cancel leaves a tombstone that is
+//          skipped once it reaches either end and squeezed out by compact()
+//          when tombstones outnumber live orders. OrderNode::qpos is the ring
+//          index, so cancel stays O(1) from the id index.
+enum class LevelQueue : std::uint8_t { List, Ring };
+
+inline constexpr const char* level_queue_str(LevelQueue q) {
+  return q == LevelQueue::Ring ? "ring" : "list";
+}
+
 struct PriceLevel {
+  // Ring entry; node == nullptr marks a tombstone. For live entries
+  // qty == node->qty after every operation.
+  struct Entry { OrderNode* node; OrderId id; Qty qty; };
+
   Price price{};
   Qty   total_qty{0};
   std::size_t count{0};
-  OrderNode* head{nullptr};
-  OrderNode* tail{nullptr};
+  OrderNode* head{nullptr};     // List only
+  OrderNode* tail{nullptr};     // List only
+  LevelQueue queue{LevelQueue::List};
+
+  // Ring only: capacity is a power of two; rhead/rtail run freely and are
+  // masked on access. Invariant: when non-empty, ring[rhead] and
+  // ring[rtail-1] are live.
+  std::vector<Entry> ring;
+  std::uint32_t rhead{0}, rtail{0};
+  std::uint32_t tombs{0};
+
+  bool is_ring() const { return queue == LevelQueue::Ring; }
 
   void push_back(OrderNode* n) {
+    n->level = this;
+    ++count; total_qty += n->qty;
+    if (is_ring()) { ring_push(n); return; }
     n->prev = tail; n->next = nullptr;
     if (tail) tail->next = n; else head = n; // both tail and head = n if originally empt
-    tail = n; n->level = this;
-    ++count; total_qty += n->qty;
+    tail = n;
   }
 
   void erase(OrderNode* n) {
+    --count; total_qty -= n->qty;
+    n->level = nullptr;
+    if (is_ring()) {
+      ring[n->qpos] = Entry{nullptr, 0, 0};
+      ++tombs; trim();
+      if (tombs > kCompactMin && tombs > count) compact();
+      return;
+    }
     if (n->prev) n->prev->next = n->next; else head = n->next;
     if (n->next) n->next->prev = n->prev; else tail = n->prev;
-    n->prev = n->next = nullptr; n->level = nullptr;
-    --count; total_qty -= n->qty;
+    n->prev = n->next = nullptr;
   }
 
   // subtract dq from node & level; return true if order remains (>0)
   bool reduce(OrderNode* n, Qty dq) {
     assert(dq >= 0 && dq <= n->qty);
     n->qty -= dq; total_qty -= dq;
+    if (is_ring()) ring[n->qpos].qty = n->qty;
     return n->qty > 0;
   }
 
   bool empty() const { return count == 0; }
+
+  // ---- front-of-queue access for the matching loop (level non-empty) ----
+  OrderNode* front() const { return is_ring() ? front_entry().node : head; }
+  OrderId front_id() const { return is_ring() ? front_entry().id : head->id; }
+  Qty front_qty() const { return is_ring() ? front_entry().qty : head->qty; }
+
+  // Trade dq against the front order; returns its remaining qty. A Ring
+  // level only writes the node back on a partial fill.
+  Qty fill_front(Qty dq) {
+    total_qty -= dq;
+    if (!is_ring()) return head->qty -= dq;
+    Entry& e = ring[rhead & mask()];
+    e.qty -= dq;
+    if (e.qty) e.node->qty = e.qty;
+    return e.qty;
+  }
+
+  // Unlink the (fully consumed) front order and return it.
+  OrderNode* pop_front() {
+    --count;
+    if (is_ring()) {
+      Entry& e = ring[rhead & mask()];
+      OrderNode* n = e.node;
+      e = Entry{nullptr, 0, 0};
+      // Upcoming makers are known without chasing links: warm the node the
+      // pool will write when that one is freed.
+      if (rtail - rhead > kPrefetch)
+        if (OrderNode* ahead = ring[(rhead + kPrefetch) & mask()].node)
+          __builtin_prefetch(ahead, 1);
+      ++tombs; trim();
+      return n;
+    }
+    OrderNode* n = head;
+    head = n->next;
+    if (head) head->prev = nullptr; else tail = nullptr;
+    return n;
+  }
+
+  // f(OrderNode*) for every order in FIFO order; f may free the node.
+  template<typename F>
+  void for_each(F&& f) const {
+    if (is_ring()) {
+      for (std::uint32_t p = rhead; p != rtail; ++p)
+        if (OrderNode* n = ring[p & mask()].node) f(n);
+      return;
+    }
+    for (OrderNode* n = head; n; ) { OrderNode* nx = n->next; f(n); n = nx; }
+  }
+
+  // Drop every order reference; keeps ring capacity for reuse.
+  void reset() {
+    total_qty = 0; count = 0;
+    head = tail = nullptr;
+    rhead = rtail = tombs = 0;
+  }
+
+  // Queue-representation consistency (links, ring handles, mirrored qty).
+  void check_queue(std::vector<std::string>& err) const {
+    const std::string at = " @" + std::to_string(price);
+    if (!is_ring()) {
+      if ((count == 0) != (head == nullptr && tail == nullptr))
+        err.emplace_back("empty level head/tail mismatch" + at);
+      OrderNode* prev = nullptr;
+      for (auto* n = head; n; n = n->next) {
+        if (n->prev != prev) err.emplace_back("broken prev link" + at);
+        prev = n;
+      }
+      return;
+    }
+    std::uint32_t dead = 0;
+    for (std::uint32_t p = rhead; p != rtail; ++p) {
+      const Entry& e = ring[p & mask()];
+      if (!e.node) { ++dead; continue; }
+      if (e.node->qpos != (p & mask())) err.emplace_back("ring handle mismatch id=" + std::to_string(e.id));
+      if (e.node->id != e.id || e.node->qty != e.qty)
+        err.emplace_back("ring entry/node mismatch id=" + std::to_string(e.id));
+    }
+    if (dead != tombs) err.emplace_back("ring tombstone count mismatch" + at);
+    if (rtail - rhead != count + tombs) err.emplace_back("ring span mismatch" + at);
+    if (count && (!ring[rhead & mask()].node || !ring[(rtail - 1) & mask()].node))
+      err.emplace_back("ring end is a tombstone" + at);
+  }
+
+private:
+  static constexpr std::uint32_t kRingMin = 8;
+  static constexpr std::uint32_t kCompactMin = 8;   // don't bother below this
+  static constexpr std::uint32_t kPrefetch = 8;     // sweep look-ahead (entries)
+
+  std::uint32_t mask() const { return std::uint32_t(ring.size()) - 1; }
+  const Entry& front_entry() const { return ring[rhead & mask()]; }
+
+  void ring_push(OrderNode* n) {
+    if (rtail - rhead == ring.size()) [[unlikely]] {
+      if (tombs && tombs * 4 >= ring.size()) compact();
+      else grow();
+    }
+    const std::uint32_t i = rtail++ & mask();
+    ring[i] = Entry{n, n->id, n->qty};
+    n->qpos = i;
+  }
+
+  // Step the ends over tombstones so front()/back are always live.
+  void trim() {
+    while (rhead != rtail && !ring[rhead & mask()].node) { ++rhead; --tombs; }
+    while (rhead != rtail && !ring[(rtail - 1) & mask()].node) { --rtail; --tombs; }
+    if (rhead == rtail) rhead = rtail = 0;
+  }
+
+  // Slide live entries down over the tombstones, in place and in order.
+  void compact() {
+    std::uint32_t w = rhead;
+    for (std::uint32_t r = rhead; r != rtail; ++r) {
+      Entry e = ring[r & mask()];
+      if (!e.node) continue;
+      if (w != r) ring[w & mask()] = e;
+      e.node->qpos = w & mask();
+      ++w;
+    }
+    for (std::uint32_t p = w; p != rtail; ++p) ring[p & mask()] = Entry{nullptr, 0, 0};
+    rtail = w; tombs = 0;
+  }
+
+  // Double the capacity, re-laying live entries from index 0.
+  void grow() {
+    std::vector<Entry> next(ring.empty() ? kRingMin : ring.size() * 2, Entry{nullptr, 0, 0});
+    std::uint32_t w = 0;
+    for (std::uint32_t r = rhead; r != rtail; ++r) {
+      const Entry& e = ring[r & mask()];
+      if (!e.node) continue;
+      next[w] = e; e.node->qpos = w; ++w;
+    }
+    ring = std::move(next);
+    rhead = 0; rtail = w; tombs = 0;
+  }
 };
 
-} // namespace lob
\ No newline at end of file
+} // namespace lob
@@ -0,0 +1,280 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>      // std::rename
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "types.hpp"
+#include "book.hpp"
+#include "book_set.hpp"
+#include "../common/mmap_file.hpp"
+
+// Binary book snapshots in a memory-mapped file, for fast restart.
+//
+// Layout (native endianness, every record 8-byte aligned):
+//   FileHeader
+//   per book:  BookHeader, name (padded to 8),
+//              per side (bids then asks), per level best-first:
+//                LevelHeader, RestingOrder[count] in FIFO order
+//
+// save() writes "<path>.tmp", msyncs it and renames it over path, so a crash
+// never leaves a torn snapshot behind. load() restores in one sequential pass
+// with the node pool and id index pre-sized to the stored order count, then
+// rejects the file unless every book passes check_invariants().
+namespace lob::snapshot {
+
+inline constexpr char kMagic[8] = {'L', 'O', 'B', 'S', 'N', 'A', 'P', '\0'};
+inline constexpr std::uint32_t kVersion = 3;   // 2: BookHeader::flat_max_ticks, 3: FileHeader::journal_seq
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t books;
+  std::uint64_t bytes;          // whole file, for truncation checks
+  std::uint64_t journal_seq;    // last journal seq applied to these books (0: none)
+};
+
+struct BookHeader {
+  std::uint32_t name_len;
+  std::uint8_t stp, ladder, queue, depth_tree;
+  std::uint64_t flat_ticks;
+  std::uint64_t flat_max_ticks;
+  std::uint64_t orders;
+  std::uint32_t bid_levels, ask_levels;
+  Qty bids_total, asks_total;
+};
+
+struct LevelHeader {
+  Price px;
+  std::uint64_t count;
+  Qty total_qty;
+};
+
+using OrderRecord = Book::RestingOrder;
+
+static_assert(std::is_trivially_copyable_v<FileHeader> && sizeof(FileHeader) % 8 == 0);
+static_assert(std::is_trivially_copyable_v<BookHeader> && sizeof(BookHeader) % 8 == 0);
+static_assert(std::is_trivially_copyable_v<LevelHeader> && sizeof(LevelHeader) % 8 == 0);
+static_assert(std::is_trivially_copyable_v<OrderRecord> && sizeof(OrderRecord) == 32);
+
+namespace detail {
+
+constexpr std::size_t pad8(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+inline std::size_t book_bytes(const Book& b, std::size_t name_len) {
+  std::size_t levels = 0;
+  auto count = [&](PriceLevel const&){ ++levels; return true; };
+  b.bids_.walk(count); b.asks_.walk(count);
+  return sizeof(BookHeader) + pad8(name_len) + levels * sizeof(LevelHeader) +
+         b.id_index_.size() * sizeof(OrderRecord);
+}
+
+class Writer {
+public:
+  explicit Writer(std::byte* p) : p_(p) {}
+  template<typename T> void put(const T& v) { std::memcpy(p_, &v, sizeof(T)); p_ += sizeof(T); }
+  void put_bytes(const void* src, std::size_t n) {
+    std::memcpy(p_, src, n);
+    std::memset(p_ + n, 0, pad8(n) - n);
+    p_ += pad8(n);
+  }
+  std::byte* pos() { return p_; }
+private:
+  std::byte* p_;
+};
+
+class Reader {
+public:
+  Reader(const std::byte* p, std::size_t n) : p_(p), end_(p + n) {}
+  template<typename T> T get() {
+    T v; std::memcpy(&v, take(sizeof(T)), sizeof(T)); return v;
+  }
+  std::string_view get_name(std::size_t n) {
+    const std::byte* s = take(pad8(n));
+    return {reinterpret_cast<const char*>(s), n};
+  }
+  // Order records are read in place from the mapping (8-byte aligned).
+  const OrderRecord* get_orders(std::uint64_t n) {
+    if (n > std::size_t(end_ - p_) / sizeof(OrderRecord)) truncated();
+    return reinterpret_cast<const OrderRecord*>(take(std::size_t(n) * sizeof(OrderRecord)));
+  }
+  bool done() const { return p_ == end_; }
+private:
+  [[noreturn]] static void truncated() { throw std::runtime_error("snapshot: truncated file"); }
+  const std::byte* take(std::size_t n) {
+    if (n > std::size_t(end_ - p_)) truncated();
+    const std::byte* s = p_; p_ += n; return s;
+  }
+  const std::byte* p_;
+  const std::byte* end_;
+};
+
+template<Side S>
+void write_side(Writer& w, const Book& b) {
+  b.ladder<S>().walk([&](PriceLevel const& lvl){
+    w.put(LevelHeader{lvl.price, lvl.count, lvl.total_qty});
+    lvl.for_each([&](OrderNode* n){
+      const auto* e = b.id_index_.find(n->id);
+      w.put(OrderRecord{n->id, e ? e->owner : 0, n->qty, n->ts_ns});
+    });
+    return true;
+  });
+}
+
+inline void write_book(Writer& w, const Book& b, std::string_view name) {
+  std::uint32_t bid_levels = 0, ask_levels = 0;
+  b.bids_.walk([&](PriceLevel const&){ ++bid_levels; return true; });
+  b.asks_.walk([&](PriceLevel const&){ ++ask_levels; return true; });
+  const auto& c = b.cfg_;
+  w.put(BookHeader{
+    std::uint32_t(name.size()), std::uint8_t(c.stp), std::uint8_t(c.ladder),
+    std::uint8_t(c.queue), std::uint8_t(c.depth_tree), c.flat_ticks, c.flat_max_ticks,
+    b.id_index_.size(), bid_levels, ask_levels, b.bids_total_, b.asks_total_});
+  w.put_bytes(name.data(), name.size());
+  write_side<Side::Bid>(w, b);
+  write_side<Side::Ask>(w, b);
+}
+
+// Enum fields are checked against the enumerators this build knows: a
+// corrupt or newer file is rejected, not turned into a Book with an invalid
+// backend.
+inline Book::BookConfig config_of(const BookHeader& h, std::string_view name) {
+  auto check = [&](const char* field, std::uint8_t v, std::uint8_t max) {
+    if (v > max)
+      throw std::runtime_error("snapshot: book '" + std::string(name) + "': unknown " + field + " " +
+                               std::to_string(unsigned(v)));
+  };
+  check("stp policy", h.stp, std::uint8_t(Book::STPPolicy::CancelBoth));
+  check("ladder kind", h.ladder, std::uint8_t(LadderKind::Flat));
+  check("level queue", h.queue, std::uint8_t(LevelQueue::Ring));
+  check("depth_tree flag", h.depth_tree, 1);
+  Book::BookConfig cfg;
+  cfg.stp = Book::STPPolicy(h.stp);
+  cfg.ladder = LadderKind(h.ladder);
+  cfg.queue = LevelQueue(h.queue);
+  cfg.depth_tree = h.depth_tree != 0;
+  cfg.flat_ticks = std::size_t(h.flat_ticks);
+  cfg.flat_max_ticks = std::size_t(h.flat_max_ticks);
+  cfg.reserve_orders = std::size_t(h.orders);   // bulk pool + index sizing
+  return cfg;
+}
+
+inline void read_levels(Reader& r, Book& b, Side side, std::uint32_t levels) {
+  for (std::uint32_t i = 0; i < levels; ++i) {
+    const auto lh = r.get<LevelHeader>();
+    b.restore_level(side, lh.px, r.get_orders(lh.count), std::size_t(lh.count));
+  }
+}
+
+inline void validate(const Book& b, const BookHeader& h, std::string_view name) {
+  const std::string who = "snapshot: book '" + std::string(name) + "': ";
+  if (b.bids_total_ != h.bids_total || b.asks_total_ != h.asks_total || b.id_index_.size() != h.orders)
+    throw std::runtime_error(who + "totals do not match header");
+  if (auto errs = b.check_invariants(); !errs.empty())
+    throw std::runtime_error(who + errs.front());
+}
+
+// Read one book section into the Book that make(name, cfg) hands back.
+template<typename MakeBook>
+void read_book(Reader& r, MakeBook&& make) {
+  const auto h = r.get<BookHeader>();
+  const std::string_view name = r.get_name(h.name_len);
+  Book& b = make(name, config_of(h, name));
+  read_levels(r, b, Side::Bid, h.bid_levels);
+  read_levels(r, b, Side::Ask, h.ask_levels);
+  b.finish_restore();
+  validate(b, h, name);
+}
+
+template<typename WriteBooks>
+void write_file(const std::string& path, std::uint32_t books, std::uint64_t journal_seq, std::size_t body,
+                WriteBooks&& write_books) {
+  const std::size_t bytes = sizeof(FileHeader) + body;
+  const std::string tmp = path + ".tmp";
+  {
+    auto f = io::MappedFile::create(tmp, bytes);
+    Writer w(f.data());
+    FileHeader fh{};
+    std::memcpy(fh.magic, kMagic, sizeof kMagic);
+    fh.version = kVersion; fh.books = books; fh.bytes = bytes; fh.journal_seq = journal_seq;
+    w.put(fh);
+    write_books(w);
+    if (w.pos() != f.data() + bytes) throw std::logic_error("snapshot: size mismatch");
+    f.sync();
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0)
+    throw std::runtime_error("snapshot: rename to " + path + " failed");
+}
+
+inline Reader open_file(const io::MappedFile& f, std::uint32_t& books, std::uint64_t* journal_seq) {
+  Reader r(f.data(), f.size());
+  const auto fh = r.get<FileHeader>();
+  if (std::memcmp(fh.magic, kMagic, sizeof kMagic) != 0)
+    throw std::runtime_error("snapshot: bad magic");
+  if (fh.version != kVersion)
+    throw std::runtime_error("snapshot: unsupported version " + std::to_string(fh.version));
+  if (fh.bytes != f.size()) throw std::runtime_error("snapshot: size does not match header");
+  books = fh.books;
+  if (journal_seq) *journal_seq = fh.journal_seq;
+  return r;
+}
+
+} // namespace detail
+
+// journal_seq: the last journal record (journal.hpp) the books reflect. A
+// restart loads the books and replays the journal from journal_seq + 1
+// (replay.hpp).
+
+// ---- Single book ----
+inline void save(const Book& b, const std::string& path, std::uint64_t journal_seq = 0) {
+  detail::write_file(path, 1, journal_seq, detail::book_bytes(b, 0),
+                     [&](detail::Writer& w){ detail::write_book(w, b, {}); });
+}
+
+inline Book load_book(const std::string& path, std::uint64_t* journal_seq = nullptr) {
+  auto f = io::MappedFile::open_read(path);
+  f.advise_sequential();
+  std::uint32_t books = 0;
+  auto r = detail::open_file(f, books, journal_seq);
+  if (books != 1) throw std::runtime_error("snapshot: expected 1 book, file has " + std::to_string(books));
+  Book out;
+  detail::read_book(r, [&](std::string_view, const Book::BookConfig& cfg) -> Book& {
+    out = Book(cfg);
+    return out;
+  });
+  if (!r.done()) throw std::runtime_error("snapshot: trailing bytes");
+  return out;
+}
+
+// ---- Every book of a BookSet (names and ids preserved) ----
+inline void save(const BookSet& set, const std::string& path, std::uint64_t journal_seq = 0) {
+  std::size_t body = 0;
+  for (SymbolId id = 0; id < set.size(); ++id) body += detail::book_bytes(set[id], set.name(id).size());
+  detail::write_file(path, std::uint32_t(set.size()), journal_seq, body, [&](detail::Writer& w){
+    for (SymbolId id = 0; id < set.size(); ++id) detail::write_book(w, set[id], set.name(id));
+  });
+}
+
+// `defaults` becomes the set's config for symbols added after the restore.
+inline BookSet load_set(const std::string& path, Book::BookConfig defaults = {},
+                        std::uint64_t* journal_seq = nullptr) {
+  auto f = io::MappedFile::open_read(path);
+  f.advise_sequential();
+  std::uint32_t books = 0;
+  auto r = detail::open_file(f, books, journal_seq);
+  BookSet set(defaults);
+  set.reserve(books);
+  for (std::uint32_t i = 0; i < books; ++i)
+    detail::read_book(r, [&](std::string_view name, const Book::BookConfig& cfg) -> Book& {
+      const SymbolId id = set.add(name, cfg);
+      if (id != i) throw std::runtime_error("snapshot: duplicate symbol '" + std::string(name) + "'");
+      return set[id];
+    });
+  if (!r.done()) throw std::runtime_error("snapshot: trailing bytes");
+  return set;
+}
+
+} // namespace lob::snapshot
@@ -9,6 +9,7 @@ using TraderId = std::uint64_t;   // NEW: owner/account id for STP & replace
 using Qty      = std::int64_t;    // >=1 while resting
 using Price    = std::int64_t;    // integer ticks
 using TimeNs   = std::uint64_t;   // monotonic ns
+using SymbolId = std::uint32_t;   // dense instrument index (BookSet)
 
 // Primary sides + back-compat aliases used by tests
 enum class Side : std::uint8_t {
@@ -26,6 +27,14 @@ inline constexpr const char* side_str(Side s) {
   return "?";
 }
 
+// One L2 change: the level at (side, px) now rests qty in total (0 = gone).
+struct LevelDelta {
+  Side  side;
+  Price px;
+  Qty   qty;
+  friend bool operator==(const LevelDelta&, const LevelDelta&) = default;
+};
+
 struct BestOfBook {
   std::optional<Price> bid, ask;
 
@@ -1,24 +1,89 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <signal.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
-static const int PORT = 8080;
-
-std::string metrics_body(double uptime_sec) {
-  std::string b;
-  b += "# HELP build_info Build information.\n";
-  b += "# TYPE build_info gauge\n";
-  b += "build_info{git_sha=\"dev\",version=\"0.0.1\"} 1\n";
-  b += "# HELP engine_uptime_seconds Engine uptime in seconds.\n";
-  b += "# TYPE engine_uptime_seconds gauge\n";
-  b += "engine_uptime_seconds " + std::to_string(uptime_sec) + "\n";
-  return b;
+#include "command.hpp"
+#include "event_bus.hpp"
+#include "match_engine.hpp"
+#include "prometheus.hpp"
+#include "common/cpu.hpp"
+#include "common/metrics.hpp"
+#include "common/timebase.hpp"
+#include "spsc/spsc_channel.hpp"
+
+// Engine host: one matching thread running a MatchEngine behind an
+// SpscChannel of Commands, a consumer draining its EventBus, and this
+// thread serving GET /metrics (Prometheus) and anything else with "ok".
+//
+//   ingress (--sim-rate) --SpscChannel--> matcher: MatchEngine --EventBus--> event drainer
+//
+// Metrics are the matcher's own counters (EngineCounters, CommandLatency),
+// the channel's SpscStats and the drainer's consumed count. The HTTP thread
+// reads them with relaxed loads; the matching path takes no lock for them.
+//
+// There is no order gateway yet: --sim-rate N feeds N synthetic commands/s
+// (passive limits, IOC/FOK takers, markets, cancels) over --symbols S.
+
+struct Args {
+  int port = 8080;
+  int sim_rate = 0;            // commands/s, 0 = no synthetic flow
+  int symbols = 4;
+};
+
+static Args parse_args(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--port") && i+1 < argc) a.port = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--sim-rate") && i+1 < argc) a.sim_rate = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--symbols") && i+1 < argc) a.symbols = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--help")) {
+      std::cout << "Usage: engine_bin [--port P] [--sim-rate CMDS_PER_SEC] [--symbols S]\n";
+      std::exit(0);
+    }
+  }
+  return a;
+}
+
+static std::atomic<bool> g_stop{false};
+static void on_signal(int) { g_stop.store(true, std::memory_order_relaxed); }
+
+// Everything /metrics reports. Each part has one writer thread.
+struct Host {
+  EngineCounters counters;          // matcher
+  CommandLatency latency;           // matcher
+  SpscStats ingress_stats;          // producer (push/drops) and matcher (pop/depth)
+  SingleWriterCounter events_consumed;   // event drainer
+  std::atomic<std::uint64_t> commands{0};   // submitted by the simulator
+};
+
+std::string metrics_body(double uptime_sec, const Host& h) {
+  PromWriter w;
+  w.family("build_info", "gauge", "Build information.");
+  w.sample("build_info", {{"git_sha", "dev"}, {"version", "0.0.1"}}, std::uint64_t(1));
+  w.family("engine_uptime_seconds", "gauge", "Engine uptime in seconds.");
+  w.sample("engine_uptime_seconds", {}, uptime_sec);
+
+  write_engine_counters(w, h.counters);
+  w.family("engine_events_consumed_total", "counter", "Events taken off the event bus by the drainer.");
+  w.sample("engine_events_consumed_total", {}, h.events_consumed.get());
+  write_spsc_stats(w, {{"ingress", &h.ingress_stats}});
+  write_command_latency(w, "engine_command_latency_ns", h.latency);
+  return w.take();
 }
 
 std::string http_ok_text(const std::string& body, const std::string& content_type="text/plain") {
@@ -29,11 +94,95 @@ std::string http_ok_text(const std::string& body, const std::string& content_typ
   return hdr + body;
 }
 
-// JUST CREATING SERVER NOT CLIENT
-int main() {
+// Matching thread. Book gauges are walked at most every 10 ms while busy and
+// once more whenever the channel runs dry.
+static void run_matcher(SpscChannel<Command>& in, MatchEngine& eng) {
+  cpu::set_name("matcher");
+  constexpr std::uint64_t kGaugePeriodNs = 10'000'000;
+  std::uint64_t next_gauges = 0;
+  bool dirty = false;
+  Command c;
+  for (std::uint64_t n = 0;; ++n) {
+    if (!in.pop(c)) {
+      if (dirty) { eng.refresh_book_gauges(); dirty = false; }
+      if (!in.pop_wait(c, &g_stop)) break;
+    }
+    eng.apply(c);
+    dirty = true;
+    if ((n & 1023) == 0 && tb::fast_now_ns() >= next_gauges) {
+      eng.refresh_book_gauges();
+      dirty = false;
+      next_gauges = tb::fast_now_ns() + kGaugePeriodNs;
+    }
+  }
+}
+
+// Stands in for market-data / drop-copy consumers: keeps the bus drained.
+static void run_event_drainer(EventBus& bus, Host& h) {
+  cpu::set_name("events");
+  while (!g_stop.load(std::memory_order_relaxed)) {
+    const std::size_t n = bus.poll_bulk(256, [](Event&&) {});
+    if (n) h.events_consumed.add(n);
+    else std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+// Synthetic order flow at `rate` commands/s, paced per millisecond.
+static void run_simulator(SpscChannel<Command>& in, int rate, int nsym, Host& h) {
+  cpu::set_name("sim");
+  using TIF = lob::Book::TimeInForce;
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> op(0, 99), pd(-8, 8), qd(1, 10);
+  std::vector<OrderId> next(std::size_t(nsym), 1);
+  const std::uint64_t per_ms = std::max(1, rate / 1000);
+  auto tick = std::chrono::steady_clock::now();
+  while (!g_stop.load(std::memory_order_relaxed)) {
+    for (std::uint64_t k = 0; k < per_ms; ++k) {
+      const SymbolId sym = SymbolId(1 + rng() % std::uint64_t(nsym));   // symbol 0 is the default book
+      OrderId& id = next[sym - 1];
+      const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+      const Price px = 1000 + pd(rng) + (s == Side::Bid ? -2 : 2);
+      const int o = op(rng);
+      Command c;
+      if (o < 20 && id > 64)  c = make_cancel(sym, id - 1 - OrderId(rng() % 64));
+      else if (o < 25)        c = make_market(sym, id & 3, id, s, qd(rng)), ++id;
+      else if (o < 32)        c = make_add(sym, id & 3, id, s, px, qd(rng), TIF::IOC), ++id;
+      else if (o < 35)        c = make_add(sym, id & 3, id, s, px, qd(rng), TIF::FOK), ++id;
+      else if (o < 40 && id > 64) c = make_replace(sym, id & 3, id - 1 - OrderId(rng() % 64), px, qd(rng));
+      else                    c = make_add(sym, id & 3, id, s, px, qd(rng)), ++id;
+      if (!in.push(c, &g_stop)) break;
+      h.commands.fetch_add(1, std::memory_order_relaxed);
+    }
+    tick += std::chrono::milliseconds(1);
+    std::this_thread::sleep_until(tick);
+  }
+}
+
+int main(int argc, char** argv) {
+  const Args args = parse_args(argc, argv);
   using clock = std::chrono::steady_clock;
   const auto start = clock::now();
 
+  // No SA_RESTART: a signal interrupts accept() so the loop can exit.
+  struct sigaction sa{};
+  sa.sa_handler = on_signal;
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+  signal(SIGPIPE, SIG_IGN);
+
+  Host host;
+  EventBus bus(1u << 16);
+  MatchEngine eng(bus);      // calibrates tb::tsc_clock()
+  // Re-steer the TSC clock every second, so timestamps and latencies read
+  // with tb::fast_now_ns() keep tracking steady_clock over a long run.
+  tb::TscRecalibrator recalibrator;
+  for (int s = 0; s < args.symbols; ++s) eng.add_symbol("SYM" + std::to_string(s));
+  eng.set_metrics(&host.counters);
+  eng.set_latency(&host.latency);
+  SpscChannel<Command> ingress(1u << 16, BackpressureCfg((1u << 16) - 1024, (1u << 15), BpMode::Hybrid),
+                               &host.ingress_stats);
+
+  // Set up the listener before any worker starts, so a failure can simply return.
   int server_fd = ::socket(AF_INET, SOCK_STREAM, 0); // create server socket
   if (server_fd < 0) { std::perror("socket"); return 1; }
 
@@ -43,20 +192,25 @@ int main() {
   sockaddr_in addr{};
   addr.sin_family = AF_INET;
   addr.sin_addr.s_addr = INADDR_ANY;
-  addr.sin_port = htons(PORT);
+  addr.sin_port = htons(std::uint16_t(args.port));
 
   if (bind(server_fd, (sockaddr*)&addr, sizeof(addr)) < 0) { // bind socket to addr
-    std::perror("bind"); return 1;
+    std::perror("bind"); close(server_fd); return 1;
   }
   if (listen(server_fd, 16) < 0) {
-    std::perror("listen"); return 1;
+    std::perror("listen"); close(server_fd); return 1;
   }
 
-  std::cout << "[engine] listening on 0.0.0.0:" << PORT << " ...\n";
-  while (true) {
+  std::thread matcher([&] { run_matcher(ingress, eng); });
+  std::thread drainer([&] { run_event_drainer(bus, host); });
+  std::thread sim;
+  if (args.sim_rate > 0) sim = std::thread([&] { run_simulator(ingress, args.sim_rate, args.symbols, host); });
+
+  std::cout << "[engine] listening on 0.0.0.0:" << args.port << " ..." << std::endl;
+  while (!g_stop.load(std::memory_order_relaxed)) {
     sockaddr_in cli{}; socklen_t len = sizeof(cli);
     int client = accept(server_fd, (sockaddr*)&cli, &len);
-    if (client < 0) { std::perror("accept"); continue; }
+    if (client < 0) { if (errno != EINTR) std::perror("accept"); continue; }
 
     char buf[2048];
     ssize_t n = recv(client, buf, sizeof(buf)-1, 0);
@@ -66,16 +220,22 @@ int main() {
     bool want_metrics = req.find("GET /metrics") == 0 || req.find("GET /metrics ") != std::string::npos;
 
     auto uptime = std::chrono::duration<double>(clock::now() - start).count();
-    std::string body = want_metrics ? metrics_body(uptime) : std::string("ok\n");
+    std::string body = want_metrics ? metrics_body(uptime, host) : std::string("ok\n");
     std::string resp = http_ok_text(body, want_metrics ? "text/plain; version=0.0.4" : "text/plain");
 
     send(client, resp.data(), resp.size(), 0);
     close(client);
   }
+
+  // A parked matcher re-checks g_stop at least every park_ns.
+  if (sim.joinable()) sim.join();
+  matcher.join();
+  drainer.join();
+  close(server_fd);
+  std::cout << "[engine] stopped after " << host.commands.load() << " simulated commands" << std::endl;
   return 0;
 }
 
-
 // // C++ program to show the example of server application in
 // // socket programming
 // #include <cstring>
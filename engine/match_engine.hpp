@@ -1,94 +1,206 @@
 #pragma once
-#include <variant>          // for std::in_place_type
+#include <cassert>
 #include <cstdint>          // for std::uint64_t
+#include <stdexcept>
+#include <string_view>
 #include "event_bus.hpp"
 #include "events.hpp"
+#include "command.hpp"
+#include "journal.hpp"
+#include "common/metrics.hpp"
+#include "common/timebase.hpp"
+#include "common/trace.hpp"
 #include "lob/book.hpp"     // lob::Book with submit/cancel/replace
+#include "lob/book_set.hpp" // lob::BookSet (one Book per SymbolId)
 
-class MatchEngine {
+// Per-command latency, one histogram per CmdType (engine entry to return,
+// journal append included). Recorded by the matching thread only.
+struct CommandLatency {
+  LatencyHistogram by_type[4];
+  LatencyHistogram& operator[](CmdType t) { return by_type[std::size_t(t)]; }
+  const LatencyHistogram& operator[](CmdType t) const { return by_type[std::size_t(t)]; }
+};
+
+// What the engine did, for monitoring. Written by the matching thread only
+// (SingleWriterCounter: no locks, no RMW); any thread reads a snapshot.
+// An order is accepted when it traded or rested some qty, and rejected
+// when nothing happened (bad qty/px, FOK kill, IOC/market with nothing to
+// cross).
+struct EngineCounters {
+  SingleWriterCounter accepted[2][3];   // [OrderType][TimeInForce]
+  SingleWriterCounter rejected[2][3];
+  SingleWriterCounter fills, filled_qty;
+  SingleWriterCounter cancels, cancel_rejects;     // unknown id
+  SingleWriterCounter replaces, replace_rejects;   // unknown id, wrong owner, FOK kill, ...
+  SingleWriterCounter unknown_symbol;              // commands for an unregistered SymbolId
+  SingleWriterCounter events_published, events_dropped;   // dropped: bus full
+  // Book gauges over every symbol, [Side]; see refresh_book_gauges().
+  SingleWriterCounter resting_orders[2], book_levels[2], resting_qty[2];
+
+  void order(lob::Book::OrderType type, lob::Book::TimeInForce tif, bool ok) {
+    (ok ? accepted : rejected)[std::size_t(type)][std::size_t(tif)].add();
+  }
+};
+
+// Bus: where events go; anything with try_publish(const Event&) (EventBus,
+// BroadcastBus).
+template<class Bus>
+class BasicMatchEngine {
 public:
-  // Pass a Book config to choose STP policy, etc.
-  explicit MatchEngine(EventBus& bus,
+  // Pass a Book config to choose STP policy, etc. It is the default for
+  // every symbol. Symbol 0 always exists: it is the book behind the
+  // single-instrument API (calls without a SymbolId).
+  //
+  // BookChangeEvents are the books' exact L2 deltas: one per level a command
+  // changed, carrying that level's new total (0 = level gone), after the
+  // command's fills/cancel event. Applying them in order keeps a mirror book.
+  // Every event of one command carries the same ts_ns, read lazily from the
+  // clock (tb::fast_now_ns) when that command publishes its first event (or
+  // at command entry while latency tracking is on).
+  explicit BasicMatchEngine(Bus& bus,
                        lob::Book::BookConfig cfg = {})
-    : bus_(bus), book_()
-  {
-    // If Book constructor doesn’t accept cfg directly, assign it.
-    book_.cfg_ = cfg;
+    : bus_(bus), books_(with_deltas(cfg)) {
+    books_.add("");
+    tb::tsc_clock();   // calibrate now rather than inside the first command
+  }
+
+  // ----- Symbols -----
+  // Register an instrument; ids are dense and stable (idempotent per name).
+  SymbolId add_symbol(std::string_view name) { return books_.add(name); }
+  SymbolId add_symbol(std::string_view name, const lob::Book::BookConfig& cfg) {
+    return books_.add(name, with_deltas(cfg));
+  }
+  const lob::BookSet& books() const { return books_; }
+
+  // ----- Restart -----
+  // Replace every book with restored ones (snapshot::load_set), then replay
+  // the journal from the snapshot's journal_seq + 1. Symbol 0 must be the
+  // unnamed default book; an empty set gets one.
+  void adopt(lob::BookSet&& books) {
+    if (books.empty()) books.add("");
+    if (!books.name(0).empty()) throw std::invalid_argument("adopt: symbol 0 must be the unnamed book");
+    books.set_config(with_deltas(books.config()));
+    for (lob::Book& b : books) {
+      b.cfg_.l2_deltas = true;
+      b.clear_deltas();
+    }
+    books_ = std::move(books);
+  }
+
+  // ----- Write-ahead journal -----
+  // Every command is appended to j before it is applied (nullptr: off).
+  // Commands for an unregistered SymbolId are dropped (and counted) before
+  // they reach the journal.
+  void set_journal(Journal* j) { journal_ = j; }
+
+  // ----- Latency tracking -----
+  // Time every command into lat[cmd type] (nullptr: off, no clock reads).
+  void set_latency(CommandLatency* lat) { latency_ = lat; }
+
+  // ----- Counters -----
+  // Count orders, fills, cancels and events into c (nullptr: off).
+  void set_metrics(EngineCounters* c) { metrics_ = c; }
+
+  // Recompute the book gauges in the counters: O(price levels), so call it
+  // from the matching thread between commands (e.g. when idle or every few
+  // ms), not per command.
+  void refresh_book_gauges() {
+    if (!metrics_) return;
+    refresh_side<lob::Side::Bid>();
+    refresh_side<lob::Side::Ask>();
   }
 
   // ===== Day-6 APIs (preferred) =====
 
   // ----- Limit order -----
-  void add(std::uint64_t trader, OrderId id, lob::Side side, Price px, Qty qty,
+  // Side is resolved once here; everything below runs side-specialized.
+  void add(SymbolId sym, std::uint64_t trader, OrderId id, lob::Side side, Price px, Qty qty,
            lob::Book::TimeInForce tif = lob::Book::TimeInForce::Day) {
-    auto r = book_.submit(trader, side, px, qty, id,
-                          lob::Book::OrderType::Limit, tif);
-    for (const auto& f : r.fills) {
-      bus_.try_publish(Event{
-        std::in_place_type<FillEvent>,
-        f.taker_id, f.maker_id, side, f.px, f.qty
-      });
-    }
-    if (r.posted_qty > 0 || r.book_changed) {
-      bus_.try_publish(Event{
-        std::in_place_type<BookChangeEvent>,
-        side, px, book_level_qty(side, px)
-      });
-    }
+    const CommandTimer timer(*this, CmdType::Add);
+    if (!known(sym)) [[unlikely]] return;
+    if (journal_) journal_->append(make_add(sym, trader, id, side, px, qty, tif));
+    if (side == lob::Side::Bid) add_as<lob::Side::Bid>(sym, trader, id, px, qty, tif);
+    else                        add_as<lob::Side::Ask>(sym, trader, id, px, qty, tif);
   }
 
   // ----- Market order -----
-  void market(std::uint64_t trader, OrderId id, lob::Side side, Qty qty,
+  void market(SymbolId sym, std::uint64_t trader, OrderId id, lob::Side side, Qty qty,
               lob::Book::TimeInForce tif = lob::Book::TimeInForce::IOC) {
-    auto r = book_.submit(trader, side, 0, qty, id,
-                          lob::Book::OrderType::Market, tif);
-    for (const auto& f : r.fills) {
-      bus_.try_publish(Event{
-        std::in_place_type<FillEvent>,
-        f.taker_id, f.maker_id, side, f.px, f.qty
-      });
-    }
-    if (r.book_changed) {
-      // 0/0 indicates a best-level change without specifying price
-      bus_.try_publish(Event{
-        std::in_place_type<BookChangeEvent>,
-        side, Price{0}, Qty{0}
-      });
-    }
+    const CommandTimer timer(*this, CmdType::Market);
+    if (!known(sym)) [[unlikely]] return;
+    if (journal_) journal_->append(make_market(sym, trader, id, side, qty, tif));
+    if (side == lob::Side::Bid) market_as<lob::Side::Bid>(sym, trader, id, qty, tif);
+    else                        market_as<lob::Side::Ask>(sym, trader, id, qty, tif);
   }
 
   // ----- Replace/Amend -----
-  void replace(std::uint64_t trader, OrderId id, Price new_px, Qty new_qty,
+  void replace(SymbolId sym, std::uint64_t trader, OrderId id, Price new_px, Qty new_qty,
                lob::Book::TimeInForce tif = lob::Book::TimeInForce::Day) {
-    auto rr = book_.replace(trader, id, new_px, new_qty, tif);
-    if (rr.ok) {
-      // Emit conservative book-change notifications at the amended price for both sides.
-      bus_.try_publish(Event{
-        std::in_place_type<BookChangeEvent>,
-        lob::Side::Bid, new_px, book_level_qty(lob::Side::Bid, new_px)
-      });
-      bus_.try_publish(Event{
-        std::in_place_type<BookChangeEvent>,
-        lob::Side::Ask, new_px, book_level_qty(lob::Side::Ask, new_px)
-      });
+    const CommandTimer timer(*this, CmdType::Replace);
+    if (!known(sym)) [[unlikely]] return;
+    if (journal_) journal_->append(make_replace(sym, trader, id, new_px, new_qty, tif));
+    lob::Book& book = book_at(sym);
+    auto* e = book.id_index_.find(id);
+    if (!e) {
+      if (metrics_) metrics_->replace_rejects.add();
+      return;
     }
+    // A repriced order can cross; its fills go straight onto the bus.
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitBegin));
+    const auto r = e->node->side == lob::Side::Bid
+      ? book.replace(trader, id, new_px, new_qty, tif, FillPublisher<lob::Side::Bid>{*this, sym})
+      : book.replace(trader, id, new_px, new_qty, tif, FillPublisher<lob::Side::Ask>{*this, sym});
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitEnd));
+    if (metrics_) (r.ok ? metrics_->replaces : metrics_->replace_rejects).add();
+    // Old level, crossed levels and new level, as they changed (a rejected
+    // FOK re-entry leaves just the cancel).
+    publish_deltas(sym, book);
   }
 
   // ----- Cancel -----
-  void cancel(OrderId id) {
-    auto c = book_.cancel(id);
+  void cancel(SymbolId sym, OrderId id) {
+    const CommandTimer timer(*this, CmdType::Cancel);
+    if (!known(sym)) [[unlikely]] return;
+    if (journal_) journal_->append(make_cancel(sym, id));
+    lob::Book& book = book_at(sym);
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitBegin));
+    auto c = book.cancel(id);
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitEnd));
+    if (metrics_) (c.ok ? metrics_->cancels : metrics_->cancel_rejects).add();
     if (c.ok) {
-      bus_.try_publish(Event{
-        std::in_place_type<CancelEvent>,
-        id, c.side, c.px, c.qty_canceled
-      });
-      bus_.try_publish(Event{
-        std::in_place_type<BookChangeEvent>,
-        c.side, c.px, book_level_qty(c.side, c.px)
-      });
+      emit(CancelEvent{id, c.px, c.qty_canceled, sym, c.side});
+      publish_deltas(sym, book);
     }
   }
 
+  // ----- Command dispatch (routers, replay) -----
+  // trace_id: the id the command was given at ingress (common/trace.hpp);
+  // 0 gets a fresh one. Unused unless LOB_TRACE is defined.
+  void apply(const Command& c, [[maybe_unused]] std::uint64_t trace_id = 0) {
+    LOB_TRACE_ONLY(trace::current_id() = trace_id);
+    switch (c.type) {
+      case CmdType::Add:     add(c.symbol, c.trader, c.id, c.side, c.px, c.qty, c.tif); break;
+      case CmdType::Market:  market(c.symbol, c.trader, c.id, c.side, c.qty, c.tif); break;
+      case CmdType::Cancel:  cancel(c.symbol, c.id); break;
+      case CmdType::Replace: replace(c.symbol, c.trader, c.id, c.px, c.qty, c.tif); break;
+    }
+  }
+
+  // ===== Single-instrument API (symbol 0) =====
+  void add(std::uint64_t trader, OrderId id, lob::Side side, Price px, Qty qty,
+           lob::Book::TimeInForce tif = lob::Book::TimeInForce::Day) {
+    add(SymbolId{0}, trader, id, side, px, qty, tif);
+  }
+  void market(std::uint64_t trader, OrderId id, lob::Side side, Qty qty,
+              lob::Book::TimeInForce tif = lob::Book::TimeInForce::IOC) {
+    market(SymbolId{0}, trader, id, side, qty, tif);
+  }
+  void replace(std::uint64_t trader, OrderId id, Price new_px, Qty new_qty,
+               lob::Book::TimeInForce tif = lob::Book::TimeInForce::Day) {
+    replace(SymbolId{0}, trader, id, new_px, new_qty, tif);
+  }
+  void cancel(OrderId id) { cancel(SymbolId{0}, id); }
+
   // ===== Back-compat wrappers (keep old call sites working) =====
   void add(OrderId id, lob::Side side, Price px, Qty qty) {
     add(/*trader*/0, id, side, px, qty, lob::Book::TimeInForce::Day);
@@ -98,19 +210,130 @@ public:
   }
 
   // ----- helpers -----
-  Qty book_level_qty(lob::Side s, Price px) const {
-    if (s == lob::Side::Bid) return book_level_qty_impl(book_.bids_, px);
-    return book_level_qty_impl(book_.asks_, px);
+  const lob::Book& book(SymbolId sym = 0) const { return books_[sym]; }
+
+  Qty book_level_qty(lob::Side s, Price px) const { return book_level_qty(SymbolId{0}, s, px); }
+  Qty book_level_qty(SymbolId sym, lob::Side s, Price px) const {
+    if (s == lob::Side::Bid) return book_level_qty<lob::Side::Bid>(sym, px);
+    return book_level_qty<lob::Side::Ask>(sym, px);
+  }
+  template<lob::Side S>
+  Qty book_level_qty(SymbolId sym, Price px) const {
+    auto* lvl = books_[sym].ladder<S>().find(px);
+    return lvl ? lvl->total_qty : 0;
   }
 
 private:
-  template<typename Map>
-  Qty book_level_qty_impl(const Map& m, Price px) const {
-    auto it = m.find(px);
-    return (it == m.end()) ? 0 : it->second.total_qty;
+  // Starts a command: resets its event timestamp and, while latency
+  // tracking is on, times it (the entry time doubles as the events' ts_ns).
+  // Also opens and closes the command's trace scope.
+  class CommandTimer {
+  public:
+    CommandTimer(BasicMatchEngine& eng, CmdType type) : eng_(eng), type_(type) {
+      LOB_TRACE_ONLY(trace::begin_command());
+      eng_.cmd_ts_ = eng_.latency_ ? tb::fast_now_ns() : 0;
+      t0_ = eng_.cmd_ts_;
+    }
+    ~CommandTimer() {
+      if (t0_ && eng_.latency_) (*eng_.latency_)[type_].record(tb::fast_now_ns() - t0_);
+      LOB_TRACE_ONLY(trace::end_command());
+    }
+    CommandTimer(const CommandTimer&) = delete;
+    CommandTimer& operator=(const CommandTimer&) = delete;
+  private:
+    BasicMatchEngine& eng_;
+    CmdType type_;
+    std::uint64_t t0_;
+  };
+
+  // Fill sink for Book::submit/replace: publishes each fill as it happens.
+  template<lob::Side S>
+  struct FillPublisher {
+    BasicMatchEngine& eng;
+    SymbolId sym;
+    void operator()(const lob::Book::MatchFill& f) const {
+      if (eng.metrics_) {
+        eng.metrics_->fills.add();
+        eng.metrics_->filled_qty.add(std::uint64_t(f.qty));
+      }
+      eng.emit(FillEvent{f.taker_id, f.maker_id, f.px, f.qty, sym, S});
+    }
+  };
+
+  void emit(Event&& ev) {
+    if (!cmd_ts_) cmd_ts_ = tb::fast_now_ns();
+    ev.ts_ns = cmd_ts_;
+    const bool ok = bus_.try_publish(ev);
+    if (metrics_) (ok ? metrics_->events_published : metrics_->events_dropped).add();
   }
 
-  // Declare bus_ BEFORE book_ to match constructor init order.
-  EventBus& bus_;
-  lob::Book book_;
+  template<lob::Side S>
+  void refresh_side() {
+    std::uint64_t orders = 0, levels = 0, qty = 0;
+    for (lob::Book& book : books_) {
+      book.ladder<S>().walk([&](const lob::PriceLevel& lvl) { orders += lvl.count; return true; });
+      levels += book.ladder<S>().size();
+      qty += std::uint64_t(book.side_total<S>());
+    }
+    const std::size_t i = std::size_t(S);
+    metrics_->resting_orders[i].set(orders);
+    metrics_->book_levels[i].set(levels);
+    metrics_->resting_qty[i].set(qty);
+  }
+
+  static lob::Book::BookConfig with_deltas(lob::Book::BookConfig cfg) {
+    cfg.l2_deltas = true;
+    return cfg;
+  }
+
+  void publish_deltas(SymbolId sym, lob::Book& book) {
+    for (const lob::LevelDelta& d : book.deltas())
+      emit(BookChangeEvent{d.px, d.qty, sym, d.side});
+    book.clear_deltas();
+  }
+
+  bool known(SymbolId sym) {
+    if (books_.contains(sym)) [[likely]] return true;
+    if (metrics_) metrics_->unknown_symbol.add();
+    return false;
+  }
+
+  lob::Book& book_at(SymbolId sym) {
+    assert(books_.contains(sym) && "unknown SymbolId");
+    return books_[sym];
+  }
+
+  template<lob::Side S>
+  void add_as(SymbolId sym, std::uint64_t trader, OrderId id, Price px, Qty qty,
+              lob::Book::TimeInForce tif) {
+    lob::Book& book = book_at(sym);
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitBegin));
+    const auto r = book.submit_side<S>(trader, px, qty, id, lob::Book::OrderType::Limit, tif,
+                                       FillPublisher<S>{*this, sym});
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitEnd));
+    if (metrics_) metrics_->order(lob::Book::OrderType::Limit, tif, r.fill_count || r.posted_qty);
+    publish_deltas(sym, book);   // every swept level, then the posted one
+  }
+
+  template<lob::Side S>
+  void market_as(SymbolId sym, std::uint64_t trader, OrderId id, Qty qty,
+                 lob::Book::TimeInForce tif) {
+    lob::Book& book = book_at(sym);
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitBegin));
+    const auto r = book.submit_side<S>(trader, 0, qty, id, lob::Book::OrderType::Market, tif,
+                                       FillPublisher<S>{*this, sym});
+    LOB_TRACE_ONLY(trace::stamp(trace::Stage::SubmitEnd));
+    if (metrics_) metrics_->order(lob::Book::OrderType::Market, tif, r.fill_count || r.posted_qty);
+    publish_deltas(sym, book);
+  }
+
+  // Declare bus_ BEFORE books_ to match constructor init order.
+  Bus& bus_;
+  lob::BookSet books_;
+  Journal* journal_{nullptr};
+  CommandLatency* latency_{nullptr};
+  EngineCounters* metrics_{nullptr};
+  std::uint64_t cmd_ts_{0};   // ts_ns of the current command's events (0: not read yet)
 };
+
+using MatchEngine = BasicMatchEngine<EventBus>;
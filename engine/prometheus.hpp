@@ -0,0 +1,164 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "command.hpp"
+#include "match_engine.hpp"
+#include "common/metrics.hpp"
+
+// ---- Prometheus text exposition (format 0.0.4) ----
+//
+// Renders engine counters, SpscStats and latency histograms. Everything
+// rendered here is read with relaxed loads from atomics that other threads
+// keep writing. Nothing takes a lock and the matching thread never waits
+// for a scrape. Each value is recent but the set is not one instant: a
+// scrape can see a fill counted before the order that caused it.
+//
+// Every metric family is written as HELP, then TYPE, then its samples:
+//   PromWriter w;
+//   w.family("engine_fills_total", "counter", "Fills.");
+//   w.sample("engine_fills_total", {}, c.fills.get());
+class PromWriter {
+public:
+  struct Label { std::string_view name, value; };
+
+  void family(std::string_view name, std::string_view type, std::string_view help) {
+    out_ += "# HELP "; out_ += name; out_ += ' '; out_ += help; out_ += '\n';
+    out_ += "# TYPE "; out_ += name; out_ += ' '; out_ += type; out_ += '\n';
+  }
+
+  void sample(std::string_view name, std::initializer_list<Label> labels, std::uint64_t v) {
+    head(name, labels);
+    out_ += std::to_string(v);
+    out_ += '\n';
+  }
+  void sample(std::string_view name, std::initializer_list<Label> labels, double v) {
+    head(name, labels);
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.9g", v);
+    out_ += buf;
+    out_ += '\n';
+  }
+
+  const std::string& str() const { return out_; }
+  std::string take() { return std::move(out_); }
+
+private:
+  void head(std::string_view name, std::initializer_list<Label> labels) {
+    out_ += name;
+    if (labels.size()) {
+      out_ += '{';
+      bool first = true;
+      for (const Label& l : labels) {
+        if (!first) out_ += ',';
+        first = false;
+        out_ += l.name; out_ += "=\""; out_ += l.value; out_ += '"';
+      }
+      out_ += '}';
+    }
+    out_ += ' ';
+  }
+
+  std::string out_;
+};
+
+inline const char* order_type_label(lob::Book::OrderType t) {
+  return t == lob::Book::OrderType::Market ? "market" : "limit";
+}
+inline const char* tif_label(lob::Book::TimeInForce t) {
+  switch (t) {
+    case lob::Book::TimeInForce::IOC: return "ioc";
+    case lob::Book::TimeInForce::FOK: return "fok";
+    default:                          return "day";
+  }
+}
+inline const char* side_label(lob::Side s) { return s == lob::Side::Bid ? "bid" : "ask"; }
+inline const char* cmd_type_label(CmdType t) {
+  static constexpr const char* names[4] = {"add", "market", "cancel", "replace"};
+  return names[std::size_t(t)];
+}
+
+// engine_* families from one engine's counters.
+inline void write_engine_counters(PromWriter& w, const EngineCounters& c) {
+  using OT = lob::Book::OrderType;
+  using TIF = lob::Book::TimeInForce;
+  w.family("engine_orders_total", "counter", "Orders by type, time-in-force and result (accepted: traded or rested).");
+  for (OT t : {OT::Limit, OT::Market})
+    for (TIF f : {TIF::Day, TIF::IOC, TIF::FOK}) {
+      const std::size_t i = std::size_t(t), j = std::size_t(f);
+      w.sample("engine_orders_total", {{"type", order_type_label(t)}, {"tif", tif_label(f)}, {"result", "accepted"}},
+               c.accepted[i][j].get());
+      w.sample("engine_orders_total", {{"type", order_type_label(t)}, {"tif", tif_label(f)}, {"result", "rejected"}},
+               c.rejected[i][j].get());
+    }
+
+  w.family("engine_fills_total", "counter", "Fills (one per maker order matched).");
+  w.sample("engine_fills_total", {}, c.fills.get());
+  w.family("engine_filled_qty_total", "counter", "Quantity filled.");
+  w.sample("engine_filled_qty_total", {}, c.filled_qty.get());
+
+  w.family("engine_cancels_total", "counter", "Cancel commands by result.");
+  w.sample("engine_cancels_total", {{"result", "ok"}}, c.cancels.get());
+  w.sample("engine_cancels_total", {{"result", "rejected"}}, c.cancel_rejects.get());
+  w.family("engine_replaces_total", "counter", "Replace commands by result.");
+  w.sample("engine_replaces_total", {{"result", "ok"}}, c.replaces.get());
+  w.sample("engine_replaces_total", {{"result", "rejected"}}, c.replace_rejects.get());
+  w.family("engine_unknown_symbol_total", "counter", "Commands dropped for an unregistered symbol id.");
+  w.sample("engine_unknown_symbol_total", {}, c.unknown_symbol.get());
+
+  w.family("engine_events_total", "counter", "Events offered to the event bus by result (dropped: bus full).");
+  w.sample("engine_events_total", {{"result", "published"}}, c.events_published.get());
+  w.sample("engine_events_total", {{"result", "dropped"}}, c.events_dropped.get());
+
+  const lob::Side sides[2] = {lob::Side::Bid, lob::Side::Ask};
+  w.family("engine_resting_orders", "gauge", "Resting orders per side, all symbols.");
+  for (lob::Side s : sides) w.sample("engine_resting_orders", {{"side", side_label(s)}}, c.resting_orders[std::size_t(s)].get());
+  w.family("engine_book_levels", "gauge", "Price levels per side, all symbols.");
+  for (lob::Side s : sides) w.sample("engine_book_levels", {{"side", side_label(s)}}, c.book_levels[std::size_t(s)].get());
+  w.family("engine_resting_qty", "gauge", "Resting quantity per side, all symbols.");
+  for (lob::Side s : sides) w.sample("engine_resting_qty", {{"side", side_label(s)}}, c.resting_qty[std::size_t(s)].get());
+}
+
+// spsc_* families for the queues in `queues` (name label -> stats). Depth
+// and max depth are those last observed by SpscChannel.
+struct NamedSpscStats { std::string_view name; const SpscStats* stats; };
+inline void write_spsc_stats(PromWriter& w, std::initializer_list<NamedSpscStats> queues) {
+  struct Col { const char* name; const char* type; const char* help; std::atomic<uint64_t> SpscStats::*field; };
+  static constexpr Col cols[] = {
+    {"spsc_push_total",   "counter", "Items pushed.",                              &SpscStats::push_ok},
+    {"spsc_pop_total",    "counter", "Items popped.",                              &SpscStats::pop_ok},
+    {"spsc_drops_total",  "counter", "Items dropped by backpressure.",             &SpscStats::drops_total},
+    {"spsc_parks_total",  "counter", "Hybrid waits that parked on the futex.",     &SpscStats::parks},
+    {"spsc_depth",        "gauge",   "Queue depth.",                               &SpscStats::depth_gauge},
+    {"spsc_max_depth",    "gauge",   "Highest queue depth seen.",                  &SpscStats::max_depth},
+  };
+  for (const Col& col : cols) {
+    w.family(col.name, col.type, col.help);
+    for (const NamedSpscStats& q : queues)
+      w.sample(col.name, {{"queue", q.name}}, (q.stats->*col.field).load(std::memory_order_relaxed));
+  }
+}
+
+// `name` as a summary per command type: p50/p90/p99/p99.9 quantiles, _sum
+// and _count, plus `name`_max as a gauge. Values in ns.
+inline void write_command_latency(PromWriter& w, std::string_view name, const CommandLatency& lat) {
+  static constexpr struct { double p; const char* label; } qs[] = {
+    {50.0, "0.5"}, {90.0, "0.9"}, {99.0, "0.99"}, {99.9, "0.999"}};
+  const std::string n(name), sum = n + "_sum", count = n + "_count", max = n + "_max";
+  w.family(n, "summary", "Engine command latency in ns (entry to return), by command type.");
+  for (CmdType t : {CmdType::Add, CmdType::Market, CmdType::Cancel, CmdType::Replace}) {
+    const LatencyHistogram& h = lat[t];
+    for (auto const& q : qs)
+      w.sample(n, {{"type", cmd_type_label(t)}, {"quantile", q.label}}, h.percentile(q.p));
+    w.sample(sum, {{"type", cmd_type_label(t)}}, h.sum());
+    w.sample(count, {{"type", cmd_type_label(t)}}, h.count());
+  }
+  w.family(max, "gauge", "Slowest command so far in ns, by command type.");
+  for (CmdType t : {CmdType::Add, CmdType::Market, CmdType::Cancel, CmdType::Replace})
+    w.sample(max, {{"type", cmd_type_label(t)}}, lat[t].max());
+}
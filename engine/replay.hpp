@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "event_bus.hpp"
+#include "event_log.hpp"
+#include "journal.hpp"
+#include "match_engine.hpp"
+#include "common/timebase.hpp"
+
+// ---- Journal replay ----
+//
+// Feeds every journaled command (optionally a seq range) through a
+// MatchEngine as fast as it goes, draining the bus in bulk after each one,
+// and checks the produced event stream against a recorded reference. The
+// same pass rebuilds engine state after a restart: MatchEngine::adopt() the
+// books of a snapshot (lob/snapshot.hpp) and replay with from_seq set to the
+// snapshot's journal_seq + 1.
+//
+// The engine must not have a journal attached. Symbol registrations and
+// their BookConfigs are not journaled: the caller registers every symbol the
+// journal uses, with the config it was recorded with, before replaying (or
+// adopt()s a snapshot, which carries both). A command for an id the engine
+// doesn't know throws std::runtime_error.
+// The bus must hold every event of one command: a command whose events
+// overflow it throws std::runtime_error rather than replaying a stream with
+// holes.
+
+struct ReplayOptions {
+  const EventLog* expect{nullptr};        // verify against this stream
+  EventLogWriter* record{nullptr};        // write the produced stream
+  std::uint64_t from_seq{1};
+  std::uint64_t to_seq{std::numeric_limits<std::uint64_t>::max()};
+};
+
+struct ReplayStats {
+  std::uint64_t commands{0};
+  std::uint64_t events{0};
+  std::uint64_t gaps{0};                  // seq discontinuities in the journal
+  std::uint64_t mismatches{0};            // differing, missing or extra events
+  std::uint64_t first_mismatch{std::numeric_limits<std::uint64_t>::max()};   // event index
+  std::string   first_diff;               // "got X, expected Y"
+  std::uint64_t digest{0xcbf29ce484222325ull};   // order-sensitive hash of the stream
+  std::uint64_t elapsed_ns{0};
+
+  bool verified() const { return mismatches == 0; }
+  double msgs_per_sec() const { return elapsed_ns ? double(commands) * 1e9 / double(elapsed_ns) : 0.0; }
+};
+
+namespace detail {
+
+inline void replay_event(ReplayStats& st, const ReplayOptions& opt, const Event& ev) {
+  const EventRecord r = to_record(ev);
+  std::uint64_t w[5];
+  std::memcpy(w, &r, sizeof w);
+  for (auto x : w) st.digest = (st.digest ^ x) * 0x100000001b3ull;
+  if (opt.record) opt.record->append(r);
+  if (opt.expect) {
+    const bool have = st.events < opt.expect->size();
+    if (!have || !(r == (*opt.expect)[st.events])) [[unlikely]] {
+      if (!st.mismatches) {
+        st.first_mismatch = st.events;
+        st.first_diff = "got " + to_string(r) + ", expected " +
+                        (have ? to_string((*opt.expect)[st.events]) : std::string("end of stream"));
+      }
+      ++st.mismatches;
+    }
+  }
+  ++st.events;
+}
+
+} // namespace detail
+
+inline ReplayStats replay(const std::string& journal_dir, MatchEngine& eng, EventBus& bus,
+                          const ReplayOptions& opt = {}) {
+  ReplayStats st;
+  std::uint64_t next = 0;
+  const auto t0 = tb::now_ns();
+  JournalReader(journal_dir).for_each([&](const JournalRecord& r){
+    if (r.seq < opt.from_seq || r.seq > opt.to_seq) return;
+    if (next && r.seq != next) ++st.gaps;
+    next = r.seq + 1;
+    if (!eng.books().contains(r.cmd.symbol)) [[unlikely]]
+      throw std::runtime_error("replay: seq " + std::to_string(r.seq) + " uses symbol " +
+                               std::to_string(r.cmd.symbol) + ", which is not registered");
+    const std::uint64_t dropped = bus.dropped();
+    eng.apply(r.cmd);
+    if (bus.dropped() != dropped) [[unlikely]]
+      throw std::runtime_error("replay: seq " + std::to_string(r.seq) + " published more events than the bus holds (" +
+                               std::to_string(bus.capacity()) + ")");
+    ++st.commands;
+    bus.poll_bulk(bus.capacity(), [&](Event&& ev){ detail::replay_event(st, opt, ev); });
+  });
+  st.elapsed_ns = tb::now_ns() - t0;
+  if (opt.expect && st.events < opt.expect->size()) {
+    if (!st.mismatches) {
+      st.first_mismatch = st.events;
+      st.first_diff = "stream ended, expected " + to_string((*opt.expect)[st.events]);
+    }
+    st.mismatches += opt.expect->size() - st.events;
+  }
+  return st;
+}
@@ -0,0 +1,256 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "command.hpp"
+#include "event_bus.hpp"
+#include "match_engine.hpp"
+#include "spsc/spsc_ring.hpp"
+#include "spsc/spsc_channel.hpp"   // cpu_relax
+#include "common/cpu.hpp"
+#include "common/trace.hpp"
+
+// Symbol-sharded matching runtime.
+//
+//   producer --submit()--> inbound ring --router thread--> shard ring[i]
+//                                                            |
+//                              shard thread i: MatchEngine (its books) -> EventBus[i]
+//
+// Shards share nothing: each owns a MatchEngine holding only its symbols'
+// books and its own EventBus, and runs on its own (optionally pinned)
+// thread, so aggregate throughput scales with the shard count as long as
+// symbols spread evenly and every shard has a core.
+//
+// Symbols are registered before start(). Global SymbolIds are dense and dealt
+// round-robin to shards (global g lives on shard g % N); commands and the
+// events handed out by poll() use global ids. Threading: one producer thread
+// calls submit(), one consumer per shard calls poll(shard, ...).
+//
+// With LOB_TRACE, submit() is each command's ingress trace point and its
+// trace id rides along with it through both rings.
+class ShardedEngine {
+public:
+  struct Config {
+    std::size_t shards{2};
+    std::size_t inbound_cap{1u << 16};   // producer -> router (pow2)
+    std::size_t shard_cap{1u << 16};     // router -> each shard (pow2)
+    std::size_t bus_cap{1u << 16};       // each shard's EventBus (pow2)
+    int router_cpu{-1};                  // < 0: leave unpinned
+    std::vector<int> shard_cpus;         // shard i pins to shard_cpus[i] when present and >= 0
+    lob::Book::BookConfig book{};
+  };
+
+  explicit ShardedEngine(Config cfg) : cfg_(std::move(cfg)), inbound_(cfg_.inbound_cap) {
+    assert(cfg_.shards > 0);
+    shards_.reserve(cfg_.shards);
+    for (std::size_t i = 0; i < cfg_.shards; ++i)
+      shards_.push_back(std::make_unique<Shard>(cfg_.shard_cap, cfg_.bus_cap, cfg_.book));
+  }
+
+  ~ShardedEngine() { stop(); }
+
+  ShardedEngine(const ShardedEngine&) = delete;
+  ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+  // ----- Setup (before start) -----
+  // Register an instrument (idempotent per name); returns its global id.
+  SymbolId add_symbol(std::string_view name) {
+    assert(!started_ && "register symbols before start()");
+    std::string key(name);
+    if (auto it = ids_.find(key); it != ids_.end()) return it->second;
+    const SymbolId g = SymbolId(routes_.size());
+    const std::uint32_t s = std::uint32_t(g % shards_.size());
+    const SymbolId local = shards_[s]->engine.add_symbol(key);
+    shards_[s]->global_of.resize(local + 1);
+    shards_[s]->global_of[local] = g;
+    routes_.push_back(Route{s, local});
+    ids_.emplace(std::move(key), g);
+    return g;
+  }
+
+  // Throws std::invalid_argument, before any thread starts, if a configured
+  // CPU is not usable (cpu::usable).
+  void start() {
+    assert(!started_);
+    check_cpu(cfg_.router_cpu, "router_cpu");
+    for (std::size_t i = 0; i < shards_.size() && i < cfg_.shard_cpus.size(); ++i)
+      check_cpu(cfg_.shard_cpus[i], "shard_cpus[" + std::to_string(i) + "]");
+    started_ = true;
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+      const int cpu = i < cfg_.shard_cpus.size() ? cfg_.shard_cpus[i] : -1;
+      shards_[i]->thread = std::thread([this, i, cpu]{ shard_loop(*shards_[i], cpu); });
+    }
+    router_ = std::thread([this]{ route_loop(); });
+  }
+
+  // Drain everything already submitted, then join all threads. Idempotent.
+  void stop() {
+    if (!started_ || stopped_) return;
+    stopping_.store(true, std::memory_order_release);
+    router_.join();
+    for (auto& s : shards_) s->thread.join();
+    stopped_ = true;
+  }
+
+  // ----- Producer side (single thread) -----
+  bool try_submit(const Command& c) {
+    std::uint64_t id = 0;
+    // Stamp only a command that will get in (only this thread fills the ring).
+    LOB_TRACE_ONLY(if (inbound_.full()) return false;
+               id = trace::next_id(); trace::point(trace::Stage::Ingress, id));
+    if (!inbound_.try_push(Routed(c, id))) return false;
+    ++submitted_;
+    return true;
+  }
+  // Spins while the inbound ring is full (backpressure from the shards).
+  void submit(const Command& c) {
+    for (unsigned spins = 0; !try_submit(c); ) backoff(spins);
+  }
+
+  // True once every submitted command has been matched (or rejected).
+  bool idle() const { return processed_total() + rejected() == submitted_; }
+  std::uint64_t submitted() const { return submitted_; }
+
+  // ----- Consumer side (one thread per shard) -----
+  // Hands each pending event of `shard` to f(const Event&), symbol rewritten
+  // to its global id. Returns the number of events delivered.
+  template<typename F>
+  std::size_t poll(std::size_t shard, F&& f) {
+    Shard& s = *shards_[shard];
+    std::size_t n = 0;
+    while (auto ev = s.bus.try_poll()) {
+      ev->visit([&](auto& e){ e.symbol = s.global_of[e.symbol]; });
+      f(std::as_const(*ev));
+      ++n;
+    }
+    return n;
+  }
+
+  // ----- Introspection -----
+  std::size_t shards() const { return shards_.size(); }
+  std::size_t symbols() const { return routes_.size(); }
+  std::size_t shard_of(SymbolId g) const { return routes_[g].shard; }
+
+  std::uint64_t processed(std::size_t shard) const {
+    return shards_[shard]->processed.load(std::memory_order_acquire);
+  }
+  std::uint64_t processed_total() const {
+    std::uint64_t n = 0;
+    for (std::size_t i = 0; i < shards_.size(); ++i) n += processed(i);
+    return n;
+  }
+  // Commands dropped by the router for an unregistered symbol.
+  std::uint64_t rejected() const { return rejected_.load(std::memory_order_acquire); }
+
+  // Book of a global symbol. Only safe while the engine is quiescent
+  // (not started, stopped, or idle() with no concurrent submit()).
+  const lob::Book& book(SymbolId g) const {
+    const Route r = routes_[g];
+    return shards_[r.shard]->engine.book(r.local);
+  }
+  Qty book_level_qty(SymbolId g, lob::Side side, Price px) const {
+    const Route r = routes_[g];
+    return shards_[r.shard]->engine.book_level_qty(r.local, side, px);
+  }
+
+private:
+  static constexpr std::size_t kBatch = 64;   // commands per ring drain
+
+  struct Route { std::uint32_t shard; SymbolId local; };
+  using Routed = trace::Traced<Command>;   // a Command plus, when tracing, its trace id
+
+  struct Shard {
+    Shard(std::size_t cap, std::size_t bus_cap, const lob::Book::BookConfig& book)
+      : inbox(cap), bus(bus_cap), engine(bus, book) {}
+
+    SpscRing<Routed> inbox;            // router -> this shard
+    EventBus bus;                      // declared before engine (engine holds a ref)
+    MatchEngine engine;                // local symbol 0 is the engine's unused default
+    std::vector<SymbolId> global_of;   // local id -> global id
+    std::thread thread;
+    alignas(CACHELINE_SIZE) std::atomic<std::uint64_t> processed{0};   // written by the shard thread only
+  };
+
+  // Busy-wait step: spin briefly, then give the core away (oversubscribed hosts).
+  static void backoff(unsigned& spins) {
+    if (++spins < 64) cpu_relax();
+    else { spins = 0; std::this_thread::yield(); }
+  }
+
+  static void check_cpu(int cpu, const std::string& what) {
+    if (cpu >= 0 && !cpu::usable(cpu))
+      throw std::invalid_argument("ShardedEngine: " + what + " = " + std::to_string(cpu) + " is not a usable CPU");
+  }
+
+  // On the engine's own threads, where an exception would terminate. The
+  // CPU was checked in start(); one taken offline since leaves the thread
+  // unpinned.
+  static void pin(int cpu) noexcept {
+    if (cpu < 0) return;
+    try { cpu::pin_this_thread(cpu); } catch (const std::exception&) {}
+  }
+
+  void route_loop() {
+    pin(cfg_.router_cpu);
+    cpu::set_name("router");
+    for (unsigned spins = 0;;) {
+      // Read the flag before polling: once stopping is seen, an empty ring
+      // means every submitted command has been forwarded.
+      const bool stopping = stopping_.load(std::memory_order_acquire);
+      if (inbound_.try_pop_bulk(kBatch, [&](Routed&& c){ forward(c); })) { spins = 0; continue; }
+      if (stopping) break;
+      backoff(spins);
+    }
+    router_done_.store(true, std::memory_order_release);
+  }
+
+  void forward(Routed c) {
+    if (c.value.symbol >= routes_.size()) [[unlikely]] {
+      rejected_.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    const Route r = routes_[c.value.symbol];
+    c.value.symbol = r.local;
+    auto& inbox = shards_[r.shard]->inbox;
+    for (unsigned spins = 0; !inbox.try_push(c); ) backoff(spins);
+  }
+
+  void shard_loop(Shard& s, int cpu) {
+    pin(cpu);
+    cpu::set_name("shard");
+    std::uint64_t done = 0;
+    for (unsigned spins = 0;;) {
+      const bool router_done = router_done_.load(std::memory_order_acquire);
+      if (std::size_t n = s.inbox.try_pop_bulk(kBatch, [&](Routed&& c){ s.engine.apply(c.value, c.id); })) {
+        done += n;
+        s.processed.store(done, std::memory_order_release);
+        spins = 0;
+        continue;
+      }
+      if (router_done) break;
+      backoff(spins);
+    }
+  }
+
+  Config cfg_;
+  SpscRing<Routed> inbound_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::vector<Route> routes_;                         // global id -> (shard, local id)
+  std::unordered_map<std::string, SymbolId> ids_;     // name -> global id
+
+  std::thread router_;
+  std::atomic<bool> stopping_{false};
+  std::atomic<bool> router_done_{false};
+  std::atomic<std::uint64_t> rejected_{0};
+  std::uint64_t submitted_{0};                        // producer thread only
+  bool started_{false}, stopped_{false};
+};
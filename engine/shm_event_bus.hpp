@@ -0,0 +1,18 @@
+#pragma once
+#include "event_bus.hpp"
+#include "spsc/shm_spsc_ring.hpp"
+
+// EventBus whose ring lives in shared memory, for consumers (risk, recorder,
+// strategies) that run as separate processes on the same host:
+//
+//   // engine process
+//   ShmEventBus bus(ShmSpscRing<Event>::create("/mhft.events", 1u << 16));
+//   BasicMatchEngine<ShmEventBus> eng(bus);
+//
+//   // consumer process
+//   ShmEventBus bus(ShmSpscRing<Event>::attach("/mhft.events"));
+//   bus.poll_bulk(256, [](Event&& ev) { ... });
+//
+// Exactly one process publishes and one consumes. Event::seq is stamped by
+// the publishing process.
+using ShmEventBus = BasicEventBus<ShmSpscRing<Event>>;
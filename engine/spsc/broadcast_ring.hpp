@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "spsc_ring.hpp"   // CACHELINE_SIZE, is_pow2
+
+// Single-producer / multi-consumer broadcast ring (disruptor-style).
+//
+// Every consumer sees every item, in order, reading it in place from the
+// ring. Each consumer owns a cursor: how many items it has finished. The
+// producer may overwrite slot p only once every consumer has finished
+// p - capacity, so the slowest consumer gates it. A consumer can also be
+// made to run after others ("after" list): it never gets an item that its
+// upstream consumers are still processing (e.g. publish to clients only
+// after the journal consumer has persisted it).
+//
+// Consumers are registered before the first push. Then exactly one thread
+// pushes, and each consumer id is polled by exactly one thread.
+// T must be default-constructible and copy-assignable. Slots are reused
+// by assignment and are never destroyed in between.
+template<typename T>
+class BroadcastRing {
+public:
+  using ConsumerId = std::size_t;
+
+  explicit BroadcastRing(std::size_t capacity_pow2)
+    : cap_(capacity_pow2), mask_(capacity_pow2 - 1) {
+    if (!is_pow2(capacity_pow2)) throw std::invalid_argument("BroadcastRing capacity must be power-of-two");
+    buf_ = std::make_unique<T[]>(cap_);
+  }
+
+  BroadcastRing(const BroadcastRing&) = delete;
+  BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+  // ----- Setup (before the first push) -----
+  // New consumer that only sees items every consumer in `after` has finished.
+  ConsumerId add_consumer(std::initializer_list<ConsumerId> after = {}) {
+    assert(head_ == 0 && "register consumers before publishing");
+    const ConsumerId id = cons_.size();
+    auto c = std::make_unique<Consumer>();
+    for (ConsumerId d : after) {
+      if (d >= id) throw std::invalid_argument("BroadcastRing: dependency on an unknown consumer");
+      c->after.push_back(&cons_[d]->cursor);
+    }
+    cons_.push_back(std::move(c));
+    return id;
+  }
+
+  // ----- Producer -----
+  // Next slot to fill, or nullptr while the slowest consumer is a full ring
+  // behind. Write the item into it, then commit().
+  T* try_claim() {
+    if (head_ - gate_ == cap_) [[unlikely]] {
+      gate_ = min_cursor();                     // refresh only when it looks full
+      if (head_ - gate_ == cap_) return nullptr;
+    }
+    return &buf_[head_ & mask_];
+  }
+  void commit() { published_.store(++head_, std::memory_order_release); }
+
+  template<typename U>
+  bool try_push(U&& v) {
+    T* slot = try_claim();
+    if (!slot) return false;
+    *slot = std::forward<U>(v);
+    commit();
+    return true;
+  }
+
+  // Items pushed so far.
+  std::uint64_t published() const { return head_; }
+
+  // ----- Consumers -----
+  // Hands up to max_n pending items to f(const T&), in place, then releases
+  // them with a single store. Returns the count.
+  template<typename F>
+  std::size_t poll(ConsumerId id, std::size_t max_n, F&& f) {
+    Consumer& c = *cons_[id];
+    const std::uint64_t pos = c.cursor.load(std::memory_order_relaxed);
+    if (c.avail - pos < max_n) {                // cached limit can't fill the batch
+      c.avail = upstream(c);
+      if (pos == c.avail) return 0;
+    }
+    const std::size_t n = std::size_t(std::min<std::uint64_t>(max_n, c.avail - pos));
+    for (std::size_t i = 0; i < n; ++i) f(std::as_const(buf_[(pos + i) & mask_]));
+    c.cursor.store(pos + n, std::memory_order_release);
+    return n;
+  }
+
+  // Items consumer `id` has finished (any thread).
+  std::uint64_t cursor(ConsumerId id) const { return cons_[id]->cursor.load(std::memory_order_acquire); }
+  // Items consumer `id` has yet to see (any thread; a snapshot).
+  std::uint64_t lag(ConsumerId id) const {
+    return published_.load(std::memory_order_acquire) - cursor(id);
+  }
+
+  std::size_t consumers() const { return cons_.size(); }
+  std::size_t capacity() const { return cap_; }
+
+private:
+  struct alignas(CACHELINE_SIZE) Consumer {
+    std::atomic<std::uint64_t> cursor{0};        // written by this consumer only
+    std::uint64_t avail{0};                      // cached upstream limit (consumer only)
+    std::vector<const std::atomic<std::uint64_t>*> after;
+  };
+
+  // How far consumer c may read: published items its upstreams have finished.
+  std::uint64_t upstream(const Consumer& c) const {
+    std::uint64_t lim = published_.load(std::memory_order_acquire);
+    for (auto* d : c.after) lim = std::min(lim, d->load(std::memory_order_acquire));
+    return lim;
+  }
+
+  std::uint64_t min_cursor() const {
+    std::uint64_t m = head_;
+    for (auto const& c : cons_) m = std::min(m, c->cursor.load(std::memory_order_acquire));
+    return m;
+  }
+
+  const std::size_t cap_;
+  const std::size_t mask_;
+  std::unique_ptr<T[]> buf_;
+  std::vector<std::unique_ptr<Consumer>> cons_;
+
+  // Producer-only.
+  alignas(CACHELINE_SIZE) std::uint64_t head_{0};   // items written
+  std::uint64_t gate_{0};                           // cached min consumer cursor
+  // Read by every consumer.
+  alignas(CACHELINE_SIZE) std::atomic<std::uint64_t> published_{0};
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "spsc_ring.hpp"   // CACHELINE_SIZE, is_pow2
+
+// SpscRing with the same interface, tuned for cross-core traffic:
+// - Each side keeps a private copy of the other side's index and reloads
+//   the shared atomic only when the copy says full (producer) or empty
+//   (consumer), so in steady state neither side touches the other's line.
+// - Bulk push/pop publish their whole batch with one release store.
+// Each side's own index and its cached copy of the remote one share a cache
+// line that the other side never writes.
+template<typename T>
+class CachedSpscRing {
+public:
+  explicit CachedSpscRing(std::size_t capacity_pow2)
+    : cap_(capacity_pow2), mask_(capacity_pow2 - 1) {
+    if (!is_pow2(capacity_pow2)) throw std::invalid_argument("CachedSpscRing capacity must be power-of-two");
+    buf_ = static_cast<T*>(::operator new(sizeof(T) * cap_, std::align_val_t(alignof(T))));
+  }
+
+  ~CachedSpscRing() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      const std::size_t head = prod_.index.load(std::memory_order_relaxed);
+      for (std::size_t t = cons_.index.load(std::memory_order_relaxed); t != head; ++t) buf_[t & mask_].~T();
+    }
+    ::operator delete(buf_, std::align_val_t(alignof(T)));
+  }
+
+  CachedSpscRing(const CachedSpscRing&) = delete;
+  CachedSpscRing& operator=(const CachedSpscRing&) = delete;
+
+  // ----- Producer -----
+  template<typename U>
+  bool try_push(U&& v) {
+    const std::size_t head = prod_.index.load(std::memory_order_relaxed);
+    if (head - prod_.remote == cap_) [[unlikely]] {
+      prod_.remote = cons_.index.load(std::memory_order_acquire);
+      if (head - prod_.remote == cap_) return false;
+    }
+    new (buf_ + (head & mask_)) T(std::forward<U>(v));
+    prod_.index.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pushes up to max_n values from producer_fn() (returns T), committed with
+  // one store. Returns the count (0 when full).
+  template<typename F>
+  std::size_t try_push_bulk(std::size_t max_n, F producer_fn) {
+    static_assert(std::is_same_v<std::decay_t<std::invoke_result_t<F>>, T>, "producer_fn must return T");
+    const std::size_t head = prod_.index.load(std::memory_order_relaxed);
+    if (cap_ - (head - prod_.remote) < max_n) prod_.remote = cons_.index.load(std::memory_order_acquire);
+    const std::size_t n = std::min(max_n, cap_ - (head - prod_.remote));
+    for (std::size_t i = 0; i < n; ++i) new (buf_ + ((head + i) & mask_)) T(producer_fn());
+    if (n) prod_.index.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  // ----- Consumer -----
+  bool try_pop(T& out) {
+    const std::size_t tail = cons_.index.load(std::memory_order_relaxed);
+    if (tail == cons_.remote) [[unlikely]] {
+      cons_.remote = prod_.index.load(std::memory_order_acquire);
+      if (tail == cons_.remote) return false;
+    }
+    T* p = buf_ + (tail & mask_);
+    out = std::move(*p);
+    p->~T();
+    cons_.index.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pops up to max_n items into consumer_fn(T&&), released with one store.
+  template<typename F>
+  std::size_t try_pop_bulk(std::size_t max_n, F consumer_fn) {
+    const std::size_t tail = cons_.index.load(std::memory_order_relaxed);
+    if (cons_.remote - tail < max_n) cons_.remote = prod_.index.load(std::memory_order_acquire);
+    const std::size_t n = std::min(max_n, cons_.remote - tail);
+    for (std::size_t i = 0; i < n; ++i) {
+      T* p = buf_ + ((tail + i) & mask_);
+      consumer_fn(std::move(*p));
+      p->~T();
+    }
+    if (n) cons_.index.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  // ----- Either side (snapshots) -----
+  std::size_t size() const {
+    return prod_.index.load(std::memory_order_acquire) - cons_.index.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  bool full() const { return size() == cap_; }
+  std::size_t capacity() const { return cap_; }
+
+private:
+  struct alignas(CACHELINE_SIZE) Side {
+    std::atomic<std::size_t> index{0};   // this side's position (written by this side only)
+    std::size_t remote{0};               // this side's last view of the other index
+  };
+
+  Side prod_;   // index = head (next write)
+  Side cons_;   // index = tail (next read)
+  const std::size_t cap_;
+  const std::size_t mask_;
+  T* buf_{nullptr};
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include "mpsc_ring.hpp"
+#include "spsc_channel.hpp"   // BackpressureCfg, BpMode, push_with_backpressure
+#include "../common/metrics.hpp"
+
+// Many producer threads (e.g. one per order-entry session) feeding one
+// consumer (the matching thread) through an MpscRing, with SpscChannel's
+// backpressure policies. `stats` counters are shared by all producers.
+// In Hybrid mode producers park on one futex, woken (all of them) once the
+// consumer has drained the ring to low_wm.
+template<typename T>
+class MpscChannel {
+public:
+  MpscChannel(std::size_t cap_pow2, BackpressureCfg cfg, SpscStats* stats = nullptr)
+  : q_(cap_pow2), cfg_(cfg), stats_(stats) {}
+
+  // Producer-facing push (any thread) with the configured policy.
+  template<typename U>
+  bool push(U&& v, const std::atomic<bool>* stop_flag) {
+    return push_with_backpressure(q_, cfg_, stats_, stop_flag,
+                                  [&] { return q_.try_push(std::forward<U>(v)); }, &not_full_);
+  }
+
+  // Consumer side (one thread).
+  bool pop(T& out) {
+    const bool ok = q_.try_pop(out);
+    if (ok) on_pop(1);
+    return ok;
+  }
+
+  // Up to max_n items into f(T&&); stats updated once per batch.
+  template<typename F>
+  std::size_t pop_bulk(std::size_t max_n, F&& f) {
+    const std::size_t n = q_.try_pop_bulk(max_n, std::forward<F>(f));
+    if (n) on_pop(n);
+    return n;
+  }
+
+  std::size_t size() const { return q_.size(); }
+  std::size_t capacity() const { return q_.capacity(); }
+
+private:
+  void on_pop(std::size_t n) {
+    const std::size_t depth = q_.size();
+    if (cfg_.mode == BpMode::Hybrid && depth <= cfg_.low_wm) not_full_.notify();
+    if (stats_) {
+      stats_->pop_ok.fetch_add(n, std::memory_order_relaxed);
+      stats_->observe_depth(depth);
+    }
+  }
+
+  MpscRing<T>     q_;
+  BackpressureCfg cfg_;
+  SpscStats*      stats_; // not owned
+  Parker          not_full_;   // Hybrid mode: where producers park
+};
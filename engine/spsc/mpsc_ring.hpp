@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "spsc_ring.hpp"   // CACHELINE_SIZE, is_pow2
+
+// Bounded lock-free multi-producer / single-consumer ring (Vyukov).
+//
+// Every slot carries a sequence number that says whose turn it is:
+//   seq == pos        free for the producer that claims position pos
+//   seq == pos + 1    holds the item written at pos (consumer's turn)
+//   seq == pos + cap  consumed; free again for position pos + cap
+// Producers claim a position with one CAS on the shared enqueue index and
+// then write their slot without further contention. The single consumer
+// never needs a CAS.
+//
+// Items leave in claim order. If a producer has claimed position p but not
+// finished writing it, the consumer sees "empty" at p until it does, even
+// when later positions are already written.
+template<typename T>
+class MpscRing {
+public:
+  explicit MpscRing(std::size_t capacity_pow2)
+    : cap_(capacity_pow2), mask_(capacity_pow2 - 1) {
+    if (!is_pow2(capacity_pow2)) throw std::invalid_argument("MpscRing capacity must be power-of-two");
+    slots_ = std::make_unique<Slot[]>(cap_);
+    for (std::size_t i = 0; i < cap_; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  ~MpscRing() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (std::size_t pos = deq_.load(std::memory_order_relaxed);; ++pos) {
+        Slot& s = slots_[pos & mask_];
+        if (s.seq.load(std::memory_order_relaxed) != pos + 1) break;
+        s.item()->~T();
+      }
+    }
+  }
+
+  MpscRing(const MpscRing&) = delete;
+  MpscRing& operator=(const MpscRing&) = delete;
+
+  // ----- Producers (any number of threads) -----
+  // Non-blocking push; false if the ring is full. v is only consumed on success.
+  template<typename U>
+  bool try_push(U&& v) {
+    std::size_t pos = enq_.load(std::memory_order_relaxed);
+    Slot* s;
+    for (;;) {
+      s = &slots_[pos & mask_];
+      const std::size_t seq = s->seq.load(std::memory_order_acquire);
+      const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (dif == 0) {
+        if (enq_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (dif < 0) {
+        return false;                                   // a full lap behind the consumer
+      } else {
+        pos = enq_.load(std::memory_order_relaxed);     // another producer took pos
+      }
+    }
+    new (s->item()) T(std::forward<U>(v));
+    s->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // ----- Consumer (one thread) -----
+  bool try_pop(T& out) {
+    const std::size_t pos = deq_.load(std::memory_order_relaxed);
+    Slot& s = slots_[pos & mask_];
+    if (s.seq.load(std::memory_order_acquire) != pos + 1) return false;
+    T* p = s.item();
+    out = std::move(*p);
+    p->~T();
+    s.seq.store(pos + cap_, std::memory_order_release);
+    deq_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Pops up to max_n ready items into consumer_fn(T&&). Returns the count.
+  template<typename F>
+  std::size_t try_pop_bulk(std::size_t max_n, F consumer_fn) {
+    std::size_t pos = deq_.load(std::memory_order_relaxed);
+    std::size_t n = 0;
+    for (; n < max_n; ++n, ++pos) {
+      Slot& s = slots_[pos & mask_];
+      if (s.seq.load(std::memory_order_acquire) != pos + 1) break;
+      T* p = s.item();
+      consumer_fn(std::move(*p));
+      p->~T();
+      s.seq.store(pos + cap_, std::memory_order_release);
+    }
+    if (n) deq_.store(pos, std::memory_order_relaxed);
+    return n;
+  }
+
+  // Claimed minus consumed; includes pushes still being written. Snapshot.
+  std::size_t size() const {
+    const std::size_t d = deq_.load(std::memory_order_relaxed);
+    const std::size_t e = enq_.load(std::memory_order_relaxed);
+    return e > d ? std::min(e - d, cap_) : 0;
+  }
+  bool empty() const { return size() == 0; }
+  std::size_t capacity() const { return cap_; }
+
+private:
+  struct Slot {
+    std::atomic<std::size_t> seq{0};
+    alignas(T) unsigned char storage[sizeof(T)];
+    T* item() { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+  const std::size_t cap_;
+  const std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(CACHELINE_SIZE) std::atomic<std::size_t> enq_{0};   // producers (CAS)
+  alignas(CACHELINE_SIZE) std::atomic<std::size_t> deq_{0};   // consumer
+  CachelinePad pad_;
+};
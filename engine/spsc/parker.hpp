@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+  #include <climits>
+  #include <ctime>
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#include "spsc_ring.hpp"   // CACHELINE_SIZE
+
+// Where one side of a queue blocks until the other side changes it.
+// The waiter parks on a futex (Linux; elsewhere it sleeps for the timeout),
+// and notify() makes the syscall only while someone is parked, so the
+// common case is one uncontended RMW on a line only the notifier touches.
+//
+//   waiter:   wait([&]{ return !q.empty(); }, timeout_ns)
+//   notifier: <change the queue>; notify();
+//
+// Both sides do an acq_rel RMW on waiters_, so one of them comes first in
+// its modification order: either notify() sees the waiter and wakes it, or
+// the waiter's registration acquires the notifier's change and ready()
+// sees it. A wakeup cannot be lost between the check and the park.
+class Parker {
+public:
+  // Parks until notified, timeout_ns elapsed or a spurious wakeup; ready()
+  // is re-checked and returned. Does not park if ready() is already true.
+  template<typename Ready>
+  bool wait(Ready&& ready, std::uint64_t timeout_ns) {
+    waiters_.fetch_add(1, std::memory_order_acq_rel);
+    const std::uint32_t epoch = epoch_.load(std::memory_order_acquire);
+    bool ok = ready();
+    if (!ok) {
+      park(epoch, timeout_ns);
+      ok = ready();
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return ok;
+  }
+
+  // Call after every change a waiter may be waiting for.
+  void notify() {
+    if (waiters_.fetch_add(0, std::memory_order_acq_rel) == 0) [[likely]] return;
+    epoch_.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, INT_MAX,
+              nullptr, nullptr, 0);
+#endif
+  }
+
+private:
+  void park(std::uint32_t epoch, std::uint64_t timeout_ns) {
+#if defined(__linux__)
+    timespec ts{time_t(timeout_ns / 1000000000u), long(timeout_ns % 1000000000u)};
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch,
+              &ts, nullptr, 0);
+#else
+    (void)epoch;
+    std::this_thread::sleep_for(std::chrono::nanoseconds(timeout_ns));
+#endif
+  }
+
+  static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex word");
+  alignas(CACHELINE_SIZE) std::atomic<std::uint32_t> epoch_{0};   // bumped by notify() when parked
+  std::atomic<std::uint32_t> waiters_{0};
+};
@@ -0,0 +1,216 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "spsc_ring.hpp"          // CACHELINE_SIZE, is_pow2
+#include "../common/shm.hpp"
+
+// SpscRing whose indices and slots live in a shared-memory region, so the
+// producer and the consumer can be different processes on the same host.
+// The protocol is SpscRing's (head/tail counters, acquire/release), and
+// the data path makes no syscalls.
+//
+// Region layout (version 1):
+//   [0, 64)    ShmRingHeader fields below, immutable once `state` is ready
+//   [64, 128)  head (written by the producer only)
+//   [128, 192) tail (written by the consumer only)
+//   [data_offset, ...) capacity slots of T
+// attach() refuses a region whose magic, version, slot size/alignment or
+// size do not match what this build expects.
+//
+// T must be trivially copyable: slots hold plain bytes that the other
+// process reads, and nothing in the region is ever destroyed.
+struct alignas(CACHELINE_SIZE) ShmRingHeader {
+  static constexpr std::uint64_t kMagic = 0x474e49525446484dull;   // "MHFTRING" in memory
+  static constexpr std::uint32_t kVersion = 1;
+  static constexpr std::uint32_t kReady = 1;
+
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t data_offset;      // byte offset of slot 0
+  std::uint64_t capacity;
+  std::uint32_t elem_size;
+  std::uint32_t elem_align;
+  std::atomic<std::uint32_t> state;   // kReady, stored last by the creator
+
+  alignas(CACHELINE_SIZE) std::atomic<std::uint64_t> head;
+  alignas(CACHELINE_SIZE) std::atomic<std::uint64_t> tail;
+};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+              std::atomic<std::uint32_t>::is_always_lock_free,
+              "cross-process atomics must be lock-free");
+static_assert(sizeof(ShmRingHeader) == 3 * CACHELINE_SIZE, "ShmRingHeader layout changed: bump kVersion");
+
+template<typename T>
+class ShmSpscRing {
+  static_assert(std::is_trivially_copyable_v<T>, "ShmSpscRing needs a trivially copyable T");
+public:
+  static constexpr std::size_t data_offset() {
+    const std::size_t a = std::max<std::size_t>(CACHELINE_SIZE, alignof(T));
+    return (sizeof(ShmRingHeader) + a - 1) / a * a;
+  }
+  static constexpr std::size_t region_size(std::size_t capacity) {
+    return data_offset() + capacity * sizeof(T);
+  }
+
+  // ----- Creating a ring (usually the producer side) -----
+  // New named region ("/mhft.events"); see io::SharedMemory::create.
+  static ShmSpscRing create(const std::string& name, std::size_t capacity_pow2) {
+    check_capacity(capacity_pow2);
+    return ShmSpscRing(init(io::SharedMemory::create(name, region_size(capacity_pow2)), capacity_pow2));
+  }
+  // New anonymous region; share region().fd() with the other process.
+  static ShmSpscRing create_memfd(std::size_t capacity_pow2, const std::string& label = "mhft-ring") {
+    check_capacity(capacity_pow2);
+    return ShmSpscRing(init(io::SharedMemory::create_memfd(label, region_size(capacity_pow2)), capacity_pow2));
+  }
+
+  // ----- Attaching to an existing ring (usually the consumer side) -----
+  static ShmSpscRing attach(const std::string& name) {
+    return ShmSpscRing(validate(io::SharedMemory::open(name), name));
+  }
+  static ShmSpscRing attach_fd(int fd) {
+    return ShmSpscRing(validate(io::SharedMemory::from_fd(fd), "fd " + std::to_string(fd)));
+  }
+
+  ShmSpscRing(ShmSpscRing&&) noexcept = default;
+  ShmSpscRing& operator=(ShmSpscRing&&) noexcept = default;
+
+  // ----- Producer -----
+  template<typename U>
+  bool try_push(U&& v) {
+    T* slot = try_claim();
+    if (!slot) return false;
+    new (slot) T(std::forward<U>(v));
+    commit();
+    return true;
+  }
+
+  T* try_claim() {
+    const std::uint64_t head = hdr_->head.load(std::memory_order_relaxed);
+    const std::uint64_t tail = hdr_->tail.load(std::memory_order_acquire);
+    if (head - tail == cap_) [[unlikely]] return nullptr;
+    return buf_ + (head & mask_);
+  }
+
+  // Up to max_n free slots, contiguous in memory (stops at the wrap point).
+  std::size_t try_claim_n(std::size_t max_n, T** first) {
+    const std::uint64_t head = hdr_->head.load(std::memory_order_relaxed);
+    const std::uint64_t tail = hdr_->tail.load(std::memory_order_acquire);
+    const std::size_t idx = std::size_t(head & mask_);
+    const std::size_t n = std::min({max_n, std::size_t(cap_ - (head - tail)), std::size_t(cap_ - idx)});
+    *first = buf_ + idx;
+    return n;
+  }
+
+  void commit(std::size_t n = 1) {
+    hdr_->head.store(hdr_->head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+  }
+
+  // ----- Consumer -----
+  bool try_pop(T& out) {
+    const T* p = peek();
+    if (!p) return false;
+    out = *p;
+    release();
+    return true;
+  }
+
+  T* peek() {
+    const std::uint64_t tail = hdr_->tail.load(std::memory_order_relaxed);
+    const std::uint64_t head = hdr_->head.load(std::memory_order_acquire);
+    if (head == tail) [[unlikely]] return nullptr;
+    return buf_ + (tail & mask_);
+  }
+
+  // Up to max_n readable slots, contiguous in memory (stops at the wrap point).
+  std::size_t peek_n(std::size_t max_n, T** first) {
+    const std::uint64_t tail = hdr_->tail.load(std::memory_order_relaxed);
+    const std::uint64_t head = hdr_->head.load(std::memory_order_acquire);
+    const std::size_t idx = std::size_t(tail & mask_);
+    const std::size_t n = std::min({max_n, std::size_t(head - tail), std::size_t(cap_ - idx)});
+    *first = buf_ + idx;
+    return n;
+  }
+
+  void release(std::size_t n = 1) {
+    hdr_->tail.store(hdr_->tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+  }
+
+  template<typename F>
+  std::size_t try_pop_bulk(std::size_t max_n, F consumer_fn) {
+    std::size_t done = 0;
+    while (done < max_n) {
+      T* first = nullptr;
+      const std::size_t n = peek_n(max_n - done, &first);
+      if (n == 0) break;
+      for (std::size_t i = 0; i < n; ++i) consumer_fn(std::move(first[i]));
+      release(n);
+      done += n;
+    }
+    return done;
+  }
+
+  // ----- Either side (snapshots) -----
+  std::size_t size() const {
+    return std::size_t(hdr_->head.load(std::memory_order_acquire) - hdr_->tail.load(std::memory_order_acquire));
+  }
+  bool empty() const { return size() == 0; }
+  bool full() const { return size() == cap_; }
+  std::size_t capacity() const { return cap_; }
+
+  io::SharedMemory& region() { return shm_; }
+
+private:
+  explicit ShmSpscRing(io::SharedMemory shm)
+    : shm_(std::move(shm)),
+      hdr_(std::launder(reinterpret_cast<ShmRingHeader*>(shm_.data()))),
+      buf_(reinterpret_cast<T*>(shm_.data() + data_offset())),
+      cap_(std::size_t(hdr_->capacity)), mask_(cap_ - 1) {}
+
+  static void check_capacity(std::size_t cap) {
+    if (!is_pow2(cap)) throw std::invalid_argument("ShmSpscRing capacity must be power-of-two");
+  }
+
+  static io::SharedMemory init(io::SharedMemory shm, std::size_t cap) {
+    auto* h = new (shm.data()) ShmRingHeader{};
+    h->magic = ShmRingHeader::kMagic;
+    h->version = ShmRingHeader::kVersion;
+    h->data_offset = std::uint32_t(data_offset());
+    h->capacity = cap;
+    h->elem_size = std::uint32_t(sizeof(T));
+    h->elem_align = std::uint32_t(alignof(T));
+    h->state.store(ShmRingHeader::kReady, std::memory_order_release);
+    return shm;
+  }
+
+  static io::SharedMemory validate(io::SharedMemory shm, const std::string& what) {
+    auto bad = [&](const std::string& why) {
+      return std::runtime_error("ShmSpscRing(" + what + "): " + why);
+    };
+    if (shm.size() < sizeof(ShmRingHeader)) throw bad("region too small for a header");
+    const auto* h = std::launder(reinterpret_cast<const ShmRingHeader*>(shm.data()));
+    if (h->state.load(std::memory_order_acquire) != ShmRingHeader::kReady) throw bad("not initialised");
+    if (h->magic != ShmRingHeader::kMagic) throw bad("bad magic");
+    if (h->version != ShmRingHeader::kVersion)
+      throw bad("layout version " + std::to_string(h->version) + ", expected " +
+                std::to_string(ShmRingHeader::kVersion));
+    if (h->elem_size != sizeof(T) || h->elem_align != alignof(T) || h->data_offset != data_offset())
+      throw bad("slot type mismatch");
+    if (!is_pow2(std::size_t(h->capacity)) || shm.size() < region_size(std::size_t(h->capacity)))
+      throw bad("capacity does not fit the region");
+    return shm;
+  }
+
+  io::SharedMemory shm_;
+  ShmRingHeader* hdr_;
+  T* buf_;
+  std::size_t cap_;
+  std::size_t mask_;
+};
@@ -3,9 +3,11 @@
 #include <cstdint>
 #include <cstddef>   // std::size_t
 #include <utility>   // std::forward
+#include <new>       // placement new
 #include <thread>
 #include <chrono>
 #include "../spsc/spsc_ring.hpp"
+#include "../spsc/parker.hpp"
 #include "../common/metrics.hpp"
 
 #if defined(__x86_64__) || defined(_M_X64)
@@ -15,13 +17,21 @@
   static inline void cpu_relax() {}
 #endif
 
-enum class BpMode { Drop, Spin, Sleep };
+// Drop:   refuse the item when at the high watermark / full.
+// Spin:   busy-wait with cpu_relax until there is room.
+// Sleep:  sleep sleep_ns between checks.
+// Hybrid: spin spin_iters times, yield yield_iters times, then park on a
+//         futex the other side wakes (see Parker); also what pop_wait parks on.
+enum class BpMode { Drop, Spin, Sleep, Hybrid };
 
 struct BackpressureCfg {
   std::size_t high_wm;           // start applying backpressure at/above this depth
   std::size_t low_wm;            // hysteresis target (Spin/Sleep). Default = high_wm
   BpMode mode{BpMode::Drop};
   uint64_t sleep_ns{5000};       // Sleep mode only (5 µs)
+  uint32_t spin_iters{2000};     // Hybrid: cpu_relax rounds before yielding
+  uint32_t yield_iters{50};      // Hybrid: yields before parking
+  uint64_t park_ns{200000};      // Hybrid: longest single park (stop_flag latency)
 
   // Helpful ctor to set sensible defaults
   BackpressureCfg(std::size_t high,
@@ -34,6 +44,73 @@ struct BackpressureCfg {
       sleep_ns(ns) {}
 };
 
+// One idle step of a wait loop under cfg.mode; `n` counts the steps of
+// the current wait (start at 0). Hybrid parks on `parker` (if any) until
+// ready(); Drop has nothing to wait for and just yields.
+template<typename Ready>
+void idle_step(const BackpressureCfg& cfg, unsigned& n, Parker* parker, Ready&& ready, SpscStats* stats) {
+  switch (cfg.mode) {
+  case BpMode::Spin:
+    cpu_relax();
+    break;
+  case BpMode::Sleep:
+    std::this_thread::sleep_for(std::chrono::nanoseconds(cfg.sleep_ns));
+    break;
+  case BpMode::Hybrid:
+    if (n < cfg.spin_iters) { ++n; cpu_relax(); break; }
+    if (n < cfg.spin_iters + cfg.yield_iters || !parker) { ++n; std::this_thread::yield(); break; }
+    if (stats) stats->parks.fetch_add(1, std::memory_order_relaxed);
+    parker->wait(ready, cfg.park_ns);
+    break;
+  case BpMode::Drop:
+    std::this_thread::yield();
+    break;
+  }
+}
+
+// Backpressure policy shared by the channels: applies cfg around
+// try_push() (returns true once the item is in) using q.size() as the depth.
+// Returns false when the item was dropped or stop_flag was raised.
+// Hybrid mode parks on `room`, which the consumer must notify() after pops.
+template<typename Queue, typename TryPush>
+bool push_with_backpressure(Queue& q, const BackpressureCfg& cfg, SpscStats* stats,
+                            const std::atomic<bool>* stop_flag, TryPush&& try_push,
+                            Parker* room = nullptr) {
+  unsigned waits = 0;
+  for (;;) {
+    if (stop_flag && stop_flag->load(std::memory_order_relaxed)) {
+      return false;
+    }
+
+    const std::size_t depth = q.size();
+    if (stats) stats->observe_depth(depth);
+
+    // Early backpressure near watermark to keep latency predictable.
+    if (depth >= cfg.high_wm) {
+      if (cfg.mode == BpMode::Drop) {
+        if (stats) stats->drops_total.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else if (depth > cfg.low_wm) {
+        // wait until below low watermark or we manage to push
+        idle_step(cfg, waits, room, [&] { return q.size() <= cfg.low_wm; }, stats);
+        continue;
+      }
+    }
+
+    if (try_push()) {
+      if (stats) stats->push_ok.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    // Ring truly full. Apply policy even if below high_wm due to races.
+    if (cfg.mode == BpMode::Drop) {
+      if (stats) stats->drops_total.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    idle_step(cfg, waits, room, [&] { return q.size() < q.capacity(); }, stats);
+  }
+}
+
 template<typename T>
 class SpscChannel {
 public:
@@ -43,62 +120,72 @@ public:
   // Producer-facing push with backpressure policy.
   template<typename U>
   bool push(U&& v, const std::atomic<bool>* stop_flag ) {
-    for (;;) {
-      if (stop_flag && stop_flag->load(std::memory_order_relaxed)) {
-        return false;
-      }
-
-      const std::size_t depth = q_.size();
-      if (stats_) stats_->observe_depth(depth);
-
-      // Early backpressure near watermark to keep latency predictable.
-      if (depth >= cfg_.high_wm) {
-        if (cfg_.mode == BpMode::Drop) {
-          if (stats_) stats_->drops_total.fetch_add(1, std::memory_order_relaxed);
-          return false;
-        } else if (cfg_.mode == BpMode::Spin) {
-          // spin until below low watermark or we manage to push
-          if (depth > cfg_.low_wm) { cpu_relax(); continue; }
-        } else { // Sleep
-          if (depth > cfg_.low_wm) {
-            std::this_thread::sleep_for(std::chrono::nanoseconds(cfg_.sleep_ns));
-            continue;
-          }
-        }
-      }
-
-      if (q_.try_push(std::forward<U>(v))) {
-        if (stats_) stats_->push_ok.fetch_add(1, std::memory_order_relaxed);
-        return true;
-      }
+    return push_with(stop_flag, [&](T* slot) { new (slot) T(std::forward<U>(v)); });
+  }
 
-      // Ring truly full. Apply policy even if below high_wm due to races.
-      if (cfg_.mode == BpMode::Drop) {
-        if (stats_) stats_->drops_total.fetch_add(1, std::memory_order_relaxed);
-        return false;
-      } else if (cfg_.mode == BpMode::Spin) {
-        cpu_relax();
-      } else {
-        std::this_thread::sleep_for(std::chrono::nanoseconds(cfg_.sleep_ns));
-      }
-    }
+  // Same policy, but T is constructed from args directly in its ring slot.
+  template<typename... Args>
+  bool emplace(const std::atomic<bool>* stop_flag, Args&&... args) {
+    return push_with(stop_flag, [&](T* slot) { new (slot) T(std::forward<Args>(args)...); });
   }
 
   // Consumer-facing pop (just delegates, but tracks counters/gauge).
   bool pop(T& out) {
     const bool ok = q_.try_pop(out);
-    if (ok && stats_) {
-      stats_->pop_ok.fetch_add(1, std::memory_order_relaxed);
-      stats_->observe_depth(q_.size());
-    }
+    if (ok) on_pop();
     return ok;
   }
 
+  // Blocking pop: waits per cfg.mode until an item arrives (Hybrid parks
+  // until the producer's next push). False once stop_flag is raised.
+  bool pop_wait(T& out, const std::atomic<bool>* stop_flag) {
+    unsigned waits = 0;
+    while (!pop(out)) {
+      if (stop_flag && stop_flag->load(std::memory_order_relaxed)) return false;
+      idle_step(cfg_, waits, &not_empty_, [&] { return !q_.empty(); }, stats_);
+    }
+    return true;
+  }
+
+  // Zero-copy consume: read the front element in place, then release() it.
+  const T* peek() { return q_.peek(); }
+  void release() {
+    q_.release();
+    on_pop();
+  }
+
   std::size_t size() const { return q_.size(); }
   std::size_t capacity() const { return q_.capacity(); }
 
 private:
+  // Backpressure loop around claim/commit; construct(T*) builds the element.
+  template<typename Construct>
+  bool push_with(const std::atomic<bool>* stop_flag, Construct&& construct) {
+    return push_with_backpressure(q_, cfg_, stats_, stop_flag, [&] {
+      T* slot = q_.try_claim();
+      if (!slot) return false;
+      construct(slot);
+      q_.commit();
+      if (cfg_.mode == BpMode::Hybrid) not_empty_.notify();
+      return true;
+    }, &not_full_);
+  }
+
+  // A parked producer is woken once the depth is back at low_wm, not on
+  // every pop while it drains (one futex wake per drain, not per item).
+  void on_pop() {
+    const std::size_t depth = q_.size();
+    if (cfg_.mode == BpMode::Hybrid && depth <= cfg_.low_wm) not_full_.notify();
+    if (stats_) {
+      stats_->pop_ok.fetch_add(1, std::memory_order_relaxed);
+      stats_->observe_depth(depth);
+    }
+  }
+
   SpscRing<T>    q_;
   BackpressureCfg cfg_;
   SpscStats*     stats_; // not owned
+  // Hybrid mode only: the consumer parks on not_empty_, the producer on not_full_.
+  Parker         not_empty_;
+  Parker         not_full_;
 };
@@ -7,6 +7,7 @@
 #include <new>
 #include <utility>
 #include <stdexcept>  // for std::invalid_argument
+#include <algorithm>  // for std::min
 
 #ifndef CACHELINE_SIZE
 #define CACHELINE_SIZE 64
@@ -21,9 +22,9 @@ class SpscRing {
 public:
     explicit SpscRing(std::size_t capacity_pow2)
       : cap_(capacity_pow2), mask_(capacity_pow2 - 1),
-        buf_(static_cast<T*>(::operator new(sizeof(T) * capacity_pow2))) {
+        buf_(static_cast<T*>(::operator new(sizeof(T) * capacity_pow2, std::align_val_t(alignof(T))))) {
         if (!is_pow2(capacity_pow2)) {
-            ::operator delete(buf_);
+            ::operator delete(buf_, std::align_val_t(alignof(T)));
             throw std::invalid_argument("SpscRing capacity must be power-of-two");
         }
         head_.store(0, std::memory_order_relaxed);
@@ -39,7 +40,7 @@ public:
             buf_[idx].~T(); // call destructor for element T in that slot
             ++tail;
         }
-        ::operator delete(buf_); // free space after we remove elements
+        ::operator delete(buf_, std::align_val_t(alignof(T))); // free space after we remove elements
     }
 
     SpscRing(const SpscRing&) = delete;
@@ -79,6 +80,73 @@ public:
         return true;
     }
 
+    // ----- Zero-copy producer: claim a slot, construct in it, commit -----
+
+    // Raw storage for the next element, or nullptr if full. Construct a T
+    // there (placement new), then commit(). Nothing is visible before commit.
+    T* try_claim() {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        if (head - tail == cap_) [[unlikely]]
+            return nullptr;
+        return buf_ + (head & mask_);
+    }
+
+    // Up to max_n free slots that are contiguous in memory (stops at the
+    // wrap point): *first gets the first one, the count is returned.
+    std::size_t try_claim_n(std::size_t max_n, T** first) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        std::size_t idx = head & mask_;
+        std::size_t n = std::min({max_n, cap_ - (head - tail), cap_ - idx});
+        *first = buf_ + idx;
+        return n;
+    }
+
+    // Publish the next n claimed slots (all constructed).
+    void commit(std::size_t n = 1) {
+        head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        T* slot = try_claim();
+        if (!slot) return false;
+        new (slot) T(std::forward<Args>(args)...);
+        commit();
+        return true;
+    }
+
+    // ----- Zero-copy consumer: read in place, then release -----
+
+    // Front element, or nullptr if empty. Valid until release().
+    T* peek() {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order_acquire);
+        if (head == tail) [[unlikely]]
+            return nullptr;
+        return buf_ + (tail & mask_);
+    }
+
+    // Up to max_n readable elements, contiguous in memory (stops at the wrap
+    // point): *first gets the front one, the count is returned.
+    std::size_t peek_n(std::size_t max_n, T** first) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order_acquire);
+        std::size_t idx = tail & mask_;
+        std::size_t n = std::min({max_n, head - tail, cap_ - idx});
+        *first = buf_ + idx;
+        return n;
+    }
+
+    // Destroy the n front elements and hand their slots back (one store).
+    void release(std::size_t n = 1) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (std::size_t i = 0; i < n; ++i) buf_[(tail + i) & mask_].~T();
+        tail_.store(tail + n, std::memory_order_release);
+    }
+
     // Optional: bulk helpers (best-effort)
 
     // Generates up to max_n items via producer_fn() and pushes them.
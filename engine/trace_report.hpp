@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include "common/metrics.hpp"
+#include "common/trace.hpp"
+
+// ---- Per-stage latency from a trace file (common/trace.hpp) ----
+//
+// Per command, from its stamps:
+//   queue       ingress -> submit_begin (queues, routing, journal append)
+//   submit      submit_begin -> submit_end (the Book call, fills published inline)
+//   publish     submit_end -> its last publish, when that comes after the
+//               Book call (book deltas, cancel events)
+//   end_to_end  ingress -> the last poll of its events
+// Per event:
+//   bus         publish -> poll
+struct StageBreakdown {
+  LatencyHistogram queue, submit, publish, bus, end_to_end;
+  std::uint64_t commands{0};     // ids with an ingress stamp
+  std::uint64_t no_book_call{0}; // ...but no submit stamps (e.g. replace of an unknown id)
+  std::uint64_t events{0};       // publish stamps
+  std::uint64_t unpolled{0};     // ...never polled (still on the bus, or polled untraced)
+
+  explicit StageBreakdown(const trace::TraceFile& tf);
+};
+
+inline StageBreakdown::StageBreakdown(const trace::TraceFile& tf) {
+  struct Cmd { std::uint64_t ingress{0}, begin{0}, end{0}, last_pub{0}, last_poll{0}; };
+  struct Pub { std::uint64_t id, tsc; bool polled; };
+  struct BusSeq {
+    std::uint32_t tag; std::uint64_t seq;
+    bool operator==(const BusSeq&) const = default;
+  };
+  struct BusSeqHash {
+    std::size_t operator()(const BusSeq& k) const { return std::size_t(k.seq * 0x9e3779b97f4a7c15ull ^ k.tag); }
+  };
+
+  std::unordered_map<std::uint64_t, Cmd> cmds;
+  std::unordered_map<BusSeq, Pub, BusSeqHash> pubs;
+  cmds.reserve(tf.size() / 4);
+  pubs.reserve(tf.size() / 4);
+
+  for (std::size_t i = 0; i < tf.size(); ++i) {
+    const trace::Record& r = tf[i];
+    switch (r.stage) {
+      case trace::Stage::Ingress:     cmds[r.id].ingress = r.tsc; break;
+      case trace::Stage::SubmitBegin: cmds[r.id].begin = r.tsc; break;
+      case trace::Stage::SubmitEnd:   cmds[r.id].end = r.tsc; break;
+      case trace::Stage::Publish: {
+        Cmd& c = cmds[r.id];
+        c.last_pub = std::max(c.last_pub, r.tsc);
+        pubs[BusSeq{r.tag, r.aux}] = Pub{r.id, r.tsc, false};
+        break;
+      }
+      case trace::Stage::Poll: break;
+    }
+  }
+
+  const double k = tf.ns_per_tick();
+  auto ns = [k](std::uint64_t t0, std::uint64_t t1) { return t1 > t0 ? std::uint64_t(double(t1 - t0) * k) : 0; };
+
+  for (std::size_t i = 0; i < tf.size(); ++i) {
+    const trace::Record& r = tf[i];
+    if (r.stage != trace::Stage::Poll) continue;
+    auto it = pubs.find(BusSeq{r.tag, r.aux});
+    if (it == pubs.end() || r.tsc < it->second.tsc) continue;
+    it->second.polled = true;
+    bus.record(ns(it->second.tsc, r.tsc));
+    Cmd& c = cmds[it->second.id];
+    c.last_poll = std::max(c.last_poll, r.tsc);
+  }
+
+  events = pubs.size();
+  for (auto const& [key, p] : pubs) unpolled += !p.polled;
+
+  for (auto const& [id, c] : cmds) {
+    if (!c.ingress) continue;
+    ++commands;
+    if (!c.begin || !c.end) { ++no_book_call; continue; }
+    queue.record(ns(c.ingress, c.begin));
+    submit.record(ns(c.begin, c.end));
+    if (c.last_pub > c.end) publish.record(ns(c.end, c.last_pub));
+    if (c.last_poll > c.ingress) end_to_end.record(ns(c.ingress, c.last_poll));
+  }
+}
+
+inline std::ostream& operator<<(std::ostream& os, const StageBreakdown& b) {
+  os << "commands=" << b.commands << " (no book call " << b.no_book_call << ") events=" << b.events
+     << " (unpolled " << b.unpolled << ")\n";
+  auto row = [&](const char* name, const LatencyHistogram& h) {
+    os << "  " << name << " n=" << h.count() << " " << h.summary() << "\n";
+  };
+  row("queue      ", b.queue);
+  row("submit     ", b.submit);
+  row("publish    ", b.publish);
+  row("bus        ", b.bus);
+  row("end_to_end ", b.end_to_end);
+  return os;
+}
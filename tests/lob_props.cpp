@@ -6,8 +6,13 @@
 
 using namespace lob;
 
-int main() {
-  Book book;
+static int run(LadderKind kind, LevelQueue queue) {
+  Book::BookConfig cfg;
+  cfg.ladder = kind;
+  cfg.queue = queue;
+  cfg.depth_tree = true;                   // also cross-checks the depth tree
+  cfg.flat_ticks = 64;                     // small window: exercises re-centring
+  Book book(cfg);
   std::mt19937_64 rng(42);
   std::uniform_int_distribution<int> side_d(0,1);
   std::uniform_int_distribution<int> px_d(1000,1100);
@@ -56,12 +61,20 @@ int main() {
 
     auto errs = book.check_invariants();
     if (!errs.empty()) {
-      std::cerr << "Invariant failure at step " << i << ":\n";
+      std::cerr << "Invariant failure (" << ladder_str(kind) << "," << level_queue_str(queue)
+                << ") at step " << i << ":\n";
       for (auto& e : errs) std::cerr << "  - " << e << "\n";
       return 1;
     }
   }
 
-  std::cout << "lob_props: OK\n";
+  std::cout << "lob_props[" << ladder_str(kind) << "," << level_queue_str(queue) << "]: OK\n";
+  return 0;
+}
+
+int main() {
+  for (auto kind : {LadderKind::Map, LadderKind::Flat})
+    for (auto queue : {LevelQueue::List, LevelQueue::Ring})
+      if (int rc = run(kind, queue)) return rc;
   return 0;
 }
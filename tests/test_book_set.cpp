@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "lob/book_set.hpp"
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+
+using namespace lob;
+
+TEST(BookSet, Dense_ids_and_name_lookup) {
+  BookSet set;
+  EXPECT_EQ(set.add("AAPL"), 0u);
+  EXPECT_EQ(set.add("MSFT"), 1u);
+  EXPECT_EQ(set.add("AAPL"), 0u);          // idempotent
+  EXPECT_EQ(set.size(), 2u);
+  EXPECT_EQ(*set.find("MSFT"), 1u);
+  EXPECT_FALSE(set.find("TSLA").has_value());
+  EXPECT_EQ(set.name(1), "MSFT");
+}
+
+// Growing the array moves Books; resting orders must survive intact.
+TEST(BookSet, Books_survive_array_growth) {
+  for (auto queue : {LevelQueue::List, LevelQueue::Ring}) {
+    Book::BookConfig cfg;
+    cfg.ladder = LadderKind::Flat;
+    cfg.queue = queue;
+    cfg.depth_tree = true;
+    BookSet set(cfg);
+    for (int s = 0; s < 200; ++s) {
+      SymbolId id = set.add("S" + std::to_string(s));
+      for (OrderId o = 1; o <= 5; ++o)
+        set[id].submit(1, Side::Ask, 100 + Price(o % 2), 2, o, Book::OrderType::Limit, Book::TimeInForce::Day);
+    }
+    for (auto const& b : set) {
+      auto errs = b.check_invariants();
+      ASSERT_TRUE(errs.empty()) << errs.front();
+      EXPECT_EQ(b.asks_total_, 10);
+    }
+    auto r = set[123].submit(2, Side::Bid, 100, 3, 99, Book::OrderType::Limit, Book::TimeInForce::IOC);
+    ASSERT_EQ(r.fills.size(), 2u);
+    EXPECT_EQ(r.fills[0].maker_id, 2u);
+    EXPECT_EQ(set[124].asks_total_, 10);
+  }
+}
+
+TEST(BookSet, MatchEngine_routes_by_symbol_and_tags_events) {
+  EventBus bus(1 << 12);
+  MatchEngine eng(bus);
+  const SymbolId a = eng.add_symbol("AAA");
+  const SymbolId b = eng.add_symbol("BBB");
+  ASSERT_NE(a, b);
+
+  // Same order id in two books is fine: ids are per instrument.
+  eng.add(a, 1, 7, Side::Sell, 100, 5);
+  eng.add(b, 1, 7, Side::Sell, 100, 5);
+  eng.add(b, 2, 8, Side::Buy, 100, 2);
+  eng.cancel(a, 7);
+
+  EXPECT_EQ(eng.book_level_qty(a, Side::Sell, 100), 0);
+  EXPECT_EQ(eng.book_level_qty(b, Side::Sell, 100), 3);
+  EXPECT_EQ(eng.book().asks_total_, 0);     // symbol 0 untouched
+
+  int fills = 0, cancels = 0;
+  while (auto ev = bus.try_poll()) {
+    if (auto* f = ev->get_if<FillEvent>()) { ++fills; EXPECT_EQ(f->symbol, b); }
+    if (auto* c = ev->get_if<CancelEvent>()) { ++cancels; EXPECT_EQ(c->symbol, a); }
+  }
+  EXPECT_EQ(fills, 1);
+  EXPECT_EQ(cancels, 1);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "../engine/broadcast_bus.hpp"
+#include "../engine/match_engine.hpp"
+#include "../engine/spsc/broadcast_ring.hpp"
+
+TEST(BroadcastRing, Every_consumer_sees_every_item_and_the_slowest_gates) {
+  BroadcastRing<std::uint64_t> r(8);
+  const auto a = r.add_consumer(), b = r.add_consumer();
+  for (std::uint64_t i = 0; i < 8; ++i) ASSERT_TRUE(r.try_push(i));
+  EXPECT_FALSE(r.try_push(8));                       // both a full ring behind
+
+  std::vector<std::uint64_t> seen_a, seen_b;
+  EXPECT_EQ(r.poll(a, 100, [&](std::uint64_t v){ seen_a.push_back(v); }), 8u);
+  EXPECT_FALSE(r.try_push(8));                       // b still gates
+  EXPECT_EQ(r.poll(b, 3, [&](std::uint64_t v){ seen_b.push_back(v); }), 3u);
+  EXPECT_EQ(r.lag(b), 5u);
+  for (std::uint64_t i = 8; i < 11; ++i) ASSERT_TRUE(r.try_push(i));
+  EXPECT_FALSE(r.try_push(11));
+  r.poll(a, 100, [&](std::uint64_t v){ seen_a.push_back(v); });
+  r.poll(b, 100, [&](std::uint64_t v){ seen_b.push_back(v); });
+  EXPECT_EQ(seen_a, (std::vector<std::uint64_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+  EXPECT_EQ(seen_a, seen_b);
+  EXPECT_EQ(r.poll(a, 100, [](std::uint64_t){}), 0u);
+}
+
+TEST(BroadcastRing, Dependent_consumer_trails_its_upstream) {
+  BroadcastRing<std::uint64_t> r(16);
+  const auto journal = r.add_consumer();
+  EXPECT_THROW(r.add_consumer({5}), std::invalid_argument);   // not registered (yet)
+  const auto md = r.add_consumer({journal});
+  for (std::uint64_t i = 0; i < 10; ++i) r.try_push(i);
+  EXPECT_EQ(r.poll(md, 100, [](std::uint64_t){}), 0u);   // journal hasn't run
+  EXPECT_EQ(r.poll(journal, 4, [](std::uint64_t){}), 4u);
+  EXPECT_EQ(r.poll(md, 100, [](std::uint64_t){}), 4u);
+}
+
+// One producer, three consumer threads (one downstream of another): all see
+// the same stream in order, and the dependent one never overtakes.
+TEST(BroadcastRing, Threaded_stream_with_dependency) {
+  constexpr std::uint64_t N = 300000;
+  BroadcastRing<std::uint64_t> r(1024);
+  const auto c0 = r.add_consumer(), c1 = r.add_consumer(), c2 = r.add_consumer({c0});
+  std::atomic<bool> overtook{false};
+  std::vector<std::uint64_t> sums(3, 0);
+  auto run = [&](std::size_t id, bool check_dep) {
+    std::uint64_t expect = 0;
+    while (expect < N) {
+      const std::size_t n = r.poll(id, 64, [&](std::uint64_t v){
+        if (v != expect) overtook.store(true);
+        if (check_dep && r.cursor(c0) <= v) overtook.store(true);
+        sums[id] += v;
+        ++expect;
+      });
+      if (!n) std::this_thread::yield();
+    }
+  };
+  std::thread t0(run, c0, false), t1(run, c1, false), t2(run, c2, true);
+  for (std::uint64_t i = 0; i < N; ++i)
+    while (!r.try_push(i)) std::this_thread::yield();
+  t0.join(); t1.join(); t2.join();
+  EXPECT_FALSE(overtook.load());
+  for (auto s : sums) EXPECT_EQ(s, N * (N - 1) / 2);
+}
+
+TEST(BroadcastBus, Engine_publishes_once_for_all_subscribers) {
+  BroadcastBus bus(1u << 10);
+  const auto risk = bus.subscribe(), md = bus.subscribe(), drop_copy = bus.subscribe({risk});
+  BasicMatchEngine<BroadcastBus> eng(bus);
+  eng.add(1, 1, Side::Ask, 101, 5);
+  eng.add(2, 2, Side::Bid, 101, 3);
+  for (auto id : {risk, md, drop_copy}) {
+    std::vector<Event> got;
+    bus.poll(id, 100, [&](const Event& e){ got.push_back(e); });
+    ASSERT_EQ(got.size(), 3u) << "subscriber " << id;   // add level, fill, level
+    EXPECT_EQ(got[1].get<FillEvent>().qty, 3);
+    for (std::size_t i = 0; i < got.size(); ++i) EXPECT_EQ(got[i].seq, i + 1);
+  }
+  EXPECT_EQ(bus.published(), 3u);
+  EXPECT_EQ(bus.dropped(), 0u);
+}
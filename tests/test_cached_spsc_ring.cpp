@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../engine/spsc/cached_spsc_ring.hpp"
+
+TEST(CachedSpscRing, Fifo_across_wraparound_and_full_empty_edges) {
+  CachedSpscRing<int> q(8);
+  int x = 0;
+  EXPECT_FALSE(q.try_pop(x));
+  int next_in = 0, next_out = 0;
+  for (int round = 0; round < 100; ++round) {
+    while (q.try_push(next_in)) ++next_in;
+    EXPECT_TRUE(q.full());
+    for (int k = 0; k < 3 + round % 6; ++k) {
+      ASSERT_TRUE(q.try_pop(x));
+      ASSERT_EQ(x, next_out++);
+    }
+  }
+  while (q.try_pop(x)) ASSERT_EQ(x, next_out++);
+  EXPECT_EQ(next_out, next_in);
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(CachedSpscRing, Bulk_push_pop_respect_space_and_order) {
+  CachedSpscRing<std::uint64_t> q(16);
+  std::uint64_t in = 0;
+  EXPECT_EQ(q.try_push_bulk(10, [&]{ return in++; }), 10u);
+  EXPECT_EQ(q.try_push_bulk(10, [&]{ return in++; }), 6u);    // only 6 free
+  EXPECT_EQ(q.try_push_bulk(1, [&]{ return in++; }), 0u);
+  std::vector<std::uint64_t> out;
+  EXPECT_EQ(q.try_pop_bulk(5, [&](std::uint64_t&& v){ out.push_back(v); }), 5u);
+  EXPECT_EQ(q.try_push_bulk(100, [&]{ return in++; }), 5u);
+  EXPECT_EQ(q.try_pop_bulk(100, [&](std::uint64_t&& v){ out.push_back(v); }), 16u);
+  ASSERT_EQ(out.size(), 21u);
+  for (std::uint64_t i = 0; i < out.size(); ++i) EXPECT_EQ(out[i], i);
+}
+
+TEST(CachedSpscRing, Destroys_what_is_left) {
+  auto counter = std::make_shared<int>(0);
+  {
+    CachedSpscRing<std::shared_ptr<int>> q(4);
+    q.try_push(counter);
+    q.try_push(counter);
+    std::shared_ptr<int> out;
+    q.try_pop(out);
+    EXPECT_EQ(counter.use_count(), 3);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(CachedSpscRing, Threaded_transfer_single_and_bulk) {
+  constexpr std::uint64_t N = 500000;
+  CachedSpscRing<std::uint64_t> q(256);
+  std::thread prod([&]{
+    std::uint64_t i = 0;
+    while (i < N) {
+      if (i % 3 == 0) { if (q.try_push(i)) ++i; else std::this_thread::yield(); continue; }
+      const std::uint64_t want = std::min<std::uint64_t>(17, N - i);
+      if (!q.try_push_bulk(want, [&]{ return i++; })) std::this_thread::yield();
+    }
+  });
+  std::uint64_t expect = 0;
+  bool ordered = true;
+  while (expect < N) {
+    std::uint64_t v;
+    if (expect % 2 == 0 && q.try_pop(v)) { ordered &= v == expect++; continue; }
+    if (!q.try_pop_bulk(33, [&](std::uint64_t&& w){ ordered &= w == expect++; })) std::this_thread::yield();
+  }
+  prod.join();
+  EXPECT_TRUE(ordered);
+  EXPECT_TRUE(q.empty());
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../engine/conflator.hpp"
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+
+namespace {
+
+using Mirror = std::map<std::pair<Side, Price>, Qty>;
+
+Mirror levels_of(const lob::Book& b) {
+  Mirror m;
+  b.bids_.walk([&](lob::PriceLevel const& l){ m[{Side::Bid, l.price}] = l.total_qty; return true; });
+  b.asks_.walk([&](lob::PriceLevel const& l){ m[{Side::Ask, l.price}] = l.total_qty; return true; });
+  return m;
+}
+
+Conflator::Config conflation(std::size_t max_batch, std::uint64_t window_ns, std::size_t max_levels = 4096) {
+  Conflator::Config cfg;
+  cfg.max_batch = max_batch;
+  cfg.window_ns = window_ns;
+  cfg.max_levels = max_levels;
+  return cfg;
+}
+
+struct Collect {
+  std::vector<Event>* out;
+  void operator()(const Event& e) const { out->push_back(e); }
+};
+
+} // namespace
+
+TEST(Conflator, Burst_on_one_level_becomes_one_update) {
+  EventBus bus(1u << 12);
+  MatchEngine eng(bus);
+  for (OrderId id = 1; id <= 50; ++id) eng.add(1, id, Side::Ask, 101, 2);   // 50 updates @101
+  eng.add(2, 100, Side::Bid, 101, 30);                                       // 15 fills, one update
+
+  Conflator conf(bus, conflation(1024, 0));
+  std::vector<Event> out;
+  while (conf.pump(Collect{&out})) {}
+
+  std::size_t fills = 0, changes = 0;
+  for (auto const& e : out) {
+    fills += e.is<FillEvent>();
+    if (auto* c = e.get_if<BookChangeEvent>()) {
+      ++changes;
+      EXPECT_EQ(c->px, 101);
+      EXPECT_EQ(c->level_qty, 70);
+    }
+  }
+  EXPECT_EQ(fills, 15u);       // never merged
+  EXPECT_EQ(changes, 1u);
+  const auto s = conf.stats();
+  EXPECT_EQ(s.book_in, 51u);
+  EXPECT_EQ(s.book_out, 1u);
+  EXPECT_EQ(s.conflated(), 50u);
+  EXPECT_EQ(s.passed, 15u);
+}
+
+TEST(Conflator, Window_holds_levels_until_it_expires_or_fills_up) {
+  EventBus bus(1u << 10);
+  MatchEngine eng(bus);
+  eng.add(1, 1, Side::Bid, 99, 5);
+  eng.add(1, 2, Side::Bid, 99, 5);
+
+  Conflator conf(bus, conflation(64, 60'000'000'000ull));   // a minute: never expires here
+  std::vector<Event> out;
+  EXPECT_EQ(conf.pump(Collect{&out}), 2u);
+  EXPECT_TRUE(out.empty());
+  EXPECT_EQ(conf.stats().held, 1u);
+  conf.flush(Collect{&out});
+  ASSERT_EQ(out.size(), 1u);
+  EXPECT_EQ(out[0].get<BookChangeEvent>().level_qty, 10);
+  EXPECT_EQ(conf.stats().held, 0u);
+
+  // max_levels forces a flush mid-window, before the third distinct level.
+  Conflator small(bus, conflation(64, 60'000'000'000ull, 2));
+  eng.add(1, 3, Side::Bid, 98, 1);
+  eng.add(1, 4, Side::Bid, 97, 1);
+  eng.add(1, 5, Side::Bid, 96, 1);
+  out.clear();
+  small.pump(Collect{&out});
+  ASSERT_EQ(out.size(), 2u);
+  EXPECT_EQ(out[0].get<BookChangeEvent>().px, 98);
+  EXPECT_EQ(out[1].get<BookChangeEvent>().px, 97);
+  EXPECT_EQ(small.stats().held, 1u);
+}
+
+// Whatever the batching, a consumer of the conflated stream sees every fill
+// and, after each flush, exactly the book's levels.
+TEST(Conflator, Conflated_stream_keeps_fills_and_converges_to_the_book) {
+  for (std::size_t batch : {1u, 7u, 256u}) {
+    EventBus bus(1u << 16);
+    MatchEngine eng(bus);
+    Mirror mirror;
+    std::uint64_t fills_out = 0, fill_qty = 0;
+    auto sink = [&](const Event& e){
+      if (auto* f = e.get_if<FillEvent>()) { ++fills_out; fill_qty += std::uint64_t(f->qty); }
+      else if (auto* c = e.get_if<BookChangeEvent>()) {
+        if (c->level_qty == 0) mirror.erase({c->side, c->px});
+        else mirror[{c->side, c->px}] = c->level_qty;
+      }
+    };
+
+    std::mt19937_64 rng(batch);
+    OrderId next = 1;
+    std::uint64_t fills_in = 0;
+    for (int round = 0; round < 200; ++round) {
+      for (int i = 0; i < 50; ++i) {
+        const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+        const Price px = 100 + Price(rng() % 7) - 3;
+        switch (rng() % 6) {
+          case 0:  eng.cancel(1 + rng() % next); break;
+          case 1:  eng.market(1 + rng() % 4, next++, s, 1 + Qty(rng() % 20)); break;
+          default: eng.add(1 + rng() % 4, next++, s, px, 1 + Qty(rng() % 10)); break;
+        }
+      }
+      // Count what the engine produced, then feed it through the conflator.
+      EventBus replay(1u << 12);
+      while (auto ev = bus.try_poll()) {
+        fills_in += ev->is<FillEvent>();
+        ASSERT_TRUE(replay.try_publish(*ev));
+      }
+      Conflator stage(replay, conflation(batch, 0, 16));
+      while (stage.pump(sink)) {}
+      ASSERT_EQ(stage.stats().held, 0u);
+      ASSERT_EQ(mirror, levels_of(eng.book())) << "batch " << batch << " round " << round;
+    }
+    EXPECT_EQ(fills_out, fills_in);
+    EXPECT_GT(fill_qty, 0u);
+  }
+}
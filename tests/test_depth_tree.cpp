@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include "lob/book.hpp"
+
+using namespace lob;
+
+TEST(DepthTree, Prefix_and_sweep_follow_priority_order) {
+  DepthTree<Side::Ask> asks(64);
+  DepthTree<Side::Bid> bids(64);
+  Ladder<Side::Ask> la; Ladder<Side::Bid> lb;
+  for (auto [px, q] : {std::pair<Price, Qty>{100, 5}, {102, 3}, {105, 10}}) {
+    la.get_or_add(px).total_qty = q; asks.rebuild(la, px);
+    lb.get_or_add(px).total_qty = q; bids.rebuild(lb, px);
+  }
+  EXPECT_EQ(asks.qty_through(99), 0);
+  EXPECT_EQ(asks.qty_through(102), 8);
+  EXPECT_EQ(asks.qty_through(1000), 18);
+  EXPECT_EQ(bids.qty_through(102), 13);   // bids at >= 102
+  EXPECT_EQ(bids.qty_through(106), 0);
+
+  auto s = asks.sweep(7);                  // 5@100 + 2@102
+  EXPECT_EQ(s.qty, 7);
+  EXPECT_EQ(s.notional, 5 * 100 + 2 * 102);
+  EXPECT_EQ(s.worst_px, 102);
+  auto b = bids.sweep(11);                 // 10@105 + 1@102
+  EXPECT_EQ(b.notional, 10 * 105 + 1 * 102);
+  EXPECT_EQ(b.worst_px, 102);
+  auto all = asks.sweep(100);              // side too thin
+  EXPECT_EQ(all.qty, 18);
+  EXPECT_EQ(all.worst_px, 105);
+
+  asks.add(102, -3);
+  EXPECT_EQ(asks.sweep(7).worst_px, 105);
+  EXPECT_EQ(asks.qty_at(100), 5);
+}
+
+// Tree-backed queries must equal the ladder walk under a random flow that
+// also forces window re-centring (prices drift far outside the first window).
+// A 64-tick cap makes sides outgrow the tree and get it back as they empty.
+TEST(DepthTree, Book_queries_match_ladder_walk) {
+  for (std::size_t max_ticks : {Ladder<Side::Bid>::kDefaultMaxTicks, std::size_t(64)})
+  for (auto ladder : {LadderKind::Map, LadderKind::Flat}) {
+    Book::BookConfig tc, wc;
+    tc.depth_tree = true;
+    tc.ladder = wc.ladder = ladder;
+    tc.flat_ticks = wc.flat_ticks = 64;
+    tc.flat_max_ticks = wc.flat_max_ticks = max_ticks;
+    Book t(tc), w(wc);
+
+    std::mt19937_64 rng(3);
+    std::uniform_int_distribution<int> op(0, 9), qd(1, 30), tif(0, 2);
+    OrderId next = 1;
+    Price mid = 1000;
+    for (int i = 0; i < 20000; ++i) {
+      if (i % 2000 == 0) mid += 700;             // drift
+      std::uniform_int_distribution<int> pd(int(mid) - 40, int(mid) + 40);
+      int o = op(rng);
+      Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+      if (o < 6) {
+        Price px = pd(rng) + (s == Side::Bid ? -20 : 20); Qty q = qd(rng);
+        auto f = Book::TimeInForce(tif(rng));
+        auto a = t.submit(1, s, px, q, next, Book::OrderType::Limit, f);
+        auto c = w.submit(1, s, px, q, next, Book::OrderType::Limit, f);
+        ASSERT_EQ(a.fills.size(), c.fills.size()) << "step " << i;
+        ++next;
+      } else if (o < 8) {
+        OrderId id = 1 + rng() % next;
+        t.cancel(id); w.cancel(id);
+      } else {
+        OrderId id = 1 + rng() % next;
+        Price px = pd(rng); Qty q = qd(rng);
+        EXPECT_EQ(t.replace(1, id, px, q).ok, w.replace(1, id, px, q).ok);
+      }
+      for (Side side : {Side::Bid, Side::Ask}) {
+        Price lim = pd(rng);
+        ASSERT_EQ(t.available_qty_through(side, lim), w.available_qty_through(side, lim)) << "step " << i;
+        Qty q = qd(rng) * 4;
+        auto a = t.sweep_cost(side, q), c = w.sweep_cost(side, q);
+        ASSERT_EQ(a.qty, c.qty) << "step " << i;
+        ASSERT_EQ(a.notional, c.notional) << "step " << i;
+        ASSERT_EQ(a.worst_px, c.worst_px) << "step " << i;
+      }
+      if (i % 500 == 0) {
+        auto e = t.check_invariants();
+        ASSERT_TRUE(e.empty()) << e.front();
+      }
+    }
+  }
+}
+
+// A side spanning more than flat_max_ticks used to size the window off the
+// whole span (two asks 2^36 apart asked for a 2^40-byte tree). The tree now
+// drops out, queries walk the ladder, and it comes back once the side empties.
+TEST(DepthTree, Wide_side_falls_back_to_ladder_walk) {
+  using OT = Book::OrderType;
+  using TIF = Book::TimeInForce;
+  for (auto ladder : {LadderKind::Map, LadderKind::Flat}) {
+    Book::BookConfig cfg;
+    cfg.depth_tree = true;
+    cfg.ladder = ladder;
+    Book b(cfg);
+    const Book& cb = b;
+    const Price far = 1000 + (Price(1) << 36);
+
+    b.submit(1, Side::Ask, 1000, 5, 1, OT::Limit, TIF::Day);
+    b.submit(1, Side::Ask, far, 7, 2, OT::Limit, TIF::Day);
+    EXPECT_FALSE(cb.depth<Side::Ask>().active());
+    EXPECT_EQ(b.available_qty_through(Side::Ask, 1000), 5);
+    EXPECT_EQ(b.available_qty_through(Side::Ask, far), 12);
+    auto s = b.sweep_cost(Side::Ask, 6);
+    EXPECT_EQ(s.qty, 6);
+    EXPECT_EQ(s.worst_px, far);
+    EXPECT_EQ(s.notional, 5 * 1000 + far);
+    auto e = b.check_invariants();
+    EXPECT_TRUE(e.empty()) << e.front();
+
+    EXPECT_EQ(b.submit(2, Side::Bid, far, 13, 3, OT::Limit, TIF::FOK).fills.size(), 0u);
+    EXPECT_EQ(b.submit(2, Side::Bid, far, 12, 4, OT::Limit, TIF::FOK).fills.size(), 2u);
+    EXPECT_TRUE(cb.depth<Side::Ask>().active());
+
+    b.submit(1, Side::Ask, 2000, 4, 5, OT::Limit, TIF::Day);
+    EXPECT_EQ(cb.depth<Side::Ask>().qty_through(2000), 4);
+    e = b.check_invariants();
+    EXPECT_TRUE(e.empty()) << e.front();
+  }
+}
+
+// Bid offsets used to come from -px, undefined at INT64_MIN. (submit()
+// rejects px <= 0, so rest them with the non-matching add().)
+TEST(DepthTree, Int64_extreme_prices) {
+  constexpr Price kLo = std::numeric_limits<Price>::min(), kHi = std::numeric_limits<Price>::max();
+  Book::BookConfig cfg;
+  cfg.depth_tree = true;
+  Book b(cfg);
+  const Book& cb = b;
+  ASSERT_TRUE(b.add(1, Side::Bid, kLo, 1, 0));
+  ASSERT_TRUE(b.add(2, Side::Ask, kHi, 1, 0));
+  EXPECT_TRUE(cb.depth<Side::Bid>().active());
+  EXPECT_EQ(b.available_qty_through(Side::Bid, kLo), 1);
+  EXPECT_EQ(b.available_qty_through(Side::Bid, kLo + 1), 0);
+  EXPECT_EQ(b.available_qty_through(Side::Ask, kHi), 1);
+  EXPECT_EQ(b.sweep_cost(Side::Bid, 1).worst_px, kLo);
+  EXPECT_EQ(b.sweep_cost(Side::Ask, 1).worst_px, kHi);
+  auto e = b.check_invariants();
+  EXPECT_TRUE(e.empty()) << e.front();
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+#include "../engine/prometheus.hpp"
+
+namespace {
+
+using OT = lob::Book::OrderType;
+using TIF = lob::Book::TimeInForce;
+
+std::uint64_t accepted(const EngineCounters& c, OT t, TIF f) { return c.accepted[std::size_t(t)][std::size_t(f)].get(); }
+std::uint64_t rejected(const EngineCounters& c, OT t, TIF f) { return c.rejected[std::size_t(t)][std::size_t(f)].get(); }
+
+bool has_line(const std::string& text, const std::string& line) {
+  return text.find("\n" + line + "\n") != std::string::npos;
+}
+
+} // namespace
+
+TEST(EngineMetrics, Counts_orders_fills_cancels_and_replaces) {
+  EventBus bus(1u << 12);
+  MatchEngine eng(bus);
+  EngineCounters c;
+  eng.set_metrics(&c);
+
+  eng.add(1, 1, Side::Ask, 101, 5);
+  eng.add(1, 2, Side::Ask, 102, 5);
+  eng.add(2, 3, Side::Bid, 102, 7);            // 2 fills: 5 @101, 2 @102
+  eng.add(2, 4, Side::Bid, 99, 10, TIF::FOK);  // killed: nothing at 99
+  eng.add(2, 5, Side::Bid, 99, 1, TIF::IOC);   // nothing to cross
+  eng.market(2, 6, Side::Bid, 1);              // 1 fill @102
+  eng.add(1, 7, Side::Bid, 100, 4);
+  eng.cancel(7);
+  eng.cancel(7);                               // already gone
+  eng.replace(1, 2, 103, 3);
+  eng.replace(1, 42, 103, 3);                  // unknown id
+
+  EXPECT_EQ(accepted(c, OT::Limit, TIF::Day), 4u);
+  EXPECT_EQ(rejected(c, OT::Limit, TIF::FOK), 1u);
+  EXPECT_EQ(rejected(c, OT::Limit, TIF::IOC), 1u);
+  EXPECT_EQ(accepted(c, OT::Market, TIF::IOC), 1u);
+  EXPECT_EQ(c.fills.get(), 3u);
+  EXPECT_EQ(c.filled_qty.get(), 8u);
+  EXPECT_EQ(c.cancels.get(), 1u);
+  EXPECT_EQ(c.cancel_rejects.get(), 1u);
+  EXPECT_EQ(c.replaces.get(), 1u);
+  EXPECT_EQ(c.replace_rejects.get(), 1u);
+  EXPECT_EQ(c.events_published.get(), bus.published());
+  EXPECT_EQ(c.events_dropped.get(), 0u);
+}
+
+TEST(EngineMetrics, Book_gauges_follow_refresh) {
+  EventBus bus(1u << 12);
+  MatchEngine eng(bus);
+  EngineCounters c;
+  eng.set_metrics(&c);
+  const SymbolId s = eng.add_symbol("X");
+
+  eng.add(1, 1, Side::Bid, 100, 5);
+  eng.add(1, 2, Side::Bid, 100, 3);
+  eng.add(1, 3, Side::Bid, 99, 2);
+  eng.add(s, 1, 4, Side::Ask, 105, 6);
+  EXPECT_EQ(c.resting_orders[std::size_t(Side::Bid)].get(), 0u);   // not refreshed yet
+
+  eng.refresh_book_gauges();
+  EXPECT_EQ(c.resting_orders[std::size_t(Side::Bid)].get(), 3u);
+  EXPECT_EQ(c.book_levels[std::size_t(Side::Bid)].get(), 2u);
+  EXPECT_EQ(c.resting_qty[std::size_t(Side::Bid)].get(), 10u);
+  EXPECT_EQ(c.resting_orders[std::size_t(Side::Ask)].get(), 1u);
+  EXPECT_EQ(c.book_levels[std::size_t(Side::Ask)].get(), 1u);
+  EXPECT_EQ(c.resting_qty[std::size_t(Side::Ask)].get(), 6u);
+
+  eng.cancel(3);
+  eng.refresh_book_gauges();
+  EXPECT_EQ(c.resting_orders[std::size_t(Side::Bid)].get(), 2u);
+  EXPECT_EQ(c.book_levels[std::size_t(Side::Bid)].get(), 1u);
+  EXPECT_EQ(c.resting_qty[std::size_t(Side::Bid)].get(), 8u);
+}
+
+TEST(EngineMetrics, Prometheus_text) {
+  EventBus bus(1u << 12);
+  MatchEngine eng(bus);
+  EngineCounters c;
+  CommandLatency lat;
+  eng.set_metrics(&c);
+  eng.set_latency(&lat);
+  eng.add(1, 1, Side::Ask, 101, 5);
+  eng.add(2, 2, Side::Bid, 101, 2);
+  eng.refresh_book_gauges();
+
+  SpscStats q;
+  q.push_ok.store(7);
+  q.drops_total.store(2);
+
+  PromWriter w;
+  write_engine_counters(w, c);
+  write_spsc_stats(w, {{"ingress", &q}});
+  write_command_latency(w, "engine_command_latency_ns", lat);
+  const std::string text = "\n" + w.take();
+
+  EXPECT_TRUE(has_line(text, "# TYPE engine_orders_total counter"));
+  EXPECT_TRUE(has_line(text, "engine_orders_total{type=\"limit\",tif=\"day\",result=\"accepted\"} 2"));
+  EXPECT_TRUE(has_line(text, "engine_orders_total{type=\"market\",tif=\"fok\",result=\"rejected\"} 0"));
+  EXPECT_TRUE(has_line(text, "engine_fills_total 1"));
+  EXPECT_TRUE(has_line(text, "engine_filled_qty_total 2"));
+  EXPECT_TRUE(has_line(text, "engine_resting_qty{side=\"ask\"} 3"));
+  EXPECT_TRUE(has_line(text, "# TYPE spsc_depth gauge"));
+  EXPECT_TRUE(has_line(text, "spsc_push_total{queue=\"ingress\"} 7"));
+  EXPECT_TRUE(has_line(text, "spsc_drops_total{queue=\"ingress\"} 2"));
+  EXPECT_TRUE(has_line(text, "# TYPE engine_command_latency_ns summary"));
+  EXPECT_TRUE(has_line(text, "engine_command_latency_ns_count{type=\"add\"} 2"));
+  EXPECT_TRUE(has_line(text, "engine_command_latency_ns_count{type=\"cancel\"} 0"));
+  EXPECT_NE(text.find("engine_command_latency_ns{type=\"add\",quantile=\"0.99\"} "), std::string::npos);
+}
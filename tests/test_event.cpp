@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+
+TEST(Event, Pod_layout_and_typed_access) {
+  static_assert(sizeof(Event) == 64 && alignof(Event) == 64);
+  static_assert(std::is_trivially_copyable_v<Event>);
+
+  Event e = FillEvent{7, 3, 101, 5, 2, Side::Bid};
+  EXPECT_TRUE(e.is<FillEvent>());
+  EXPECT_FALSE(e.is<CancelEvent>());
+  EXPECT_EQ(e.get_if<BookChangeEvent>(), nullptr);
+  ASSERT_NE(e.get_if<FillEvent>(), nullptr);
+  EXPECT_EQ(e.get<FillEvent>().maker_id, 3u);
+  EXPECT_EQ(e.symbol(), 2u);
+
+  // A byte copy is a valid Event (rings, files, shared memory).
+  Event copy;
+  std::memcpy(static_cast<void*>(&copy), &e, sizeof e);
+  EXPECT_EQ(copy.get<FillEvent>().qty, 5);
+
+  // visit hands over the live payload, mutably.
+  Event c = CancelEvent{9, 100, 4, 1, Side::Ask};
+  c.visit([](auto& p){ p.symbol = 42; });
+  EXPECT_EQ(c.get<CancelEvent>().symbol, 42u);
+  EXPECT_EQ(c.visit([](auto const& p){ return sizeof p; }), sizeof(CancelEvent));
+}
+
+TEST(Event, Bus_stamps_seq_and_engine_stamps_ts_per_command) {
+  EventBus bus(8);
+  EXPECT_TRUE(bus.try_publish(BookChangeEvent{100, 1, 0, Side::Bid}));
+  Event out;
+  ASSERT_TRUE(bus.try_poll(out));
+  EXPECT_EQ(out.seq, 1u);
+  for (int i = 0; i < 8; ++i) ASSERT_TRUE(bus.try_publish(BookChangeEvent{100, 1, 0, Side::Bid}));
+  EXPECT_FALSE(bus.try_publish(BookChangeEvent{100, 1, 0, Side::Bid}));   // full: no seq used
+  EXPECT_EQ(bus.published(), 9u);
+  while (bus.try_poll(out)) {}
+  EXPECT_EQ(out.seq, 9u);
+
+  EventBus bus2(1u << 10);
+  MatchEngine eng(bus2);
+  eng.add(1, 1, Side::Ask, 101, 5);
+  eng.add(1, 2, Side::Ask, 102, 5);
+  eng.add(2, 3, Side::Bid, 102, 10);   // two fills + two level updates
+  std::vector<Event> evs;
+  while (auto ev = bus2.try_poll()) evs.push_back(*ev);
+  ASSERT_EQ(evs.size(), 6u);
+  for (std::size_t i = 0; i < evs.size(); ++i) {
+    EXPECT_EQ(evs[i].seq, i + 1);
+    EXPECT_NE(evs[i].ts_ns, 0u);
+  }
+  for (std::size_t i = 3; i < evs.size(); ++i) EXPECT_EQ(evs[i].ts_ns, evs[2].ts_ns);   // one command
+  EXPECT_LE(evs[0].ts_ns, evs[1].ts_ns);
+}
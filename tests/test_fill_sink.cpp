@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "lob/book.hpp"
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+
+using namespace lob;
+
+// Count every global allocation made by this test binary. The whole
+// replaceable set (plain, array, aligned; nothrow forms forward to these) is
+// replaced and kept out of line, so no call site pairs new with free.
+static std::atomic<std::size_t> g_allocs{0};
+
+[[gnu::noinline]] static void* counted_alloc(std::size_t n, std::size_t align) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (!n) n = 1;
+  void* p = align <= alignof(std::max_align_t) ? std::malloc(n)
+                                               : std::aligned_alloc(align, (n + align - 1) / align * align);
+  if (!p) throw std::bad_alloc{};
+  return p;
+}
+[[gnu::noinline]] static void counted_free(void* p) noexcept { std::free(p); }
+
+[[gnu::noinline]] void* operator new(std::size_t n) { return counted_alloc(n, 0); }
+[[gnu::noinline]] void* operator new[](std::size_t n) { return counted_alloc(n, 0); }
+[[gnu::noinline]] void* operator new(std::size_t n, std::align_val_t a) { return counted_alloc(n, std::size_t(a)); }
+[[gnu::noinline]] void* operator new[](std::size_t n, std::align_val_t a) { return counted_alloc(n, std::size_t(a)); }
+[[gnu::noinline]] void operator delete(void* p) noexcept { counted_free(p); }
+[[gnu::noinline]] void operator delete[](void* p) noexcept { counted_free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+
+static void seed(Book& b) {
+  for (OrderId i = 1; i <= 20; ++i)
+    b.submit(1, Side::Ask, 100 + Price(i % 4), 5, i, Book::OrderType::Limit, Book::TimeInForce::Day);
+}
+
+TEST(FillSink, Streams_same_fills_as_vector_overload) {
+  Book a, b;
+  seed(a); seed(b);
+
+  auto rv = a.submit(2, Side::Bid, 102, 37, 99, Book::OrderType::Limit, Book::TimeInForce::Day);
+  std::vector<Book::MatchFill> got;
+  auto rs = b.submit(2, Side::Bid, 102, 37, 99, Book::OrderType::Limit, Book::TimeInForce::Day,
+                     [&](const Book::MatchFill& f){ got.push_back(f); });
+
+  ASSERT_EQ(got.size(), rv.fills.size());
+  Qty sum = 0;
+  for (std::size_t i = 0; i < got.size(); ++i) {
+    EXPECT_EQ(got[i].maker_id, rv.fills[i].maker_id);
+    EXPECT_EQ(got[i].px, rv.fills[i].px);
+    EXPECT_EQ(got[i].qty, rv.fills[i].qty);
+    sum += got[i].qty;
+  }
+  EXPECT_EQ(rs.fill_count, got.size());
+  EXPECT_EQ(rs.filled_qty, sum);
+  EXPECT_EQ(rs.posted_qty, rv.posted_qty);
+  EXPECT_EQ(rs.book_changed, rv.book_changed);
+}
+
+TEST(FillSink, Sweeping_submit_does_not_allocate) {
+  Book::BookConfig cfg;
+  cfg.reserve_orders = 1024;
+  Book b(cfg);
+  seed(b);
+
+  Qty sum = 0;
+  auto before = g_allocs.load();
+  auto r = b.submit(2, Side::Bid, 0, 60, 99, Book::OrderType::Market, Book::TimeInForce::IOC,
+                    [&](const Book::MatchFill& f){ sum += f.qty; });
+  EXPECT_EQ(g_allocs.load(), before);
+  EXPECT_EQ(sum, 60);
+  EXPECT_EQ(r.fill_count, 12u);
+}
+
+TEST(FillSink, MatchEngine_publishes_fills_without_allocating) {
+  EventBus bus(1 << 10);
+  Book::BookConfig cfg;
+  cfg.reserve_orders = 1024;
+  MatchEngine eng(bus, cfg);
+  for (OrderId i = 1; i <= 20; ++i) eng.add(i, Side::Ask, 100, 5);
+  while (bus.try_poll()) {}
+
+  auto before = g_allocs.load();
+  eng.market(99, Side::Bid, 42);
+  EXPECT_EQ(g_allocs.load(), before);
+
+  int fills = 0; Qty sum = 0;
+  while (auto ev = bus.try_poll())
+    if (ev->is<FillEvent>()) { fills++; sum += ev->get<FillEvent>().qty; }
+  EXPECT_EQ(fills, 9);
+  EXPECT_EQ(sum, 42);
+}
+
+TEST(FillSink, Replace_that_crosses_reports_its_fills) {
+  EventBus bus(1 << 10);
+  MatchEngine eng(bus);
+  eng.add(1, Side::Ask, 101, 4);
+  eng.add(/*trader*/7, /*id*/2, Side::Bid, 100, 6);
+  while (bus.try_poll()) {}
+
+  eng.replace(/*trader*/7, /*id*/2, /*new_px*/101, /*new_qty*/6);
+  int fills = 0;
+  while (auto ev = bus.try_poll())
+    if (ev->is<FillEvent>()) {
+      auto f = ev->get<FillEvent>();
+      fills++;
+      EXPECT_EQ(f.taker_id, 2u);
+      EXPECT_EQ(f.maker_id, 1u);
+      EXPECT_EQ(f.side, Side::Bid);
+      EXPECT_EQ(f.qty, 4);
+    }
+  EXPECT_EQ(fills, 1);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include "../engine/common/metrics.hpp"
+#include "../engine/match_engine.hpp"
+
+TEST(LatencyHistogram, Buckets_cover_values_within_relative_error) {
+  std::size_t prev = 0;
+  for (std::uint64_t v = 0; v < 200000; ++v) {
+    const std::size_t i = LatencyHistogram::index_of(v);
+    ASSERT_GE(i, prev);                                       // monotonic
+    ASSERT_LE(i, prev + 1);                                   // no gaps
+    prev = i;
+    const std::uint64_t top = LatencyHistogram::bucket_top(i);
+    ASSERT_GE(top, v);
+    ASSERT_LE(double(top - v), double(v) / double(LatencyHistogram::kSub));
+  }
+  std::mt19937_64 rng(7);
+  for (int k = 0; k < 100000; ++k) {
+    const std::uint64_t v = rng() >> (rng() % 40 + 24);
+    const std::uint64_t top = LatencyHistogram::bucket_top(LatencyHistogram::index_of(v));
+    ASSERT_GE(top, v);
+    ASSERT_LE(double(top - v), double(v) / double(LatencyHistogram::kSub));
+  }
+  EXPECT_EQ(LatencyHistogram::index_of(UINT64_MAX), LatencyHistogram::kBuckets - 1);
+}
+
+TEST(LatencyHistogram, Small_values_are_exact) {
+  auto h = std::make_unique<LatencyHistogram>();
+  for (std::uint64_t v = 1; v <= 10; ++v) h->record(v);
+  EXPECT_EQ(h->count(), 10u);
+  EXPECT_EQ(h->min(), 1u);
+  EXPECT_EQ(h->max(), 10u);
+  EXPECT_EQ(h->percentile(50), 5u);
+  EXPECT_EQ(h->percentile(90), 9u);
+  EXPECT_EQ(h->percentile(100), 10u);
+  EXPECT_EQ(h->percentile(0), 1u);
+  EXPECT_DOUBLE_EQ(h->mean(), 5.5);
+}
+
+TEST(LatencyHistogram, Percentiles_of_a_uniform_range) {
+  auto h = std::make_unique<LatencyHistogram>();
+  for (std::uint64_t v = 1; v <= 1000000; ++v) h->record(v);
+  const auto s = h->summary();
+  EXPECT_EQ(s.count, 1000000u);
+  EXPECT_NEAR(double(s.p50), 500000.0, 500000.0 / 32);
+  EXPECT_NEAR(double(s.p90), 900000.0, 900000.0 / 32);
+  EXPECT_NEAR(double(s.p99), 990000.0, 990000.0 / 32);
+  EXPECT_NEAR(double(s.p999), 999000.0, 999000.0 / 32);
+  EXPECT_EQ(s.max, 1000000u);
+  EXPECT_LE(s.p999, s.max);
+}
+
+TEST(LatencyHistogram, Huge_values_clamp_but_max_is_exact) {
+  LatencyHistogram h;
+  h.record(5);
+  h.record(std::uint64_t(1) << 50);
+  EXPECT_EQ(h.max(), std::uint64_t(1) << 50);
+  EXPECT_EQ(h.percentile(100), std::uint64_t(1) << 50);
+  EXPECT_EQ(h.percentile(50), 5u);
+}
+
+TEST(LatencyHistogram, Merge_equals_recording_everything_once) {
+  auto a = std::make_unique<LatencyHistogram>(), b = std::make_unique<LatencyHistogram>(),
+       all = std::make_unique<LatencyHistogram>();
+  std::mt19937_64 rng(3);
+  for (int i = 0; i < 50000; ++i) {
+    const std::uint64_t v = rng() % 1000000;
+    (i % 3 ? *a : *b).record(v);
+    all->record(v);
+  }
+  a->merge(*b);
+  const auto m = a->summary(), e = all->summary();
+  EXPECT_EQ(m.count, e.count);
+  EXPECT_EQ(m.min, e.min);
+  EXPECT_EQ(m.p50, e.p50);
+  EXPECT_EQ(m.p99, e.p99);
+  EXPECT_EQ(m.p999, e.p999);
+  EXPECT_EQ(m.max, e.max);
+  a->reset();
+  EXPECT_EQ(a->count(), 0u);
+  EXPECT_EQ(a->percentile(99), 0u);
+}
+
+// One thread records, another summarizes and merges meanwhile (run under
+// TSan to check there is no data race).
+TEST(LatencyHistogram, Reader_can_snapshot_while_writer_records) {
+  auto h = std::make_unique<LatencyHistogram>();
+  std::atomic<bool> done{false};
+  std::thread w([&]{
+    for (std::uint64_t i = 0; i < 200000; ++i) h->record(i % 5000);
+    done.store(true);
+  });
+  auto agg = std::make_unique<LatencyHistogram>();
+  while (!done.load()) {
+    const auto s = h->summary();
+    EXPECT_LE(s.p50, s.max + 0);
+  }
+  w.join();
+  agg->merge(*h);
+  EXPECT_EQ(agg->count(), 200000u);
+  EXPECT_EQ(agg->max(), 4999u);
+}
+
+TEST(CommandLatency, Engine_times_each_command_by_type) {
+  EventBus bus(1u << 12);
+  MatchEngine eng(bus);
+  auto lat = std::make_unique<CommandLatency>();
+  eng.add(1, Side::Ask, 101, 5);            // before tracking: not counted
+  eng.set_latency(lat.get());
+  eng.add(2, Side::Ask, 102, 5);
+  eng.add(3, Side::Bid, 102, 2);
+  eng.market(4, Side::Bid, 1);
+  eng.replace(0, 2, 103, 4);
+  eng.cancel(2);
+  eng.cancel(999);                          // unknown id still counts as a command
+  EXPECT_EQ((*lat)[CmdType::Add].count(), 2u);
+  EXPECT_EQ((*lat)[CmdType::Market].count(), 1u);
+  EXPECT_EQ((*lat)[CmdType::Replace].count(), 1u);
+  EXPECT_EQ((*lat)[CmdType::Cancel].count(), 2u);
+  // Events of a timed command carry its entry time.
+  std::uint64_t last_ts = 0;
+  while (auto ev = bus.try_poll()) { EXPECT_GE(ev->ts_ns, last_ts); last_ts = ev->ts_ns; }
+  EXPECT_GT(last_ts, 0u);
+  eng.set_latency(nullptr);
+  eng.add(5, Side::Bid, 90, 1);
+  EXPECT_EQ((*lat)[CmdType::Add].count(), 2u);
+}
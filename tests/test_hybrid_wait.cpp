@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "../engine/spsc/mpsc_channel.hpp"
+#include "../engine/spsc/spsc_channel.hpp"
+
+namespace {
+
+BackpressureCfg hybrid(std::size_t high, std::size_t low) {
+  BackpressureCfg cfg(high, low, BpMode::Hybrid);
+  cfg.spin_iters = 64;             // reach the park stage quickly
+  cfg.yield_iters = 4;
+  cfg.park_ns = 50'000'000;        // long enough that only a notify() ends a park early
+  return cfg;
+}
+
+} // namespace
+
+TEST(Parker, Ready_condition_skips_the_park) {
+  Parker p;
+  p.notify();                                        // nobody waiting: no-op
+  const auto t0 = std::chrono::steady_clock::now();
+  EXPECT_TRUE(p.wait([]{ return true; }, 1'000'000'000));
+  EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::milliseconds(100));
+  EXPECT_FALSE(p.wait([]{ return false; }, 1'000'000));   // times out
+}
+
+TEST(Parker, Notify_wakes_a_parked_waiter) {
+  Parker p;
+  std::atomic<bool> flag{false};
+  std::thread t([&]{
+    while (!p.wait([&]{ return flag.load(); }, 1'000'000'000)) {}
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto t0 = std::chrono::steady_clock::now();
+  flag.store(true);
+  p.notify();
+  t.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::milliseconds(500));
+}
+
+// Slow producer: the consumer runs out of spins and parks between items,
+// and every item still arrives, in order. The producer only pushes once it
+// has seen the consumer park, so each item has to come through a wakeup.
+TEST(SpscChannelHybrid, Pop_wait_parks_and_is_woken_by_push) {
+  constexpr int N = 20;
+  BackpressureCfg cfg = hybrid(16, 16);
+  cfg.park_ns = 2'000'000'000;     // a missed wakeup would stall a pop this long
+  SpscStats stats;
+  SpscChannel<int> ch(16, cfg, &stats);
+  std::vector<std::atomic<std::int64_t>> pushed_at(N);
+  auto now_ns = []{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  };
+  std::thread prod([&]{
+    for (int i = 0; i < N; ++i) {
+      while (stats.parks.load() <= std::uint64_t(i)) std::this_thread::yield();
+      pushed_at[i].store(now_ns());
+      ASSERT_TRUE(ch.push(i, nullptr));
+    }
+  });
+  for (int i = 0; i < N; ++i) {
+    int v = -1;
+    ASSERT_TRUE(ch.pop_wait(v, nullptr));
+    EXPECT_EQ(v, i);
+    EXPECT_LT(now_ns() - pushed_at[i].load(), std::int64_t(cfg.park_ns / 4)) << "item " << i;
+  }
+  prod.join();
+  EXPECT_GE(stats.parks.load(), std::uint64_t(N));
+}
+
+TEST(SpscChannelHybrid, Pop_wait_returns_false_on_stop) {
+  BackpressureCfg cfg = hybrid(8, 8);
+  cfg.park_ns = 1'000'000;
+  SpscChannel<int> ch(8, cfg, nullptr);
+  std::atomic<bool> stop{false};
+  std::thread t([&]{ int v; EXPECT_FALSE(ch.pop_wait(v, &stop)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  stop.store(true);
+  t.join();
+}
+
+// Full ring: the producer parks, and is released once the consumer has
+// drained to low_wm.
+TEST(SpscChannelHybrid, Producer_parks_until_drained_to_low_watermark) {
+  SpscStats stats;
+  SpscChannel<int> ch(8, hybrid(8, 2), &stats);
+  for (int i = 0; i < 8; ++i) ASSERT_TRUE(ch.push(i, nullptr));
+  std::atomic<bool> pushed{false};
+  std::thread prod([&]{ EXPECT_TRUE(ch.push(8, nullptr)); pushed.store(true); });
+  while (stats.parks.load() == 0) std::this_thread::yield();
+  int v;
+  for (int i = 0; i < 5; ++i) { ASSERT_TRUE(ch.pop(v)); EXPECT_EQ(v, i); }
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_FALSE(pushed.load());                     // depth 3 > low_wm
+  ASSERT_TRUE(ch.pop(v));
+  const auto t0 = std::chrono::steady_clock::now();
+  prod.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::milliseconds(40));
+  for (int i = 6; i <= 8; ++i) { ASSERT_TRUE(ch.pop(v)); EXPECT_EQ(v, i); }
+  EXPECT_EQ(stats.drops_total.load(), 0u);
+}
+
+TEST(SpscChannelHybrid, Threaded_transfer_is_complete_and_ordered) {
+  constexpr std::uint64_t N = 200000;
+  SpscChannel<std::uint64_t> ch(64, hybrid(64, 16), nullptr);
+  std::thread prod([&]{ for (std::uint64_t i = 0; i < N; ++i) ASSERT_TRUE(ch.push(i, nullptr)); });
+  for (std::uint64_t i = 0; i < N; ++i) {
+    std::uint64_t v;
+    ASSERT_TRUE(ch.pop_wait(v, nullptr));
+    ASSERT_EQ(v, i);
+  }
+  prod.join();
+}
+
+TEST(MpscChannelHybrid, Parked_producers_all_get_through) {
+  constexpr unsigned P = 3;
+  constexpr int N = 20000;
+  SpscStats stats;
+  MpscChannel<std::uint64_t> ch(32, hybrid(32, 8), &stats);
+  std::vector<std::thread> prods;
+  for (unsigned p = 0; p < P; ++p)
+    prods.emplace_back([&, p]{ for (int i = 0; i < N; ++i) ASSERT_TRUE(ch.push(std::uint64_t(p) << 32 | unsigned(i), nullptr)); });
+  std::vector<std::uint64_t> next(P, 0);
+  std::uint64_t got = 0;
+  while (got < P * N) {
+    const std::size_t n = ch.pop_bulk(8, [&](std::uint64_t&& v){ ASSERT_EQ(v & 0xffffffffu, next[v >> 32]++); });
+    got += n;
+    if (!n) std::this_thread::yield();
+  }
+  for (auto& t : prods) t.join();
+  EXPECT_EQ(stats.push_ok.load(), std::uint64_t(P) * N);
+}
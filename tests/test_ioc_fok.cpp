@@ -53,4 +53,30 @@ TEST(TIF, FOK_all_or_nothing) {
 
   auto errs = b.check_invariants();
   EXPECT_TRUE(errs.empty()) << (errs.empty() ? "" : errs.front());
-}
\ No newline at end of file
+}
+TEST(TIF, Market_day_never_rests) {
+  Book b;
+  b.submit(1, Side::Ask, 100, 3, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+  auto r = b.submit(2, Side::Bid, 0, 5, 2, Book::OrderType::Market, Book::TimeInForce::Day);
+  ASSERT_EQ(r.fills.size(), 1u);
+  EXPECT_EQ(r.posted_qty, 0);
+  EXPECT_FALSE(b.has(2));
+  EXPECT_TRUE(b.check_invariants().empty());
+}
+
+TEST(TIF, Specialized_submit_matches_runtime_dispatch) {
+  Book a, s;
+  for (Book* b : {&a, &s}) {
+    b->submit(1, Side::Ask, 101, 4, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+    b->submit(1, Side::Ask, 102, 4, 2, Book::OrderType::Limit, Book::TimeInForce::Day);
+  }
+  auto ra = a.submit(2, Side::Bid, 102, 6, 3, Book::OrderType::Limit,
+                     Book::TimeInForce::FOK, Book::NoFillSink{});
+  auto rs = s.submit_as<Side::Bid, Book::OrderType::Limit, Book::TimeInForce::FOK>(
+                2, 102, 6, 3, Book::NoFillSink{});
+  EXPECT_EQ(ra.fill_count, rs.fill_count);
+  EXPECT_EQ(ra.filled_qty, 6);
+  EXPECT_EQ(rs.filled_qty, 6);
+  EXPECT_EQ(a.asks_total_, s.asks_total_);
+  EXPECT_EQ(*a.best().ask, *s.best().ask);
+}
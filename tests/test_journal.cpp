@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../engine/journal.hpp"
+#include "../engine/match_engine.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string fresh_dir(const char* name) {
+  const std::string d = testing::TempDir() + name;
+  fs::remove_all(d);
+  return d;
+}
+
+Journal::Config small(const std::string& dir) {
+  Journal::Config c;
+  c.dir = dir;
+  c.segment_bytes = sizeof(SegmentHeader) + 10 * sizeof(JournalRecord);   // 10 records per file
+  c.flush_interval = std::chrono::microseconds(200);
+  return c;
+}
+
+} // namespace
+
+TEST(Journal, Appends_across_rotations_in_order) {
+  const auto dir = fresh_dir("wal_rotate");
+  {
+    Journal j(small(dir));
+    for (OrderId id = 1; id <= 95; ++id)
+      EXPECT_EQ(j.append(make_add(SymbolId(id % 3), 7, id, Side::Ask, 100 + Price(id), Qty(id))), id);
+    j.wait_durable(95);
+    EXPECT_EQ(j.durable_seq(), 95u);
+    EXPECT_EQ(j.stats().rotations, 9u);
+  }
+  EXPECT_EQ(journal_segments(dir).size(), 10u);   // no spare left behind
+
+  std::uint64_t expect = 1;
+  const auto n = JournalReader(dir).for_each([&](const JournalRecord& r){
+    EXPECT_EQ(r.seq, expect);
+    EXPECT_EQ(r.cmd.type, CmdType::Add);
+    EXPECT_EQ(r.cmd.id, expect);
+    EXPECT_EQ(r.cmd.symbol, SymbolId(expect % 3));
+    EXPECT_EQ(r.cmd.px, 100 + Price(expect));
+    ++expect;
+  });
+  EXPECT_EQ(n, 95u);
+}
+
+TEST(Journal, Reopen_continues_the_sequence) {
+  const auto dir = fresh_dir("wal_reopen");
+  { Journal j(small(dir)); for (int i = 0; i < 15; ++i) j.append(make_cancel(0, OrderId(i))); }
+  {
+    Journal j(small(dir));
+    EXPECT_EQ(j.last_seq(), 15u);
+    EXPECT_EQ(j.append(make_cancel(0, 99)), 16u);
+  }
+  EXPECT_EQ(JournalReader(dir).last_seq(), 16u);
+}
+
+// A torn record ends its segment for readers (and for a reopened writer).
+TEST(Journal, Failed_segment_creation_fails_the_journal) {
+  const auto dir = fresh_dir("wal_fail");
+  Journal::Config cfg = small(dir);
+  cfg.segment_bytes = sizeof(SegmentHeader) + 4 * sizeof(JournalRecord);
+  Journal j(cfg);
+  // A directory where the flusher will create segment 2: open() fails.
+  fs::create_directories(fs::path(dir) / journal_segment_name(2));
+
+  for (OrderId id = 1; id <= 5; ++id) j.append(make_cancel(0, id));   // 5th rotates into segment 1
+  for (int i = 0; i < 2000 && !j.failed(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  ASSERT_TRUE(j.failed());
+  EXPECT_THROW(j.append(make_cancel(0, 6)), std::runtime_error);
+  EXPECT_GE(j.durable_seq(), 4u);       // segment 0 was committed before the failure
+  EXPECT_THROW(j.wait_durable(6), std::runtime_error);
+  EXPECT_EQ(j.last_seq(), 5u);
+  j.close();
+}
+
+TEST(Journal, Reader_stops_at_a_torn_record) {
+  const auto dir = fresh_dir("wal_torn");
+  { Journal j(small(dir)); for (int i = 0; i < 8; ++i) j.append(make_cancel(0, OrderId(i))); }
+  const auto seg = journal_segments(dir).front();
+  {
+    std::fstream f(seg, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(std::streamoff(sizeof(SegmentHeader) + 5 * sizeof(JournalRecord) + 20));
+    f.put('\x5a');
+  }
+  EXPECT_EQ(JournalReader(dir).last_seq(), 5u);
+  Journal j(small(dir));
+  EXPECT_EQ(j.append(make_cancel(0, 1)), 6u);
+}
+
+// Commands reach the journal before the book; replaying them rebuilds it.
+TEST(Journal, Match_engine_journals_every_command) {
+  const auto dir = fresh_dir("wal_engine");
+  EventBus bus(1u << 12);
+  MatchEngine eng(bus);
+  const SymbolId x = eng.add_symbol("X");
+  {
+    Journal j(small(dir));
+    eng.set_journal(&j);
+    eng.add(x, 1, 1, Side::Ask, 101, 5);
+    eng.add(x, 2, 2, Side::Ask, 102, 5);
+    eng.add(1, 3, Side::Bid, 99, 4);               // symbol 0
+    eng.replace(x, 1, 1, 103, 2);
+    eng.market(x, 3, 4, Side::Bid, 6);
+    eng.cancel(0, 3);
+    eng.set_journal(nullptr);
+  }
+
+  EventBus bus2(1u << 12);
+  MatchEngine back(bus2);
+  back.add_symbol("X");
+  std::vector<CmdType> types;
+  JournalReader(dir).for_each([&](const JournalRecord& r){ types.push_back(r.cmd.type); back.apply(r.cmd); });
+  EXPECT_EQ(types, (std::vector<CmdType>{CmdType::Add, CmdType::Add, CmdType::Add, CmdType::Replace,
+                                          CmdType::Market, CmdType::Cancel}));
+  for (Price px = 95; px <= 105; ++px)
+    for (Side s : {Side::Bid, Side::Ask}) {
+      EXPECT_EQ(back.book_level_qty(x, s, px), eng.book_level_qty(x, s, px));
+      EXPECT_EQ(back.book_level_qty(s, px), eng.book_level_qty(s, px));
+    }
+  EXPECT_EQ(eng.book(x).asks_total_, 1);
+}
+
+// An unregistered SymbolId never reaches the journal or the books.
+TEST(Journal, Unknown_symbol_is_rejected_before_journaling) {
+  const auto dir = fresh_dir("wal_unknown_symbol");
+  EventBus bus(1u << 12);
+  MatchEngine eng(bus);
+  EngineCounters c;
+  eng.set_metrics(&c);
+  const SymbolId bad = eng.add_symbol("X") + 1;
+  {
+    Journal j(small(dir));
+    eng.set_journal(&j);
+    eng.add(bad, 1, 1, Side::Ask, 101, 5);
+    eng.market(bad, 1, 2, Side::Bid, 5);
+    eng.replace(bad, 1, 1, 102, 5);
+    eng.cancel(bad, 1);
+    eng.apply(make_add(bad, 1, 3, Side::Bid, 99, 5));
+    eng.add(1, 4, Side::Bid, 99, 5);               // symbol 0: journaled
+    eng.set_journal(nullptr);
+  }
+  EXPECT_EQ(c.unknown_symbol.get(), 5u);
+  EXPECT_EQ(c.rejected[0][0].get() + c.replace_rejects.get() + c.cancel_rejects.get(), 0u);
+  EXPECT_EQ(bus.published(), 1u);                  // the symbol-0 level
+  std::vector<SymbolId> journaled;
+  JournalReader(dir).for_each([&](const JournalRecord& r){ journaled.push_back(r.cmd.symbol); });
+  EXPECT_EQ(journaled, std::vector<SymbolId>{0});
+}
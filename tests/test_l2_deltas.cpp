@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include "lob/book.hpp"
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+
+using namespace lob;
+
+namespace {
+
+using Mirror = std::map<std::pair<Side, Price>, Qty>;
+
+Mirror levels_of(const Book& b) {
+  Mirror m;
+  b.bids_.walk([&](PriceLevel const& l){ m[{Side::Bid, l.price}] = l.total_qty; return true; });
+  b.asks_.walk([&](PriceLevel const& l){ m[{Side::Ask, l.price}] = l.total_qty; return true; });
+  return m;
+}
+
+Book::BookConfig with_deltas() {
+  Book::BookConfig cfg;
+  cfg.l2_deltas = true;
+  return cfg;
+}
+
+} // namespace
+
+TEST(L2Deltas, Sweep_reports_every_level_then_the_posted_one) {
+  Book b(with_deltas());
+  b.submit(1, Side::Ask, 101, 5, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Ask, 101, 5, 2, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Ask, 102, 5, 3, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Ask, 103, 5, 4, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.clear_deltas();
+
+  // Buy 14 @102: clears 101 (two makers -> one delta), all of 102, posts 4 @102.
+  b.submit(2, Side::Bid, 102, 19, 5, Book::OrderType::Limit, Book::TimeInForce::Day);
+  EXPECT_EQ(b.deltas(), (std::vector<LevelDelta>{
+    {Side::Ask, 101, 0}, {Side::Ask, 102, 0}, {Side::Bid, 102, 4}}));
+  b.clear_deltas();
+
+  b.replace(2, 5, 100, 3);                          // reprice: old level gone, new level
+  EXPECT_EQ(b.deltas(), (std::vector<LevelDelta>{{Side::Bid, 102, 0}, {Side::Bid, 100, 3}}));
+  b.clear_deltas();
+  b.replace(2, 5, 100, 1);                          // in-place shrink
+  b.cancel(4);
+  EXPECT_EQ(b.deltas(), (std::vector<LevelDelta>{{Side::Bid, 100, 1}, {Side::Ask, 103, 0}}));
+  b.clear_deltas();
+  b.cancel(999);                                    // no-op: no delta
+  EXPECT_TRUE(b.deltas().empty());
+}
+
+TEST(L2Deltas, Off_by_default) {
+  Book b;
+  b.submit(1, Side::Ask, 101, 5, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+  EXPECT_TRUE(b.deltas().empty());
+}
+
+// A consumer that only applies BookChangeEvents must track the book exactly,
+// for every STP policy (which trims makers without trades).
+TEST(L2Deltas, Engine_events_maintain_a_mirror_book) {
+  for (auto stp : {Book::STPPolicy::Allow, Book::STPPolicy::CancelTaker,
+                   Book::STPPolicy::CancelMaker, Book::STPPolicy::CancelBoth}) {
+    Book::BookConfig cfg;
+    cfg.stp = stp;
+    EventBus bus(1u << 14);
+    MatchEngine eng(bus, cfg);
+    const SymbolId sym = eng.add_symbol("X");
+    Mirror mirror;
+    std::mt19937_64 rng(21);
+    OrderId next = 1;
+    for (int i = 0; i < 20000; ++i) {
+      const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+      const Price px = 100 + Price(rng() % 11) - 5;
+      const TraderId t = 1 + rng() % 3;
+      const Qty q = 1 + Qty(rng() % 12);
+      const auto tif = Book::TimeInForce(rng() % 3);
+      switch (rng() % 8) {
+        case 0:  eng.cancel(sym, 1 + rng() % next); break;
+        case 1:  eng.market(sym, t, next++, s, q); break;
+        case 2:  eng.replace(sym, t, 1 + rng() % next, px, q, tif); break;
+        default: eng.add(sym, t, next++, s, px, q, tif); break;
+      }
+      while (auto ev = bus.try_poll()) {
+        if (auto* c = ev->get_if<BookChangeEvent>()) {
+          ASSERT_EQ(c->symbol, sym);
+          if (c->level_qty == 0) mirror.erase({c->side, c->px});
+          else mirror[{c->side, c->px}] = c->level_qty;
+        }
+      }
+      ASSERT_EQ(mirror, levels_of(eng.book(sym))) << "after command " << i;
+    }
+  }
+}
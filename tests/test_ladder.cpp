@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include "lob/book.hpp"
+#include "../engine/event_bus.hpp"
+#include "../engine/match_engine.hpp"
+
+using namespace lob;
+
+TEST(Ladder, Flat_best_and_next_cross_bitmap_words) {
+  Ladder<Side::Ask> asks(LadderKind::Flat, 1 << 14);   // 16k ticks: 4 summary words
+  Ladder<Side::Bid> bids(LadderKind::Flat, 1 << 14);
+  for (Price px : {5000, 5001, 5064, 9100, 12000}) {
+    asks.get_or_add(px).count = 1;
+    bids.get_or_add(px).count = 1;
+  }
+  ASSERT_EQ(asks.best()->price, 5000);
+  ASSERT_EQ(bids.best()->price, 12000);
+
+  std::vector<Price> a, b;
+  asks.walk([&](PriceLevel const& l){ a.push_back(l.price); return true; });
+  bids.walk([&](PriceLevel const& l){ b.push_back(l.price); return true; });
+  EXPECT_EQ(a, (std::vector<Price>{5000, 5001, 5064, 9100, 12000}));
+  EXPECT_EQ(b, (std::vector<Price>{12000, 9100, 5064, 5001, 5000}));
+
+  EXPECT_EQ(asks.next(5064)->price, 9100);
+  EXPECT_EQ(bids.next(5064)->price, 5001);
+  EXPECT_EQ(asks.next(12000), nullptr);
+  EXPECT_EQ(bids.next(5000), nullptr);
+
+  asks.get_or_add(5000).count = 0; asks.erase(5000);
+  EXPECT_EQ(asks.best()->price, 5001);
+  EXPECT_EQ(asks.find(5000), nullptr);
+  std::vector<std::string> err;
+  asks.check_invariants(err);
+  EXPECT_TRUE(err.empty()) << (err.empty() ? "" : err.front());
+}
+
+TEST(Ladder, Flat_recentre_keeps_levels_and_node_links) {
+  Book::BookConfig cfg;
+  cfg.ladder = LadderKind::Flat;
+  cfg.flat_ticks = 64;
+  Book b(cfg);
+  b.submit(1, Side::Bid, 100, 5, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Bid, 100, 3, 2, Book::OrderType::Limit, Book::TimeInForce::Day);
+  // Far outside the initial window on both ends: forces re-centre + growth
+  b.submit(1, Side::Bid, 10, 4, 3, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Ask, 900, 4, 4, Book::OrderType::Limit, Book::TimeInForce::Day);
+  auto errs = b.check_invariants();
+  ASSERT_TRUE(errs.empty()) << errs.front();
+  EXPECT_EQ(*b.best().bid, 100);
+  EXPECT_EQ(*b.best().ask, 900);
+
+  // FIFO survives the move
+  auto t = b.submit(2, Side::Ask, 0, 6, 5, Book::OrderType::Market, Book::TimeInForce::IOC);
+  ASSERT_EQ(t.fills.size(), 2u);
+  EXPECT_EQ(t.fills[0].maker_id, 1u);
+  EXPECT_EQ(t.fills[1].maker_id, 2u);
+  EXPECT_EQ(b.bids_.find(100)->head->level, b.bids_.find(100));
+}
+
+TEST(Ladder, Flat_falls_back_to_map_at_int64_extremes) {
+  constexpr Price kMin = std::numeric_limits<Price>::min(), kMax = std::numeric_limits<Price>::max();
+  Ladder<Side::Ask> asks(LadderKind::Flat, 64, LevelQueue::List, 1024);
+  Ladder<Side::Bid> bids(LadderKind::Flat, 64, LevelQueue::List, 1024);
+  for (Price px : {kMax, Price(0), kMin, kMax - 1, kMin + 1}) {
+    asks.get_or_add(px).count = 1;
+    bids.get_or_add(px).count = 1;
+  }
+  EXPECT_EQ(asks.kind(), LadderKind::Map);
+  EXPECT_EQ(bids.kind(), LadderKind::Map);
+  EXPECT_EQ(asks.flat_window(), 0u);   // flat buffers released
+
+  std::vector<Price> a, b;
+  asks.walk([&](PriceLevel const& l){ a.push_back(l.price); return true; });
+  bids.walk([&](PriceLevel const& l){ b.push_back(l.price); return true; });
+  EXPECT_EQ(a, (std::vector<Price>{kMin, kMin + 1, 0, kMax - 1, kMax}));
+  EXPECT_EQ(b, (std::vector<Price>{kMax, kMax - 1, 0, kMin + 1, kMin}));
+
+  // Emptied: back to the initial flat window, which works at the extremes too.
+  for (Price px : a) { asks.get_or_add(px).count = 0; asks.erase(px); }
+  EXPECT_EQ(asks.kind(), LadderKind::Flat);
+  EXPECT_EQ(asks.flat_window(), 64u);
+  for (Price px : {kMax, kMax - 5, kMax - 63}) asks.get_or_add(px).count = 1;
+  EXPECT_EQ(asks.kind(), LadderKind::Flat);
+  EXPECT_EQ(asks.best()->price, kMax - 63);
+  EXPECT_EQ(asks.next(kMax - 5)->price, kMax);
+  EXPECT_EQ(asks.next(kMax), nullptr);
+  asks.get_or_add(kMin).count = 1;
+  EXPECT_EQ(asks.kind(), LadderKind::Map);
+  EXPECT_EQ(asks.best()->price, kMin);
+}
+
+TEST(Ladder, Flat_window_is_bounded_and_shrinks_when_empty) {
+  constexpr Price kMax = std::numeric_limits<Price>::max();
+  Book::BookConfig cfg;
+  cfg.ladder = LadderKind::Flat;
+  cfg.flat_ticks = 64;
+  cfg.flat_max_ticks = 4096;
+  Book b(cfg);
+  b.submit(1, Side::Bid, 100, 5, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Bid, 1000, 5, 2, Book::OrderType::Limit, Book::TimeInForce::Day);
+  EXPECT_EQ(b.bids_.kind(), LadderKind::Flat);
+  EXPECT_EQ(b.bids_.flat_window(), 2048u);       // grown, within the cap
+
+  b.submit(1, Side::Bid, 1, 5, 3, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Ask, kMax, 5, 4, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Ask, 2000, 5, 5, Book::OrderType::Limit, Book::TimeInForce::Day);
+  EXPECT_EQ(b.bids_.kind(), LadderKind::Flat);
+  EXPECT_EQ(b.asks_.kind(), LadderKind::Map);     // 2000..INT64_MAX does not fit
+  auto errs = b.check_invariants();
+  ASSERT_TRUE(errs.empty()) << errs.front();
+  EXPECT_EQ(*b.best().ask, 2000);
+
+  // Sweeping the asks empties the side: it returns to a 64-tick flat window.
+  auto t = b.submit(2, Side::Bid, 0, 10, 6, Book::OrderType::Market, Book::TimeInForce::IOC);
+  ASSERT_EQ(t.fills.size(), 2u);
+  EXPECT_EQ(t.fills[1].px, kMax);
+  EXPECT_EQ(b.asks_.kind(), LadderKind::Flat);
+  EXPECT_EQ(b.asks_.flat_window(), 64u);
+
+  for (OrderId id : {1, 2, 3}) ASSERT_TRUE(b.cancel(id).ok);
+  EXPECT_EQ(b.bids_.flat_window(), 64u);
+  b.submit(1, Side::Bid, 7, 5, 7, Book::OrderType::Limit, Book::TimeInForce::Day);
+  errs = b.check_invariants();
+  ASSERT_TRUE(errs.empty()) << errs.front();
+  EXPECT_EQ(*b.best().bid, 7);
+}
+
+// Same random flow against both backends must produce identical fills/books.
+TEST(Ladder, Map_and_flat_books_agree) {
+  Book::BookConfig mc, fc;
+  fc.ladder = LadderKind::Flat;
+  fc.flat_ticks = 64;
+  Book m(mc), f(fc);
+
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<int> op(0, 9), sd(0, 1), pd(900, 1100), qd(1, 20);
+  std::uniform_int_distribution<int> tif(0, 2);
+  OrderId next = 1;
+
+  for (int i = 0; i < 20000; ++i) {
+    int o = op(rng);
+    Side s = sd(rng) ? Side::Bid : Side::Ask;
+    if (o < 5) {
+      Price px = pd(rng); Qty q = qd(rng);
+      auto t = Book::TimeInForce(tif(rng));
+      auto rm = m.submit(i % 3, s, px, q, next, Book::OrderType::Limit, t);
+      auto rf = f.submit(i % 3, s, px, q, next, Book::OrderType::Limit, t);
+      ASSERT_EQ(rm.fills.size(), rf.fills.size()) << "step " << i;
+      for (std::size_t k = 0; k < rm.fills.size(); ++k) {
+        EXPECT_EQ(rm.fills[k].maker_id, rf.fills[k].maker_id);
+        EXPECT_EQ(rm.fills[k].px, rf.fills[k].px);
+        EXPECT_EQ(rm.fills[k].qty, rf.fills[k].qty);
+      }
+      EXPECT_EQ(rm.posted_qty, rf.posted_qty);
+      ++next;
+    } else if (o < 7) {
+      Qty q = qd(rng);
+      auto rm = m.submit(9, s, 0, q, next, Book::OrderType::Market, Book::TimeInForce::IOC);
+      auto rf = f.submit(9, s, 0, q, next, Book::OrderType::Market, Book::TimeInForce::IOC);
+      ASSERT_EQ(rm.fills.size(), rf.fills.size()) << "step " << i;
+      ++next;
+    } else if (o < 9) {
+      OrderId id = 1 + rng() % next;
+      auto cm = m.cancel(id), cf = f.cancel(id);
+      EXPECT_EQ(cm.ok, cf.ok);
+      EXPECT_EQ(cm.qty_canceled, cf.qty_canceled);
+    } else {
+      OrderId id = 1 + rng() % next;
+      Price px = pd(rng); Qty q = qd(rng);
+      EXPECT_EQ(m.replace(i % 3, id, px, q).ok, f.replace(i % 3, id, px, q).ok);
+    }
+    ASSERT_EQ(m.best().bid, f.best().bid) << "step " << i;
+    ASSERT_EQ(m.best().ask, f.best().ask) << "step " << i;
+    ASSERT_EQ(m.bids_total_, f.bids_total_);
+    ASSERT_EQ(m.asks_total_, f.asks_total_);
+    if (i % 500 == 0) {
+      auto em = m.check_invariants(), ef = f.check_invariants();
+      ASSERT_TRUE(em.empty()) << em.front();
+      ASSERT_TRUE(ef.empty()) << ef.front();
+    }
+  }
+  EXPECT_EQ(m.bids_.size(), f.bids_.size());
+  EXPECT_EQ(m.asks_.size(), f.asks_.size());
+}
+
+TEST(Ladder, MatchEngine_runs_on_flat_backend) {
+  EventBus bus(1<<16);
+  Book::BookConfig cfg;
+  cfg.ladder = LadderKind::Flat;
+  MatchEngine eng(bus, cfg);
+
+  eng.add(1, Side::Sell, 100, 3);
+  eng.add(2, Side::Sell, 100, 5);
+  eng.add(42, Side::Buy, 100, 6);
+  EXPECT_EQ(eng.book_level_qty(Side::Sell, 100), 2);
+
+  int fills = 0;
+  while (auto ev = bus.try_poll())
+    if (ev->is<FillEvent>()) fills++;
+  EXPECT_EQ(fills, 2);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "lob/book.hpp"
+
+using namespace lob;
+
+static Book::BookConfig ring_cfg() {
+  Book::BookConfig cfg;
+  cfg.queue = LevelQueue::Ring;
+  return cfg;
+}
+
+static std::vector<OrderId> fifo(const PriceLevel& lvl) {
+  std::vector<OrderId> v;
+  lvl.for_each([&](OrderNode* n){ v.push_back(n->id); });
+  return v;
+}
+
+TEST(LevelQueue, Ring_cancel_tombstones_keep_fifo_and_compact) {
+  Book b(ring_cfg());
+  for (OrderId id = 1; id <= 40; ++id)
+    b.submit(1, Side::Ask, 100, 1, id, Book::OrderType::Limit, Book::TimeInForce::Day);
+  auto* lvl = b.asks_.find(100);
+  ASSERT_TRUE(lvl->is_ring());
+  EXPECT_EQ(lvl->ring.size(), 64u);      // grown 8 -> 64
+
+  // Cancel from the middle: tombstones until they outnumber live orders
+  for (OrderId id = 2; id <= 20; id += 2) ASSERT_TRUE(b.cancel(id).ok);
+  EXPECT_EQ(lvl->tombs, 10u);
+  for (OrderId id = 21; id <= 39; ++id) ASSERT_TRUE(b.cancel(id).ok);
+  EXPECT_EQ(lvl->count, 11u);
+  EXPECT_LT(lvl->tombs, 10u);            // compacted once tombstones outnumbered orders
+  EXPECT_EQ(lvl->rtail - lvl->rhead, lvl->count + lvl->tombs);
+  EXPECT_EQ(fifo(*lvl), (std::vector<OrderId>{1,3,5,7,9,11,13,15,17,19,40}));
+  auto errs = b.check_invariants();
+  ASSERT_TRUE(errs.empty()) << errs.front();
+
+  // Sweep honours FIFO across the compacted ring
+  auto r = b.submit(2, Side::Bid, 100, 3, 99, Book::OrderType::Limit, Book::TimeInForce::IOC);
+  ASSERT_EQ(r.fills.size(), 3u);
+  EXPECT_EQ(r.fills[0].maker_id, 1u);
+  EXPECT_EQ(r.fills[1].maker_id, 3u);
+  EXPECT_EQ(r.fills[2].maker_id, 5u);
+  EXPECT_TRUE(b.check_invariants().empty());
+}
+
+TEST(LevelQueue, Ring_partial_fill_and_replace_keep_node_in_sync) {
+  Book b(ring_cfg());
+  b.submit(1, Side::Bid, 100, 10, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Bid, 100, 10, 2, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(2, Side::Ask, 100, 4, 3, Book::OrderType::Limit, Book::TimeInForce::Day);
+  EXPECT_EQ(b.id_index_.find(1)->node->qty, 6);
+  ASSERT_TRUE(b.replace(1, 2, 100, 7).ok);    // in-place size decrease
+  ASSERT_TRUE(b.reduce(1, 6));                // reduce to zero removes the head
+  auto* lvl = b.bids_.find(100);
+  EXPECT_EQ(lvl->front_id(), 2u);
+  EXPECT_EQ(lvl->front_qty(), 7);
+  EXPECT_EQ(lvl->total_qty, 7);
+  auto errs = b.check_invariants();
+  EXPECT_TRUE(errs.empty()) << (errs.empty() ? "" : errs.front());
+}
+
+// Same random flow against list and ring levels must produce identical fills.
+TEST(LevelQueue, List_and_ring_books_agree) {
+  for (auto ladder : {LadderKind::Map, LadderKind::Flat}) {
+    Book::BookConfig lc, rc = ring_cfg();
+    lc.ladder = rc.ladder = ladder;
+    lc.flat_ticks = rc.flat_ticks = 64;
+    lc.stp = rc.stp = Book::STPPolicy::CancelBoth;
+    Book l(lc), r(rc);
+
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<int> op(0, 9), pd(990, 1010), qd(1, 20), tif(0, 2);
+    OrderId next = 1;
+    for (int i = 0; i < 20000; ++i) {
+      int o = op(rng);
+      Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+      if (o < 5) {
+        Price px = pd(rng); Qty q = qd(rng);
+        auto t = Book::TimeInForce(tif(rng));
+        auto a = l.submit(i % 4, s, px, q, next, Book::OrderType::Limit, t);
+        auto c = r.submit(i % 4, s, px, q, next, Book::OrderType::Limit, t);
+        ASSERT_EQ(a.fills.size(), c.fills.size()) << "step " << i;
+        for (std::size_t k = 0; k < a.fills.size(); ++k) {
+          EXPECT_EQ(a.fills[k].maker_id, c.fills[k].maker_id);
+          EXPECT_EQ(a.fills[k].qty, c.fills[k].qty);
+        }
+        ++next;
+      } else if (o < 8) {
+        OrderId id = 1 + rng() % next;
+        EXPECT_EQ(l.cancel(id).ok, r.cancel(id).ok);
+      } else {
+        OrderId id = 1 + rng() % next;
+        Price px = pd(rng); Qty q = qd(rng);
+        EXPECT_EQ(l.replace(i % 4, id, px, q).ok, r.replace(i % 4, id, px, q).ok);
+      }
+      ASSERT_EQ(l.bids_total_, r.bids_total_) << "step " << i;
+      ASSERT_EQ(l.asks_total_, r.asks_total_) << "step " << i;
+      if (i % 500 == 0) {
+        auto er = r.check_invariants();
+        ASSERT_TRUE(er.empty()) << er.front();
+      }
+    }
+  }
+}
@@ -16,8 +16,8 @@ TEST(Match, FifoAndPartial) {
 
   int fills=0; Qty sum=0; OrderId first=0, second=0;
   while (auto ev=bus.try_poll()) {
-    if (std::holds_alternative<FillEvent>(*ev)) {
-      auto f = std::get<FillEvent>(*ev);
+    if (ev->is<FillEvent>()) {
+      auto f = ev->get<FillEvent>();
       fills++; sum+=f.qty;
       if (fills==1) first=f.maker_id; else if (fills==2) second=f.maker_id;
     }
@@ -35,7 +35,7 @@ TEST(Match, CancelRemovesQty) {
   eng.cancel(10);
   int cancels=0;
   while (auto ev=bus.try_poll()) {
-    if (std::holds_alternative<CancelEvent>(*ev)) cancels++;
+    if (ev->is<CancelEvent>()) cancels++;
   }
   EXPECT_EQ(cancels, 1);
 }
\ No newline at end of file
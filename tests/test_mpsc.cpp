@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../engine/spsc/mpsc_channel.hpp"
+
+TEST(MpscRing, Fifo_full_and_empty_single_thread) {
+  MpscRing<int> q(8);
+  int x = 0;
+  EXPECT_FALSE(q.try_pop(x));
+  EXPECT_TRUE(q.empty());
+  int next_in = 0, next_out = 0;
+  for (int round = 0; round < 50; ++round) {
+    while (q.try_push(next_in)) ++next_in;
+    EXPECT_EQ(q.size(), 8u);
+    for (int k = 0; k < 1 + round % 7; ++k) {
+      ASSERT_TRUE(q.try_pop(x));
+      ASSERT_EQ(x, next_out++);
+    }
+  }
+  std::vector<int> rest;
+  q.try_pop_bulk(100, [&](int&& v){ rest.push_back(v); });
+  for (int v : rest) ASSERT_EQ(v, next_out++);
+  EXPECT_EQ(next_out, next_in);
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(MpscRing, Failed_push_leaves_value_and_destructor_cleans_up) {
+  auto counter = std::make_shared<int>(0);
+  {
+    MpscRing<std::shared_ptr<int>> q(2);
+    auto a = counter, b = counter, c = counter;
+    EXPECT_TRUE(q.try_push(std::move(a)));
+    EXPECT_TRUE(q.try_push(std::move(b)));
+    EXPECT_FALSE(q.try_push(std::move(c)));
+    EXPECT_EQ(c, counter);                     // not moved from on failure
+    EXPECT_EQ(counter.use_count(), 4);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(MpscRing, Capacity_must_be_pow2) {
+  EXPECT_THROW(MpscRing<int>(12), std::invalid_argument);
+}
+
+// Each producer tags values with its id; per-producer order must be kept and
+// nothing may be lost or duplicated.
+TEST(MpscRing, Many_producers_one_consumer) {
+  constexpr unsigned P = 4;
+  constexpr std::uint64_t N = 100000;
+  MpscRing<std::uint64_t> q(64);
+  std::vector<std::thread> prods;
+  for (unsigned p = 0; p < P; ++p) {
+    prods.emplace_back([&, p]{
+      for (std::uint64_t i = 0; i < N;) {
+        if (q.try_push(std::uint64_t(p) << 32 | i)) ++i;
+        else std::this_thread::yield();
+      }
+    });
+  }
+  std::vector<std::uint64_t> next(P, 0);
+  std::uint64_t got = 0;
+  while (got < P * N) {
+    const std::size_t n = q.try_pop_bulk(32, [&](std::uint64_t&& v){
+      const unsigned p = unsigned(v >> 32);
+      ASSERT_LT(p, P);
+      ASSERT_EQ(v & 0xffffffffu, next[p]);
+      ++next[p];
+    });
+    got += n;
+    if (!n) std::this_thread::yield();
+  }
+  for (auto& t : prods) t.join();
+  for (unsigned p = 0; p < P; ++p) EXPECT_EQ(next[p], N);
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(MpscChannel, Drop_mode_counts_drops_at_high_watermark) {
+  SpscStats stats;
+  MpscChannel<int> ch(16, BackpressureCfg(8), &stats);
+  int pushed = 0;
+  for (int i = 0; i < 20; ++i) pushed += ch.push(i, nullptr);
+  EXPECT_EQ(pushed, 8);
+  EXPECT_EQ(stats.drops_total.load(), 12u);
+  EXPECT_EQ(stats.push_ok.load(), 8u);
+  int x;
+  std::size_t popped = 0;
+  while (ch.pop(x)) ++popped;
+  EXPECT_EQ(popped, 8u);
+  EXPECT_EQ(stats.pop_ok.load(), 8u);
+}
+
+TEST(MpscChannel, Stop_flag_releases_blocked_producer) {
+  MpscChannel<int> ch(4, BackpressureCfg(4, 2, BpMode::Spin), nullptr);
+  std::atomic<bool> stop{false};
+  for (int i = 0; i < 4; ++i) ASSERT_TRUE(ch.push(i, &stop));
+  std::thread t([&]{ EXPECT_FALSE(ch.push(99, &stop)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  stop.store(true);
+  t.join();
+  EXPECT_EQ(ch.size(), 4u);
+}
+
+TEST(MpscChannel, Sleep_mode_delivers_everything_from_several_producers) {
+  constexpr unsigned P = 3;
+  constexpr int N = 20000;
+  SpscStats stats;
+  MpscChannel<std::uint64_t> ch(64, BackpressureCfg(48, 16, BpMode::Sleep, 1000), &stats);
+  std::vector<std::thread> prods;
+  for (unsigned p = 0; p < P; ++p)
+    prods.emplace_back([&, p]{ for (int i = 0; i < N; ++i) ASSERT_TRUE(ch.push(std::uint64_t(p) << 32 | unsigned(i), nullptr)); });
+  std::vector<std::uint64_t> next(P, 0);
+  std::uint64_t got = 0;
+  while (got < P * N) {
+    const std::size_t n = ch.pop_bulk(16, [&](std::uint64_t&& v){
+      ASSERT_EQ(v & 0xffffffffu, next[v >> 32]++);
+    });
+    got += n;
+    if (!n) std::this_thread::yield();
+  }
+  for (auto& t : prods) t.join();
+  EXPECT_EQ(stats.drops_total.load(), 0u);
+  EXPECT_EQ(stats.push_ok.load(), std::uint64_t(P) * N);
+  EXPECT_EQ(stats.pop_ok.load(), std::uint64_t(P) * N);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <unordered_map>
+#include "lob/order_index.hpp"
+#include "lob/book.hpp"
+
+using namespace lob;
+
+static OrderNode* tag(std::uintptr_t v) { return reinterpret_cast<OrderNode*>(v << 4); }
+
+TEST(OrderIndex, Insert_find_overwrite_erase) {
+  OrderIndex ix;
+  ix.insert(7, tag(1), 70);
+  ix.insert(8, tag(2), 80);
+  ASSERT_NE(ix.find(7), nullptr);
+  EXPECT_EQ(ix.find(7)->node, tag(1));
+  EXPECT_EQ(ix.find(8)->owner, 80u);
+  EXPECT_EQ(ix.find(9), nullptr);
+
+  ix.insert(7, tag(3), 71);             // overwrite, no duplicate
+  EXPECT_EQ(ix.size(), 2u);
+  EXPECT_EQ(ix.find(7)->node, tag(3));
+
+  EXPECT_TRUE(ix.erase(7));
+  EXPECT_FALSE(ix.erase(7));
+  EXPECT_EQ(ix.find(7), nullptr);
+  EXPECT_EQ(ix.find(8)->node, tag(2));
+  EXPECT_EQ(ix.size(), 1u);
+}
+
+TEST(OrderIndex, Reserve_avoids_rehash) {
+  OrderIndex ix;
+  ix.reserve(10000);
+  auto cap = ix.capacity();
+  for (OrderId i = 0; i < 10000; ++i) ix.insert(i, tag(i + 1), 0);
+  EXPECT_EQ(ix.capacity(), cap);
+  EXPECT_EQ(ix.size(), 10000u);
+}
+
+TEST(OrderIndex, Moved_from_index_stays_usable) {
+  OrderIndex a;
+  for (OrderId i = 1; i <= 100; ++i) a.insert(i, tag(i), 0);
+  OrderIndex b(std::move(a));
+  EXPECT_EQ(b.size(), 100u);
+  EXPECT_EQ(b.find(42)->node, tag(42));
+
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(a.find(42), nullptr);
+  EXPECT_FALSE(a.erase(42));
+  for (OrderId i = 1; i <= 50; ++i) a.insert(i, tag(i + 1), 0);
+  EXPECT_EQ(a.size(), 50u);
+  EXPECT_EQ(a.find(50)->node, tag(51));
+
+  OrderIndex c;
+  c.insert(7, tag(7), 0);
+  c = std::move(b);
+  EXPECT_EQ(c.size(), 100u);
+  EXPECT_EQ(c.find(7)->node, tag(7));
+  EXPECT_EQ(b.find(7), nullptr);
+  b.insert(7, tag(8), 0);
+  EXPECT_EQ(b.find(7)->node, tag(8));
+  b.clear();
+  b.reserve(1000);
+  EXPECT_GE(b.capacity(), 1000u);
+}
+
+// Random churn against std::unordered_map: backward-shift deletion must keep
+// every surviving key reachable.
+TEST(OrderIndex, Matches_reference_map_under_churn) {
+  OrderIndex ix;
+  std::unordered_map<OrderId, std::pair<OrderNode*, TraderId>> ref;
+  std::mt19937_64 rng(99);
+  for (int i = 0; i < 200000; ++i) {
+    OrderId id = rng() % 4096;               // dense keys -> long clusters
+    if (rng() % 3) {
+      ix.insert(id, tag(i + 1), i);
+      ref[id] = {tag(i + 1), TraderId(i)};
+    } else {
+      EXPECT_EQ(ix.erase(id), ref.erase(id) == 1);
+    }
+  }
+  ASSERT_EQ(ix.size(), ref.size());
+  for (auto& [id, v] : ref) {
+    auto* s = ix.find(id);
+    ASSERT_NE(s, nullptr) << id;
+    EXPECT_EQ(s->node, v.first);
+    EXPECT_EQ(s->owner, v.second);
+  }
+  std::size_t live = 0;
+  ix.for_each([&](OrderIndex::Slot const& s){ ++live; EXPECT_TRUE(ref.count(s.id)); });
+  EXPECT_EQ(live, ref.size());
+}
+
+TEST(OrderIndex, Book_keeps_owner_in_index_slot) {
+  Book b;
+  b.submit(/*trader*/5, Side::Bid, 100, 3, 11, Book::OrderType::Limit, Book::TimeInForce::Day);
+  ASSERT_NE(b.id_index_.find(11), nullptr);
+  EXPECT_EQ(b.id_index_.find(11)->owner, 5u);
+
+  EXPECT_FALSE(b.replace(/*trader*/6, 11, 101, 3).ok);   // wrong owner
+  EXPECT_TRUE(b.replace(/*trader*/5, 11, 101, 3).ok);
+  EXPECT_EQ(b.id_index_.find(11)->owner, 5u);
+  EXPECT_TRUE(b.cancel(11).ok);
+  EXPECT_TRUE(b.id_index_.empty());
+  auto errs = b.check_invariants();
+  EXPECT_TRUE(errs.empty()) << (errs.empty() ? "" : errs.front());
+}
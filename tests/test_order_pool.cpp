@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include "lob/book.hpp"
+#include "lob/order_pool.hpp"
+
+using namespace lob;
+
+TEST(OrderPool, Reuses_freed_nodes_and_tracks_high_water) {
+  OrderPool pool(/*slab_nodes*/4);
+  auto* a = pool.make({ .id=1 });
+  auto* b = pool.make({ .id=2 });
+  EXPECT_EQ(pool.stats().in_use, 2u);
+  EXPECT_EQ(pool.stats().capacity, 4u);
+
+  pool.destroy(a);
+  auto* c = pool.make({ .id=3 });
+  EXPECT_EQ(c, a);                    // LIFO freelist hands back the hot node
+  EXPECT_EQ(c->id, 3u);
+  EXPECT_EQ(c->next, nullptr);        // freelist link does not leak into the node
+
+  pool.destroy(b); pool.destroy(c);
+  EXPECT_EQ(pool.stats().in_use, 0u);
+  EXPECT_EQ(pool.stats().high_water, 2u);
+}
+
+TEST(OrderPool, Grows_by_whole_slabs_and_reserve_presizes) {
+  OrderPool pool(/*slab_nodes*/8);
+  pool.reserve(20);
+  EXPECT_EQ(pool.stats().slabs, 3u);
+  EXPECT_EQ(pool.stats().capacity, 24u);
+  pool.prefault();
+
+  std::vector<OrderNode*> v;
+  for (int i = 0; i < 25; ++i) v.push_back(pool.make({ .id=OrderId(i) }));
+  EXPECT_EQ(pool.stats().slabs, 4u);   // 25th node forced one more slab
+  for (auto* n : v) pool.destroy(n);
+  EXPECT_EQ(pool.stats().high_water, 25u);
+}
+
+TEST(OrderPool, Book_returns_every_node_on_fill_cancel_and_clear) {
+  Book::BookConfig cfg;
+  cfg.reserve_orders = 64;
+  Book b(cfg);
+  EXPECT_GE(b.pool_stats().capacity, 64u);
+
+  b.submit(1, Side::Ask, 100, 5, 1, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Ask, 101, 5, 2, Book::OrderType::Limit, Book::TimeInForce::Day);
+  b.submit(1, Side::Bid,  99, 5, 3, Book::OrderType::Limit, Book::TimeInForce::Day);
+  EXPECT_EQ(b.pool_stats().in_use, 3u);
+
+  b.submit(2, Side::Bid, 100, 5, 4, Book::OrderType::Limit, Book::TimeInForce::Day); // fills id=1
+  EXPECT_EQ(b.pool_stats().in_use, 2u);
+  b.cancel(3);
+  EXPECT_EQ(b.pool_stats().in_use, 1u);
+  EXPECT_EQ(b.pool_stats().high_water, 3u);
+
+  b.clear_all();
+  EXPECT_EQ(b.pool_stats().in_use, 0u);
+  auto errs = b.check_invariants();
+  EXPECT_TRUE(errs.empty()) << (errs.empty() ? "" : errs.front());
+}
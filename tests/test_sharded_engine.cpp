@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "../engine/sharded_engine.hpp"
+
+using namespace lob;
+
+namespace {
+
+// Random command flow over nsym symbols; ids are unique per symbol.
+std::vector<Command> make_flow(SymbolId nsym, std::size_t n, std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<Command> out;
+  std::vector<OrderId> next(nsym, 1);
+  for (std::size_t i = 0; i < n; ++i) {
+    const SymbolId s = SymbolId(rng() % nsym);
+    const Side side = (rng() & 1) ? Side::Bid : Side::Ask;
+    const Price px = 100 + Price(rng() % 9) - 4;
+    const Qty qty = 1 + Qty(rng() % 5);
+    switch (rng() % 8) {
+      case 0:  out.push_back(make_cancel(s, 1 + rng() % next[s])); break;
+      case 1:  out.push_back(make_market(s, 1, next[s]++, side, qty)); break;
+      case 2:  out.push_back(make_replace(s, 1, 1 + rng() % next[s], px, qty)); break;
+      default: out.push_back(make_add(s, 1 + rng() % 3, next[s]++, side, px, qty)); break;
+    }
+  }
+  return out;
+}
+
+ShardedEngine::Config shards(std::size_t n) {
+  ShardedEngine::Config cfg;
+  cfg.shards = n;
+  return cfg;
+}
+
+} // namespace
+
+TEST(ShardedEngine, Symbols_deal_round_robin) {
+  ShardedEngine eng(shards(3));
+  for (int s = 0; s < 7; ++s) EXPECT_EQ(eng.add_symbol("S" + std::to_string(s)), SymbolId(s));
+  EXPECT_EQ(eng.add_symbol("S2"), 2u);          // idempotent
+  EXPECT_EQ(eng.symbols(), 7u);
+  for (SymbolId s = 0; s < 7; ++s) EXPECT_EQ(eng.shard_of(s), s % 3);
+}
+
+// Every shard must end in the same state as one MatchEngine fed the same
+// commands, and its events must carry global symbol ids.
+TEST(ShardedEngine, Matches_single_engine_reference) {
+  constexpr SymbolId kSyms = 10;
+  const auto flow = make_flow(kSyms, 20000, 7);
+
+  EventBus ref_bus(1u << 18);
+  MatchEngine ref(ref_bus);
+  for (SymbolId s = 0; s < kSyms; ++s) ref.add_symbol("S" + std::to_string(s));   // ids s+1
+  std::map<SymbolId, Qty> ref_filled;
+  for (Command c : flow) {
+    c.symbol += 1;
+    ref.apply(c);
+    while (auto ev = ref_bus.try_poll())
+      if (auto* f = ev->get_if<FillEvent>()) ref_filled[f->symbol - 1] += f->qty;
+  }
+
+  auto cfg = shards(3);
+  cfg.inbound_cap = 256;      // small rings: exercise backpressure
+  cfg.shard_cap = 64;
+  cfg.bus_cap = 1u << 18;     // keep every event for the comparison
+  ShardedEngine eng(cfg);
+  for (SymbolId s = 0; s < kSyms; ++s) eng.add_symbol("S" + std::to_string(s));
+  eng.start();
+  for (const Command& c : flow) eng.submit(c);
+  eng.submit(make_add(kSyms + 5, 1, 1, Side::Bid, 100, 1));   // unknown symbol
+  eng.stop();
+
+  EXPECT_EQ(eng.processed_total(), flow.size());
+  EXPECT_EQ(eng.rejected(), 1u);
+  EXPECT_TRUE(eng.idle());
+
+  std::map<SymbolId, Qty> filled;
+  for (std::size_t i = 0; i < eng.shards(); ++i)
+    eng.poll(i, [&](const Event& ev){
+      if (auto* f = ev.get_if<FillEvent>()) {
+        EXPECT_EQ(eng.shard_of(f->symbol), i);
+        filled[f->symbol] += f->qty;
+      }
+    });
+  EXPECT_EQ(filled, ref_filled);
+
+  for (SymbolId s = 0; s < kSyms; ++s) {
+    const Book& b = eng.book(s);
+    auto errs = b.check_invariants();
+    ASSERT_TRUE(errs.empty()) << errs.front();
+    EXPECT_EQ(b.bids_total_, ref.book(s + 1).bids_total_);
+    EXPECT_EQ(b.asks_total_, ref.book(s + 1).asks_total_);
+    for (Price px = 90; px <= 110; ++px) {
+      EXPECT_EQ(eng.book_level_qty(s, Side::Bid, px), ref.book_level_qty(s + 1, Side::Bid, px));
+      EXPECT_EQ(eng.book_level_qty(s, Side::Ask, px), ref.book_level_qty(s + 1, Side::Ask, px));
+    }
+  }
+}
+
+TEST(ShardedEngine, Stop_without_traffic) {
+  ShardedEngine eng(shards(2));
+  eng.add_symbol("A");
+  eng.start();
+  eng.stop();
+  eng.stop();
+  EXPECT_EQ(eng.processed_total(), 0u);
+}
+
+TEST(ShardedEngine, Start_rejects_an_unusable_cpu) {
+  auto cfg = shards(2);
+  cfg.shard_cpus = {-1, 1 << 20};
+  ShardedEngine eng(cfg);
+  eng.add_symbol("A");
+  EXPECT_THROW(eng.start(), std::invalid_argument);
+
+  cfg.shard_cpus.clear();
+  cfg.router_cpu = 1 << 20;
+  ShardedEngine eng2(cfg);
+  EXPECT_THROW(eng2.start(), std::invalid_argument);
+
+  cfg.router_cpu = -1;
+  int ok = 0;
+  while (!cpu::usable(ok)) ++ok;
+  cfg.shard_cpus = {ok};                // usable: starts and pins
+  ShardedEngine eng3(cfg);
+  eng3.add_symbol("A");
+  eng3.start();
+  eng3.stop();
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../engine/match_engine.hpp"
+#include "../engine/shm_event_bus.hpp"
+
+namespace {
+
+std::string unique_name(const char* tag) {
+  return "/mhft_test_" + std::string(tag) + "_" + std::to_string(::getpid());
+}
+
+} // namespace
+
+TEST(ShmSpscRing, Attached_mapping_sees_pushes_across_wraparound) {
+  const std::string name = unique_name("wrap");
+  auto prod = ShmSpscRing<std::uint64_t>::create(name, 8);
+  auto cons = ShmSpscRing<std::uint64_t>::attach(name);
+  io::SharedMemory::unlink(name);               // mappings outlive the name
+  EXPECT_EQ(cons.capacity(), 8u);
+
+  std::uint64_t in = 0, out = 0, v = 0;
+  for (int round = 0; round < 40; ++round) {
+    while (prod.try_push(in)) ++in;
+    EXPECT_TRUE(cons.full());
+    for (int k = 0; k < 1 + round % 5; ++k) {
+      ASSERT_TRUE(cons.try_pop(v));
+      ASSERT_EQ(v, out++);
+    }
+  }
+  cons.try_pop_bulk(100, [&](std::uint64_t&& x){ ASSERT_EQ(x, out++); });
+  EXPECT_EQ(out, in);
+  EXPECT_TRUE(prod.empty());
+}
+
+TEST(ShmSpscRing, Attach_rejects_mismatched_or_missing_regions) {
+  const std::string name = unique_name("reject");
+  auto ring = ShmSpscRing<std::uint64_t>::create(name, 16);
+  EXPECT_THROW(ShmSpscRing<std::uint32_t>::attach(name), std::runtime_error);   // slot size
+
+  auto* hdr = reinterpret_cast<ShmRingHeader*>(ring.region().data());
+  hdr->version = ShmRingHeader::kVersion + 1;
+  EXPECT_THROW(ShmSpscRing<std::uint64_t>::attach(name), std::runtime_error);
+  hdr->version = ShmRingHeader::kVersion;
+  EXPECT_NO_THROW(ShmSpscRing<std::uint64_t>::attach(name));
+
+  io::SharedMemory::unlink(name);
+  EXPECT_THROW(ShmSpscRing<std::uint64_t>::attach(name), std::runtime_error);
+  EXPECT_THROW(ShmSpscRing<std::uint64_t>::create(name, 12), std::invalid_argument);
+}
+
+// A child process publishes through the inherited memfd; the parent consumes.
+TEST(ShmEventBus, Events_cross_a_process_boundary_in_order) {
+  constexpr std::uint64_t N = 200000;
+  auto ring = ShmSpscRing<Event>::create_memfd(1u << 10);
+  const int fd = ring.region().fd();
+  ShmEventBus bus(std::move(ring));
+
+  const pid_t pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    int rc = 0;
+    try {
+      ShmEventBus out(ShmSpscRing<Event>::attach_fd(fd));
+      for (std::uint64_t i = 0; i < N; ++i)
+        while (!out.publish_in_place<FillEvent>(i, i + 1, Price(100 + i % 7), Qty(i % 13 + 1), SymbolId(3), Side::Bid))
+          ::sched_yield();
+    } catch (...) { rc = 1; }
+    ::_exit(rc);
+  }
+
+  std::uint64_t got = 0;
+  bool ok = true;
+  while (got < N) {
+    const std::size_t n = bus.poll_bulk(64, [&](Event&& ev){
+      const FillEvent* f = ev.get_if<FillEvent>();
+      ok &= f && ev.seq == got + 1 && f->taker_id == got && f->qty == Qty(got % 13 + 1);
+      ++got;
+    });
+    if (!n) ::sched_yield();
+  }
+  int status = 0;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  EXPECT_TRUE(ok);
+  EXPECT_FALSE(bus.peek());
+}
+
+// The engine publishes straight into shared memory; a second mapping of the
+// region (as another process would have) reads the fills.
+TEST(ShmEventBus, MatchEngine_publishes_into_shared_memory) {
+  const std::string name = unique_name("engine");
+  ShmEventBus bus(ShmSpscRing<Event>::create(name, 1u << 10));
+  ShmEventBus reader(ShmSpscRing<Event>::attach(name));
+  io::SharedMemory::unlink(name);
+
+  BasicMatchEngine<ShmEventBus> eng(bus);
+  eng.add(1, 1, Side::Ask, 101, 5);
+  eng.add(1, 2, Side::Bid, 101, 3);
+
+  std::vector<Event> seen;
+  reader.poll_bulk(100, [&](Event&& ev){ seen.push_back(ev); });
+  ASSERT_FALSE(seen.empty());
+  EXPECT_EQ(seen.back().seq, bus.published());
+  std::size_t fills = 0;
+  for (const Event& ev : seen)
+    if (const FillEvent* f = ev.get_if<FillEvent>()) {
+      ++fills;
+      EXPECT_EQ(f->maker_id, 1u);
+      EXPECT_EQ(f->qty, 3);
+    }
+  EXPECT_EQ(fills, 1u);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "lob/snapshot.hpp"
+
+using namespace lob;
+
+namespace {
+
+std::string tmp_path(const char* name) { return testing::TempDir() + name; }
+
+// Random resting flow with crosses, cancels and several owners.
+void fill(Book& b, int n, std::uint32_t seed) {
+  std::mt19937_64 rng(seed);
+  for (OrderId id = 1; id <= OrderId(n); ++id) {
+    const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+    const Price px = 1000 + Price(rng() % 41) - 20 + (s == Side::Bid ? -6 : 6);
+    if (rng() % 5 == 0) b.cancel(1 + rng() % id);
+    b.submit(1 + rng() % 4, s, px, 1 + Qty(rng() % 9), id, Book::OrderType::Limit, Book::TimeInForce::Day);
+  }
+}
+
+// Levels, FIFO order, owners and quantities, side by side.
+void expect_same(const Book& a, const Book& b) {
+  auto dump = [](const Book& x){
+    std::vector<std::tuple<int, Price, OrderId, TraderId, Qty>> v;
+    auto side = [&](auto const& ladder, int s){
+      ladder.walk([&](PriceLevel const& l){
+        l.for_each([&](OrderNode* n){ v.emplace_back(s, l.price, n->id, x.id_index_.find(n->id)->owner, n->qty); });
+        return true;
+      });
+    };
+    side(x.bids_, 0); side(x.asks_, 1);
+    return v;
+  };
+  EXPECT_EQ(dump(a), dump(b));
+  EXPECT_EQ(a.bids_total_, b.bids_total_);
+  EXPECT_EQ(a.asks_total_, b.asks_total_);
+}
+
+} // namespace
+
+TEST(Snapshot, Round_trip_every_config_then_keeps_matching) {
+  const std::string path = tmp_path("book.snap");
+  for (auto ladder : {LadderKind::Map, LadderKind::Flat})
+  for (auto queue : {LevelQueue::List, LevelQueue::Ring})
+  for (bool tree : {false, true}) {
+    Book::BookConfig cfg;
+    cfg.ladder = ladder; cfg.queue = queue; cfg.depth_tree = tree;
+    cfg.stp = Book::STPPolicy::CancelTaker;
+    Book a(cfg);
+    fill(a, 5000, 11);
+    snapshot::save(a, path);
+    Book b = snapshot::load_book(path);
+    EXPECT_TRUE(b.check_invariants().empty());
+    EXPECT_EQ(b.cfg_.ladder, ladder);
+    EXPECT_EQ(b.cfg_.queue, queue);
+    EXPECT_EQ(b.cfg_.depth_tree, tree);
+    EXPECT_EQ(b.cfg_.stp, Book::STPPolicy::CancelTaker);
+    expect_same(a, b);
+
+    // Same future flow (priority, owners for STP) => same fills.
+    std::mt19937_64 rng(5);
+    for (OrderId id = 100000; id < 101000; ++id) {
+      const Side s = (rng() & 1) ? Side::Bid : Side::Ask;
+      const Price px = 1000 + Price(rng() % 21) - 10;
+      const TraderId t = 1 + rng() % 4;
+      const Qty q = 1 + Qty(rng() % 20);
+      auto ra = a.submit(t, s, px, q, id, Book::OrderType::Limit, Book::TimeInForce::IOC);
+      auto rb = b.submit(t, s, px, q, id, Book::OrderType::Limit, Book::TimeInForce::IOC);
+      ASSERT_EQ(ra.fills.size(), rb.fills.size());
+      for (std::size_t i = 0; i < ra.fills.size(); ++i) {
+        EXPECT_EQ(ra.fills[i].maker_id, rb.fills[i].maker_id);
+        EXPECT_EQ(ra.fills[i].qty, rb.fills[i].qty);
+      }
+    }
+    expect_same(a, b);
+  }
+}
+
+TEST(Snapshot, Book_set_keeps_names_and_ids) {
+  const std::string path = tmp_path("set.snap");
+  BookSet set;
+  for (int s = 0; s < 5; ++s) fill(set[set.add("SYM" + std::to_string(s))], 300 * (s + 1), s);
+  set.add("EMPTY");
+  snapshot::save(set, path);
+
+  BookSet back = snapshot::load_set(path);
+  ASSERT_EQ(back.size(), set.size());
+  for (SymbolId id = 0; id < set.size(); ++id) {
+    EXPECT_EQ(back.name(id), set.name(id));
+    expect_same(set[id], back[id]);
+  }
+  EXPECT_EQ(*back.find("EMPTY"), 5u);
+}
+
+TEST(Snapshot, Rejects_damaged_files) {
+  const std::string path = tmp_path("bad.snap");
+  Book a;
+  fill(a, 500, 3);
+  snapshot::save(a, path);
+
+  std::string bytes;
+  { std::ifstream in(path, std::ios::binary); bytes.assign(std::istreambuf_iterator<char>(in), {}); }
+  auto write = [&](const std::string& s){ std::ofstream(path, std::ios::binary | std::ios::trunc) << s; };
+
+  write(bytes.substr(0, bytes.size() - 8));                  // truncated
+  EXPECT_THROW(snapshot::load_book(path), std::runtime_error);
+
+  std::string bad = bytes; bad[0] = 'X';                     // magic
+  write(bad);
+  EXPECT_THROW(snapshot::load_book(path), std::runtime_error);
+
+  // First bid level's price pushed through the asks: a crossed book.
+  bad = bytes;
+  const std::size_t lvl = sizeof(snapshot::FileHeader) + sizeof(snapshot::BookHeader);
+  const Price crossed = 5000;
+  std::memcpy(bad.data() + lvl, &crossed, sizeof crossed);
+  write(bad);
+  EXPECT_THROW(snapshot::load_book(path), std::runtime_error);
+
+  EXPECT_THROW(snapshot::load_book(tmp_path("missing.snap")), std::runtime_error);
+}
+
+TEST(Snapshot, Rejects_unknown_config_enums) {
+  const std::string path = tmp_path("bad_cfg.snap");
+  Book a;
+  fill(a, 50, 5);
+  snapshot::save(a, path);
+  std::string bytes;
+  { std::ifstream in(path, std::ios::binary); bytes.assign(std::istreambuf_iterator<char>(in), {}); }
+
+  const std::size_t book = sizeof(snapshot::FileHeader);
+  for (std::size_t field : {offsetof(snapshot::BookHeader, stp), offsetof(snapshot::BookHeader, ladder),
+                            offsetof(snapshot::BookHeader, queue), offsetof(snapshot::BookHeader, depth_tree)}) {
+    std::string bad = bytes;
+    bad[book + field] = char(7);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << bad;
+    EXPECT_THROW(snapshot::load_book(path), std::runtime_error) << "field at " << field;
+  }
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "../engine/common/timebase.hpp"
+
+namespace {
+
+std::int64_t diff(std::uint64_t a, std::uint64_t b) { return std::int64_t(a - b); }
+
+} // namespace
+
+TEST(TscClock, Tracks_steady_clock_and_never_goes_backwards) {
+  tb::TscClock clk;
+  EXPECT_LT(std::llabs(diff(clk.now_ns(), tb::now_ns())), 1'000'000);
+  std::uint64_t prev = clk.now_ns();
+  for (int i = 0; i < 1'000'000; ++i) {
+    const std::uint64_t t = clk.now_ns();
+    ASSERT_GE(t, prev);
+    prev = t;
+  }
+}
+
+TEST(TscClock, Intervals_match_steady_clock) {
+  tb::TscClock clk;
+  const std::uint64_t f0 = clk.now_ns(), s0 = tb::now_ns(), k0 = clk.ticks();
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  const std::uint64_t f1 = clk.now_ns(), s1 = tb::now_ns(), k1 = clk.ticks();
+  const double steady = double(s1 - s0);
+  EXPECT_NEAR(double(f1 - f0), steady, steady * 0.01 + 200'000);
+  EXPECT_NEAR(double(clk.ticks_to_ns(k1 - k0)), steady, steady * 0.01 + 200'000);
+}
+
+TEST(TscClock, Calibration_holds_without_recalibrating) {
+  tb::TscClock clk;
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_LT(std::llabs(clk.error_ns()), 200'000);   // 0.2% of the interval
+}
+
+TEST(TscClock, Recalibration_is_continuous) {
+  tb::TscClock clk(tb::tsc_invariant(), 2'000'000);
+  for (int i = 0; i < 20; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    const std::uint64_t before = clk.now_ns();
+    clk.recalibrate();
+    const std::uint64_t after = clk.now_ns();
+    ASSERT_GE(after, before);
+  }
+  EXPECT_LT(std::llabs(clk.error_ns()), 1'000'000);
+}
+
+TEST(TscClock, Fallback_uses_steady_clock) {
+  tb::TscClock clk(false);
+  EXPECT_FALSE(clk.uses_tsc());
+  EXPECT_EQ(clk.ghz(), 0.0);
+  EXPECT_EQ(clk.ticks_to_ns(12345), 12345u);
+  const std::uint64_t s0 = tb::now_ns(), f = clk.now_ns(), s1 = tb::now_ns();
+  EXPECT_GE(f, s0);
+  EXPECT_LE(f, s1);
+  EXPECT_EQ(clk.error_ns(), 0);
+}
+
+// Readers on other threads while a recalibrator re-anchors every millisecond
+// (run under TSan for the seqlock).
+TEST(TscClock, Readers_are_monotonic_during_background_recalibration) {
+  tb::TscClock clk(tb::tsc_invariant(), 1'000'000);
+  std::atomic<bool> ok{true};
+  {
+    tb::TscRecalibrator recal(clk, std::chrono::milliseconds(1));
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+      readers.emplace_back([&]{
+        std::uint64_t prev = clk.now_ns();
+        const std::uint64_t end = tb::now_ns() + 30'000'000;
+        while (tb::now_ns() < end) {
+          const std::uint64_t t = clk.now_ns();
+          if (t < prev) ok.store(false);
+          prev = t;
+        }
+      });
+    }
+    for (auto& t : readers) t.join();
+  }
+  EXPECT_TRUE(ok.load());
+}
+
+TEST(TscClock, Global_clock_is_calibrated_once) {
+  EXPECT_EQ(&tb::tsc_clock(), &tb::tsc_clock());
+  EXPECT_EQ(tb::tsc_clock().uses_tsc(), tb::tsc_invariant());
+  if (tb::tsc_clock().uses_tsc()) {
+    EXPECT_GT(tb::tsc_clock().ghz(), 0.1);
+  }
+  EXPECT_LT(std::llabs(diff(tb::fast_now_ns(), tb::now_ns())), 1'000'000);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../engine/match_engine.hpp"
+#include "../engine/sharded_engine.hpp"
+#include "../engine/trace_report.hpp"
+
+// Built with LOB_TRACE (see CMakeLists.txt).
+static_assert(trace::kEnabled, "test_trace needs -DLOB_TRACE");
+static_assert(sizeof(trace::Traced<Command, false>) == sizeof(Command), "compiled-out Traced adds no bytes");
+
+namespace {
+
+std::string tmp_path(const char* name) { return testing::TempDir() + name; }
+
+// Stamps of one command id, by stage.
+std::map<std::uint64_t, std::map<trace::Stage, trace::Record>> by_command(const trace::TraceFile& tf) {
+  std::map<std::uint64_t, std::map<trace::Stage, trace::Record>> m;
+  for (std::size_t i = 0; i < tf.size(); ++i)
+    if (tf[i].stage != trace::Stage::Publish && tf[i].stage != trace::Stage::Poll) m[tf[i].id][tf[i].stage] = tf[i];
+  return m;
+}
+
+std::size_t count(const trace::TraceFile& tf, trace::Stage s) {
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < tf.size(); ++i) n += tf[i].stage == s;
+  return n;
+}
+
+} // namespace
+
+TEST(Trace, Direct_engine_calls_stamp_every_stage) {
+  const std::string path = tmp_path("trace_direct.bin");
+  EventBus bus(1024);
+  MatchEngine eng(bus);
+  {
+    trace::TraceWriter w(path);
+    eng.add(1, 10, Side::Bid, 100, 5);
+    eng.add(2, 11, Side::Ask, 100, 2);    // crosses: fill + delta
+    eng.cancel(10);
+    eng.replace(3, 999, 101, 1);          // unknown id: no Book call
+    Event e;
+    while (bus.try_poll(e)) {}
+  }
+
+  trace::TraceFile tf(path);
+  const auto cmds = by_command(tf);
+  ASSERT_EQ(cmds.size(), 4u);
+  std::size_t with_book_call = 0;
+  for (auto const& [id, st] : cmds) {
+    ASSERT_NE(id, 0u);
+    ASSERT_TRUE(st.count(trace::Stage::Ingress));
+    if (!st.count(trace::Stage::SubmitBegin)) continue;
+    ++with_book_call;
+    EXPECT_LE(st.at(trace::Stage::Ingress).tsc, st.at(trace::Stage::SubmitBegin).tsc);
+    EXPECT_LE(st.at(trace::Stage::SubmitBegin).tsc, st.at(trace::Stage::SubmitEnd).tsc);
+  }
+  EXPECT_EQ(with_book_call, 3u);
+  EXPECT_EQ(count(tf, trace::Stage::Publish), bus.published());
+  EXPECT_EQ(count(tf, trace::Stage::Poll), bus.published());
+
+  const StageBreakdown b(tf);
+  EXPECT_EQ(b.commands, 4u);
+  EXPECT_EQ(b.no_book_call, 1u);
+  EXPECT_EQ(b.events, bus.published());
+  EXPECT_EQ(b.unpolled, 0u);
+  EXPECT_EQ(b.bus.count(), bus.published());
+  EXPECT_EQ(b.queue.count(), 3u);
+  EXPECT_EQ(b.end_to_end.count(), 3u);
+}
+
+TEST(Trace, Sharded_engine_carries_the_ingress_id_to_the_shard) {
+  const std::string path = tmp_path("trace_sharded.bin");
+  constexpr int kCmds = 2000;
+  ShardedEngine::Config cfg;
+  cfg.shards = 2;
+  ShardedEngine eng(cfg);
+  const SymbolId a = eng.add_symbol("A"), b = eng.add_symbol("B");
+
+  std::uint64_t polled = 0;
+  {
+    trace::TraceWriter w(path);
+    eng.start();
+    std::atomic<bool> stop{false};
+    std::thread drainer([&]{
+      for (;;) {
+        const bool last = stop.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < eng.shards(); ++i) polled += eng.poll(i, [](const Event&){});
+        if (last) break;
+        std::this_thread::yield();
+      }
+    });
+    for (int i = 0; i < kCmds; ++i) {
+      const SymbolId sym = (i & 1) ? a : b;
+      const Side side = (i & 2) ? Side::Bid : Side::Ask;
+      eng.submit(make_add(sym, 1, OrderId(i + 1), side, 100, 1));
+    }
+    while (!eng.idle()) std::this_thread::yield();
+    eng.stop();
+    stop.store(true, std::memory_order_release);
+    drainer.join();
+  }
+
+  trace::TraceFile tf(path);
+  const auto cmds = by_command(tf);
+  ASSERT_EQ(cmds.size(), std::size_t(kCmds));
+  std::set<std::uint16_t> shard_threads;
+  for (auto const& [id, st] : cmds) {
+    ASSERT_EQ(st.size(), 3u) << "id " << id;
+    const trace::Record& in = st.at(trace::Stage::Ingress);
+    const trace::Record& sb = st.at(trace::Stage::SubmitBegin);
+    EXPECT_NE(in.thread, sb.thread);       // producer vs shard thread
+    EXPECT_LE(in.tsc, sb.tsc);
+    shard_threads.insert(sb.thread);
+  }
+  EXPECT_EQ(shard_threads.size(), 2u);
+
+  const StageBreakdown br(tf);
+  EXPECT_EQ(br.commands, std::uint64_t(kCmds));
+  EXPECT_EQ(br.no_book_call, 0u);
+  EXPECT_EQ(br.events, polled);
+  EXPECT_EQ(br.unpolled, 0u);
+  EXPECT_EQ(trace::registry().dropped(), 0u);
+}
@@ -34,11 +34,11 @@ TEST(Property, VolumeConservation) {
     }
     // drain bus and track
     while (auto ev = bus.try_poll()) {
-      if (std::holds_alternative<FillEvent>(*ev)) {
-        traded += std::get<FillEvent>(*ev).qty;
-      } else if (std::holds_alternative<CancelEvent>(*ev)) {
-        canceled += std::get<CancelEvent>(*ev).qty_canceled;
-      } else if (std::holds_alternative<BookChangeEvent>(*ev)) {
+      if (ev->is<FillEvent>()) {
+        traded += ev->get<FillEvent>().qty;
+      } else if (ev->is<CancelEvent>()) {
+        canceled += ev->get<CancelEvent>().qty_canceled;
+      } else if (ev->is<BookChangeEvent>()) {
         // skip
       }
     }
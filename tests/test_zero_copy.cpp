@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+#include "../engine/event_bus.hpp"
+#include "../engine/spsc/spsc_channel.hpp"
+#include "../engine/spsc/spsc_ring.hpp"
+
+TEST(SpscRingZeroCopy, Claim_commit_and_peek_release) {
+  SpscRing<std::shared_ptr<int>> q(4);
+  auto v = std::make_shared<int>(7);
+  for (int i = 0; i < 4; ++i) {
+    auto* slot = q.try_claim();
+    ASSERT_NE(slot, nullptr);
+    new (slot) std::shared_ptr<int>(v);
+    EXPECT_EQ(q.size(), std::size_t(i));                 // invisible until commit
+    q.commit();
+  }
+  EXPECT_EQ(q.try_claim(), nullptr);
+  EXPECT_FALSE(q.try_emplace(v));
+  EXPECT_EQ(v.use_count(), 5);
+
+  const auto* front = q.peek();
+  ASSERT_NE(front, nullptr);
+  EXPECT_EQ(**front, 7);
+  EXPECT_EQ(q.size(), 4u);                               // still owned by the ring
+  q.release();
+  EXPECT_EQ(v.use_count(), 4);                           // released slot is destroyed
+  EXPECT_TRUE(q.try_emplace(v));
+  q.release(3);
+  EXPECT_EQ(q.size(), 1u);
+  EXPECT_EQ(v.use_count(), 2);
+}
+
+TEST(SpscRingZeroCopy, Spans_stop_at_the_wrap_point) {
+  SpscRing<std::uint32_t> q(8);
+  std::uint32_t* first = nullptr;
+  EXPECT_EQ(q.try_claim_n(6, &first), 6u);
+  for (std::uint32_t i = 0; i < 6; ++i) first[i] = i;
+  q.commit(6);
+  EXPECT_EQ(q.peek_n(4, &first), 4u);
+  q.release(4);                                          // tail = 4, head = 6
+  EXPECT_EQ(q.try_claim_n(10, &first), 2u);              // slots 6, 7 then the wrap
+  first[0] = 6; first[1] = 7;
+  q.commit(2);
+  EXPECT_EQ(q.try_claim_n(10, &first), 4u);              // slots 0..3
+  for (std::uint32_t i = 0; i < 4; ++i) first[i] = 8 + i;
+  q.commit(4);
+  std::vector<std::uint32_t> got;
+  for (std::size_t n; (n = q.peek_n(100, &first)) != 0; q.release(n))
+    got.insert(got.end(), first, first + n);
+  EXPECT_EQ(got, (std::vector<std::uint32_t>{4, 5, 6, 7, 8, 9, 10, 11}));
+}
+
+TEST(EventBusZeroCopy, Peek_release_and_bulk_across_the_wrap) {
+  EventBus bus(8);
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < 6; ++i) ASSERT_TRUE(bus.publish_in_place<BookChangeEvent>(Price(i), Qty(1), SymbolId(0), Side::Bid));
+    const Event* e = bus.peek();
+    ASSERT_NE(e, nullptr);
+    EXPECT_EQ(e->get<BookChangeEvent>().px, 0);
+    bus.release();
+    std::vector<std::uint64_t> seqs;
+    EXPECT_EQ(bus.poll_bulk(100, [&](Event&& ev){ seqs.push_back(ev.seq); }), 5u);
+    ASSERT_EQ(seqs.size(), 5u);
+    for (std::size_t i = 0; i < seqs.size(); ++i) EXPECT_EQ(seqs[i], std::uint64_t(round) * 6 + i + 2);
+  }
+  EXPECT_EQ(bus.peek(), nullptr);
+}
+
+TEST(SpscChannelZeroCopy, Emplace_and_peek_with_stats_across_threads) {
+  struct Msg { std::uint64_t seq; std::uint64_t payload[7]; };
+  SpscStats stats;
+  SpscChannel<Msg> ch(64, BackpressureCfg(64, 32, BpMode::Sleep, 1000), &stats);
+  constexpr std::uint64_t N = 50000;
+  std::thread prod([&]{
+    for (std::uint64_t i = 0; i < N; ++i) ASSERT_TRUE(ch.emplace(nullptr, Msg{i, {i, i, i, i, i, i, i}}));
+  });
+  bool ok = true;
+  for (std::uint64_t expect = 0; expect < N; ) {
+    const Msg* m = ch.peek();
+    if (!m) { std::this_thread::yield(); continue; }
+    ok &= m->seq == expect && m->payload[6] == expect;
+    ch.release();
+    ++expect;
+  }
+  prod.join();
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(stats.push_ok.load(), N);
+  EXPECT_EQ(stats.pop_ok.load(), N);
+  EXPECT_EQ(stats.drops_total.load(), 0u);
+}